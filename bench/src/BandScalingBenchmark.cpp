@@ -0,0 +1,122 @@
+/*
+ Per-block cost against the number of parametric bands in use, with the cuts and the Peak band
+ bypassed so only the bands are measured.  Inactive bands should cost nothing: the time per block
+ should grow with the active count and be the same whichever bands are the active ones.
+
+ - biquad:   FilterBank, walking its compacted list of enabled sections
+ - SVF:      SvfBank, smoothing and updating only the active bands
+ - design:   designChainSnapshot() after one band moved, with and without the previous snapshot
+ */
+
+#include "BenchmarkUtils.h"
+#include "ChainSnapshot.h"
+#include "SvfBank.h"
+
+namespace
+{
+constexpr int blockSize = 256;
+constexpr int numBlocks = 4000;
+constexpr double sampleRate = 48000.0;
+
+// numActive bells spread across all of the slots, so the active ones aren't simply the first few
+ChainSettings makeSettings(int numActive)
+{
+    ChainSettings settings;
+    settings.lowCutFreq = 20.f;
+    settings.highCutFreq = 20000.f;
+    settings.loCutBypassed = settings.peakBypassed = settings.hiCutBypassed = true;
+
+    auto& bands = settings.bands;
+    bands.numBands = BandTable::maxBands;
+
+    for( int band = 0; band < BandTable::maxBands; ++band )
+    {
+        const auto b = (size_t)band;
+        bands.freq[b] = 50.f * std::pow(2.f, 0.6f * float(band));
+        bands.quality[b] = 1.5f;
+        bands.gainInDecibels[b] = 3.f;
+        bands.bypassed[b] = true;
+    }
+
+    const auto stride = numActive > 0 ? BandTable::maxBands / numActive : 1;
+    for( int i = 0; i < numActive; ++i )
+        bands.bypassed[size_t(i * stride)] = false;
+
+    return settings;
+}
+
+template<typename ProcessFn>
+bench::Timings run(ProcessFn&& processBlock)
+{
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::Random random;
+    bench::Timings timings;
+    timings.reserve(numBlocks);
+
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        for( int ch = 0; ch < 2; ++ch )
+            for( int i = 0; i < blockSize; ++i )
+                buffer.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        auto start = bench::Clock::now();
+        processBlock(block);
+        timings.add(bench::nanosecondsSince(start));
+
+        bench::doNotOptimise(buffer.getSample(1, blockSize - 1));
+    }
+
+    return timings;
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("%d-sample stereo blocks, %d band slots\n", blockSize, BandTable::maxBands);
+
+    for( int numActive : { 0, 1, 2, 4, 8, 16 } )
+    {
+        const auto settings = makeSettings(numActive);
+        const auto label = [numActive](const char* engine) { return juce::String(engine) + ", " + juce::String(numActive) + " active"; };
+
+        FilterBank<float> biquads;
+        biquads.prepare(2, blockSize);
+        designChainSnapshot(settings, sampleRate).applyTo(biquads);
+        run([&](auto& block) { biquads.process(block); }).print(label("biquad").toRawUTF8());
+
+        SvfBank<float> svfs;
+        svfs.prepare(sampleRate, 2);
+        svfs.setTargets(settings);
+        svfs.reset();
+        run([&](auto& block) { svfs.process(block); }).print(label("SVF").toRawUTF8());
+
+        std::printf("\n");
+    }
+
+    // dragging one band of sixteen
+    auto settings = makeSettings(BandTable::maxBands);
+    auto previous = designChainSnapshot(settings, sampleRate);
+    bench::Timings full, incremental;
+
+    for( int i = 0; i < 2000; ++i )
+    {
+        settings.bands.freq[5] = 400.f + float(i % 200);
+
+        auto start = bench::Clock::now();
+        bench::doNotOptimise(designChainSnapshot(settings, sampleRate).enabledMask);
+        full.add(bench::nanosecondsSince(start));
+
+        start = bench::Clock::now();
+        previous = designChainSnapshot(settings, sampleRate, &previous);
+        incremental.add(bench::nanosecondsSince(start));
+    }
+
+    full.print("design, all 16 bands");
+    incremental.print("design, changed band only");
+
+    return 0;
+}
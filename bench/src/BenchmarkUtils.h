@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#if defined(__APPLE__)
+ #include <mach/mach.h>
+#elif defined(__linux__)
+ #include <unistd.h>
+#endif
+
+namespace bench
+{
+using Clock = std::chrono::steady_clock;
+
+inline double nanosecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// collects one timing per iteration and summarises them
+struct Timings
+{
+    std::vector<double> nanoseconds;
+
+    void reserve(size_t n) { nanoseconds.reserve(n); }
+    void add(double ns) { nanoseconds.push_back(ns); }
+
+    double mean() const
+    {
+        if( nanoseconds.empty() )
+            return 0.0;
+        return std::accumulate(nanoseconds.begin(), nanoseconds.end(), 0.0) / double(nanoseconds.size());
+    }
+
+    // p in [0, 1]
+    double percentile(double p) const
+    {
+        if( nanoseconds.empty() )
+            return 0.0;
+
+        auto sorted = nanoseconds;
+        auto index = size_t(p * double(sorted.size() - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+
+    void print(const char* name) const
+    {
+        std::printf("%-40s mean %10.1f ns   p50 %10.1f ns   p99 %10.1f ns   (n = %zu)\n",
+                    name, mean(), percentile(0.5), percentile(0.99), nanoseconds.size());
+    }
+};
+
+/*
+ Walks a scratch buffer larger than L2 so that whatever runs next starts with cold caches,
+ the way a plugin does after the host has processed a few hundred other nodes.
+ */
+struct CacheThrasher
+{
+    explicit CacheThrasher(size_t bytes = 4 * 1024 * 1024) : scratch(bytes / sizeof(long), 1) {}
+
+    void thrash()
+    {
+        long acc = 0;
+        for( size_t i = 0; i < scratch.size(); i += 64 / sizeof(long) )
+        {
+            scratch[i] += 1;
+            acc += scratch[i];
+        }
+        sink = acc;
+    }
+
+    std::vector<long> scratch;
+    volatile long sink = 0;
+};
+
+// keeps the optimiser from discarding a result
+template<typename T>
+inline void doNotOptimise(T value)
+{
+    static volatile T sink;
+    sink = value;
+}
+
+// the process's resident set size, or 0 where we don't know how to ask
+inline size_t getResidentBytes()
+{
+#if defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if( task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS )
+        return 0;
+    return (size_t)info.resident_size;
+#elif defined(__linux__)
+    long pages = 0, resident = 0;
+    auto* statm = std::fopen("/proc/self/statm", "r");
+    if( statm == nullptr )
+        return 0;
+    const auto matched = std::fscanf(statm, "%ld %ld", &pages, &resident);
+    std::fclose(statm);
+    return matched == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+}
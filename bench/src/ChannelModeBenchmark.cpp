@@ -0,0 +1,125 @@
+/*
+ Per-block cost of each channel mode with a typical chain: both cuts, the Peak band and four
+ parametric bands.  Linked stereo should cost what the single-chain engine always did; dual-mono
+ and mid/side run the same number of sections, so the biquad engine's SIMD pass should cost the
+ same in every mode, and mid/side's encode and decode should be lost in the noise.
+
+ - biquad:   FilterBank, both lanes in one SIMD pass
+ - SVF:      SvfBank, one lane per channel
+ - design:   designStereoChainSnapshot() after the right channel moved, linked and dual-mono
+ */
+
+#include "BenchmarkUtils.h"
+#include "ChainSnapshot.h"
+#include "SvfBank.h"
+
+namespace
+{
+constexpr int blockSize = 256;
+constexpr int numBlocks = 4000;
+constexpr double sampleRate = 48000.0;
+
+ChainSettings makeSettings(float gain)
+{
+    ChainSettings settings;
+    settings.lowCutFreq = 40.f;
+    settings.highCutFreq = 16000.f;
+    settings.lowCutSlope = Slope_24;
+    settings.highCutSlope = Slope_24;
+    settings.peakFreq = 1000.f;
+    settings.peakGainInDecibels = gain;
+    settings.peakQuality = 1.f;
+
+    auto& bands = settings.bands;
+    bands.numBands = 4;
+
+    const BandType types[] { LowShelfBand, BellBand, BellBand, HighShelfBand };
+    for( size_t b = 0; b < 4; ++b )
+    {
+        bands.type[b] = types[b];
+        bands.freq[b] = 100.f * std::pow(4.f, float(b));
+        bands.quality[b] = 0.8f;
+        bands.gainInDecibels[b] = gain / 2.f;
+    }
+
+    return settings;
+}
+
+template<typename ProcessFn>
+bench::Timings run(ProcessFn&& processBlock)
+{
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::Random random;
+    bench::Timings timings;
+    timings.reserve(numBlocks);
+
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        for( int ch = 0; ch < 2; ++ch )
+            for( int i = 0; i < blockSize; ++i )
+                buffer.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+        juce::dsp::AudioBlock<float> block(buffer);
+
+        auto start = bench::Clock::now();
+        processBlock(block);
+        timings.add(bench::nanosecondsSince(start));
+
+        bench::doNotOptimise(buffer.getSample(1, blockSize - 1));
+    }
+
+    return timings;
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("%d-sample stereo blocks\n", blockSize);
+
+    const std::array<ChainSettings, 2> settings { makeSettings(4.f), makeSettings(-3.f) };
+    const char* modeNames[] { "linked", "dual-mono", "mid/side" };
+
+    for( auto mode : { LinkedStereo, DualMono, MidSide } )
+    {
+        const auto label = [&](const char* engine) { return juce::String(engine) + ", " + modeNames[mode]; };
+        const auto snapshot = designStereoChainSnapshot(mode, settings, sampleRate);
+
+        FilterBank<float> biquads;
+        biquads.prepare(2, blockSize);
+        snapshot.applyTo(biquads);
+        run([&](auto& block) { biquads.process(block); }).print(label("biquad").toRawUTF8());
+
+        SvfBank<float> svfs;
+        svfs.prepare(sampleRate, 2);
+        svfs.setChannelMode(mode);
+        svfs.setTargets(settings[0], 0);
+        svfs.setTargets(settings[1], 1);
+        svfs.reset();
+        run([&](auto& block) { svfs.process(block); }).print(label("SVF").toRawUTF8());
+
+        std::printf("\n");
+    }
+
+    // dragging the right channel's peak: linked designs nothing new, dual-mono only the right
+    for( auto mode : { LinkedStereo, DualMono } )
+    {
+        auto moving = settings;
+        auto previous = designStereoChainSnapshot(mode, moving, sampleRate);
+        bench::Timings timings;
+
+        for( int i = 0; i < 2000; ++i )
+        {
+            moving[1].peakFreq = 400.f + float(i % 200);
+
+            const auto start = bench::Clock::now();
+            previous = designStereoChainSnapshot(mode, moving, sampleRate, &previous);
+            timings.add(bench::nanosecondsSince(start));
+        }
+
+        timings.print((juce::String("design, right channel moved, ") + modeNames[mode]).toRawUTF8());
+    }
+
+    return 0;
+}
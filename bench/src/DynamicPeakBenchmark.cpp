@@ -0,0 +1,114 @@
+/*
+ Per-block cost of the peak band on its own, static against dynamic.  The input swings above and
+ below the threshold every few blocks, so the dynamic band's gain is always moving.
+
+ - static:              FilterBank with only the peak section enabled, the biquad engine's cost
+ - dynamic, input:      DynamicPeak detecting on the signal it filters
+ - dynamic, sidechain:  DynamicPeak keyed from a separate stereo bus
+
+ The dynamic band should stay under twice the static one.
+ */
+
+#include "BenchmarkUtils.h"
+#include "ChainSnapshot.h"
+#include "DynamicPeak.h"
+
+namespace
+{
+constexpr int blockSize = 256;
+constexpr int numBlocks = 20000;
+constexpr double sampleRate = 48000.0;
+
+ChainSettings makeSettings()
+{
+    ChainSettings settings;
+    settings.peakFreq = 2500.f;
+    settings.peakGainInDecibels = -9.f;
+    settings.peakQuality = 2.f;
+    settings.peakDynamic = true;
+    settings.dynamicThreshold = -20.f;
+    settings.dynamicRatio = 3.f;
+    settings.dynamicAttackMs = 2.f;
+    settings.dynamicReleaseMs = 60.f;
+    return settings;
+}
+
+template<typename SampleType, typename ProcessFn>
+bench::Timings run(ProcessFn&& processBlock)
+{
+    juce::AudioBuffer<SampleType> buffer(2, blockSize), key(2, blockSize);
+    juce::Random random;
+    bench::Timings timings;
+    timings.reserve(numBlocks);
+
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        const auto level = (b / 8) % 2 == 0 ? 0.8f : 0.02f;
+        for( int ch = 0; ch < 2; ++ch )
+        {
+            for( int i = 0; i < blockSize; ++i )
+            {
+                buffer.setSample(ch, i, SampleType(level * (random.nextFloat() * 2.f - 1.f)));
+                key.setSample(ch, i, SampleType(level * (random.nextFloat() * 2.f - 1.f)));
+            }
+        }
+
+        juce::dsp::AudioBlock<SampleType> block(buffer), sidechain(key);
+
+        auto start = bench::Clock::now();
+        processBlock(block, sidechain);
+        timings.add(bench::nanosecondsSince(start));
+
+        bench::doNotOptimise(buffer.getSample(1, blockSize - 1));
+    }
+
+    return timings;
+}
+
+template<typename SampleType>
+void compare(const char* precision)
+{
+    const auto settings = makeSettings();
+
+    auto staticSettings = settings;
+    staticSettings.peakDynamic = false;
+    const auto snapshot = designChainSnapshot(staticSettings, sampleRate);
+
+    FilterBank<SampleType> bank;
+    bank.prepare(2, blockSize);
+    const auto peak = FilterBank<SampleType>::peakIndex;
+    bank.setSection(peak, snapshot.coefficients[(size_t)peak].data());
+    bank.setSectionEnabled(peak, true);
+
+    DynamicPeak<SampleType> dynamicPeak;
+    dynamicPeak.prepare(sampleRate, 2, blockSize);
+    dynamicPeak.setSettings(settings);
+
+    const auto name = [precision](const char* variant) { return juce::String(precision) + ", " + variant; };
+
+    const auto staticTimings = run<SampleType>([&](auto& block, auto&) { bank.process(block); });
+    staticTimings.print(name("static").toRawUTF8());
+
+    const auto inputTimings = run<SampleType>([&](auto& block, auto&) { dynamicPeak.process(block); });
+    inputTimings.print(name("dynamic, input").toRawUTF8());
+
+    const auto sidechainTimings = run<SampleType>([&](auto& block, auto& sidechain) { dynamicPeak.process(block, &sidechain); });
+    sidechainTimings.print(name("dynamic, sidechain").toRawUTF8());
+
+    std::printf("%-40s input %.2fx   sidechain %.2fx   (target < 2x)\n\n", name("dynamic / static").toRawUTF8(),
+                inputTimings.percentile(0.5) / staticTimings.percentile(0.5),
+                sidechainTimings.percentile(0.5) / staticTimings.percentile(0.5));
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("%d-sample stereo blocks, gain update every %d samples\n", blockSize, DynamicPeak<float>::updateInterval);
+
+    compare<float>("float");
+    compare<double>("double");
+
+    return 0;
+}
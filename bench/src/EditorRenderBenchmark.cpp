@@ -0,0 +1,215 @@
+/*
+ What an open editor costs the message thread, without a DAW or a display: the editor is built
+ offscreen, synthetic audio is pushed through processBlock into the analyzer FIFOs, and each frame
+ runs the response curve's timerCallback() followed by a paint of the whole editor into an image,
+ the way the 60 Hz timer and the window's repaint would.
+
+ Every window size is run at 1x and 2x scale, with the analyzer
+
+ - off:         the FIFOs are only emptied; an idle editor should cost almost nothing
+ - on:          a new spectrum every frame, the usual case
+ - automating:  the analyzer on and the Peak frequency moving every frame, so the curve layer is
+                redrawn too
+
+ Reported per frame: the timer callback's FIFO drain, FFT and path generation, the paint's
+ rasterisation, and their total (p50 / p99).  processBlock runs between frames and isn't timed.
+
+ Usage: EditorRenderBenchmark [--quick] [--budget-ms <ms>]
+
+ --quick runs 60 frames instead of 600, enough for the p50s; its p99 is just the slowest frame.
+ With --budget-ms, the exit code is non-zero when any configuration's p99 frame total goes over the
+ budget, which is how the opt-in ctest (SIMPLEEQ_EDITOR_FRAME_BUDGET_TEST) runs it.
+ */
+
+#include "BenchmarkUtils.h"
+#include "PluginEditor.h"
+#include "PluginProcessor.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 256;
+constexpr int framesPerSecond = 60;
+
+enum AnalyzerCase
+{
+    AnalyzerOff,
+    AnalyzerOn,
+    Automating,
+    numAnalyzerCases
+};
+
+const char* getName(AnalyzerCase analyzerCase)
+{
+    switch( analyzerCase )
+    {
+        case AnalyzerOff: return "analyzer off";
+        case AnalyzerOn: return "analyzer on";
+        case Automating: return "automating";
+        default: break;
+    }
+    return "";
+}
+
+struct FrameTimings
+{
+    bench::Timings fifoDrain, fft, pathGeneration, rasterisation, total;
+
+    void reserve(size_t n)
+    {
+        for( auto* timings : { &fifoDrain, &fft, &pathGeneration, &rasterisation, &total } )
+            timings->reserve(n);
+    }
+};
+
+void setParameter(SimpleEQAudioProcessor& processor, const juce::String& id, float normalised)
+{
+    processor.apvts.getParameter(id)->setValueNotifyingHost(normalised);
+}
+
+FrameTimings runEditor(int width, int height, float scale, AnalyzerCase analyzerCase, int numFrames)
+{
+    SimpleEQAudioProcessor processor{};
+    processor.prepareToPlay(sampleRate, blockSize);
+    setParameter(processor, "Peak Gain", 0.7f);
+    setParameter(processor, "LoCut Slope", 1.f / 3.f);
+    setParameter(processor, "Analyzer Enabled", analyzerCase == AnalyzerOff ? 0.f : 1.f);
+
+    std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditor());
+    auto& responseCurve = dynamic_cast<SimpleEQAudioProcessorEditor&>(*editor).getResponseCurve();
+    editor->setSize(width, height);
+
+    // a size change is only taken once it has stopped changing, as at the end of a drag; the
+    // first timerCallback() below then settles it
+    juce::Thread::sleep(250);
+
+    juce::Image frame(juce::Image::ARGB, juce::roundToInt(float(width) * scale), juce::roundToInt(float(height) * scale), true);
+
+    // noise under a slow sweep, so every frame's spectrum and path differ from the last
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random;
+    double phase = 0.0;
+    int sampleIndex = 0;
+
+    auto processAudio = [&]
+    {
+        const auto samplesPerFrame = int(sampleRate) / framesPerSecond;
+        for( int done = 0; done < samplesPerFrame; done += blockSize )
+        {
+            for( int s = 0; s < blockSize; ++s, ++sampleIndex )
+            {
+                const auto frequency = 100.0 * std::pow(100.0, double(sampleIndex % int(sampleRate * 4)) / (sampleRate * 4));
+                phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+                const auto sample = 0.25f * (float)std::sin(phase) + 0.05f * (random.nextFloat() - 0.5f);
+                buffer.setSample(0, s, sample);
+                buffer.setSample(1, s, sample);
+            }
+
+            processor.processBlock(buffer, midi);
+        }
+    };
+
+    auto paintFrame = [&]
+    {
+        juce::Graphics g(frame);
+        g.addTransform(juce::AffineTransform::scale(scale));
+        editor->paintEntireComponent(g, true);
+    };
+
+    const auto numWarmupFrames = 30;
+    FrameTimings timings;
+    timings.reserve((size_t)numFrames);
+
+    for( int f = 0; f < numWarmupFrames + numFrames; ++f )
+    {
+        processAudio();
+
+        if( analyzerCase == Automating )
+            setParameter(processor, "Peak Freq", 0.3f + 0.4f * float(f % 120) / 120.f);
+
+        const auto start = bench::Clock::now();
+        responseCurve.timerCallback();
+        const auto timerNanoseconds = bench::nanosecondsSince(start);
+
+        const auto paintStart = bench::Clock::now();
+        paintFrame();
+        const auto paintNanoseconds = bench::nanosecondsSince(paintStart);
+
+        if( f < numWarmupFrames )
+            continue;
+
+        const auto analyzer = responseCurve.getAnalyzerTimings();
+        timings.fifoDrain.add(analyzer.fifoDrainMilliseconds * 1e6);
+        timings.fft.add(analyzer.fftMilliseconds * 1e6);
+        timings.pathGeneration.add(analyzer.pathMilliseconds * 1e6);
+        timings.rasterisation.add(paintNanoseconds);
+        timings.total.add(timerNanoseconds + paintNanoseconds);
+    }
+
+    bench::doNotOptimise(frame.getPixelAt(width / 2, height / 2).getARGB());
+    return timings;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    bool quick = false;
+    double budgetMilliseconds = 0.0;
+
+    for( int i = 1; i < argc; ++i )
+    {
+        if( std::strcmp(argv[i], "--quick") == 0 )
+            quick = true;
+        else if( std::strcmp(argv[i], "--budget-ms") == 0 && i + 1 < argc )
+            budgetMilliseconds = std::atof(argv[++i]);
+    }
+
+    // components and fonts need a message manager, but nothing here opens a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto numFrames = quick ? 60 : 600;
+    const int sizes[][2] = { { 600, 480 }, { 900, 720 }, { 1200, 960 } };
+
+    std::printf("%d frames per configuration, %d-sample blocks at %.0f Hz between frames\n\n",
+                numFrames, blockSize, sampleRate);
+    std::printf("%-10s  %5s  %-12s  %10s  %10s  %10s  %12s  %12s  %12s\n",
+                "size", "scale", "", "drain p50", "FFT p50", "path p50", "raster p50", "frame p50", "frame p99");
+
+    bool overBudget = false;
+
+    for( const auto& size : sizes )
+    {
+        for( auto scale : { 1.f, 2.f } )
+        {
+            for( int c = 0; c < numAnalyzerCases; ++c )
+            {
+                const auto analyzerCase = AnalyzerCase(c);
+                const auto timings = runEditor(size[0], size[1], scale, analyzerCase, numFrames);
+                const auto p99Milliseconds = timings.total.percentile(0.99) * 1e-6;
+
+                std::printf("%4dx%-5d  %4.0fx  %-12s  %7.3f ms  %7.3f ms  %7.3f ms  %9.3f ms  %9.3f ms  %9.3f ms%s\n",
+                            size[0], size[1], scale, getName(analyzerCase),
+                            timings.fifoDrain.percentile(0.5) * 1e-6,
+                            timings.fft.percentile(0.5) * 1e-6,
+                            timings.pathGeneration.percentile(0.5) * 1e-6,
+                            timings.rasterisation.percentile(0.5) * 1e-6,
+                            timings.total.percentile(0.5) * 1e-6,
+                            p99Milliseconds,
+                            budgetMilliseconds > 0.0 && p99Milliseconds > budgetMilliseconds ? "  OVER BUDGET" : "");
+
+                overBudget = overBudget || (budgetMilliseconds > 0.0 && p99Milliseconds > budgetMilliseconds);
+            }
+        }
+    }
+
+    if( budgetMilliseconds > 0.0 )
+        std::printf("\np99 frame budget %.2f ms: %s\n", budgetMilliseconds, overBudget ? "FAILED" : "ok");
+
+    return overBudget ? 1 : 0;
+}
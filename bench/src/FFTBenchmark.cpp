@@ -0,0 +1,61 @@
+/*
+ One analyzer frame's worth of FFT work per backend, at each order the analyzer offers:
+ forward magnitudes of a windowed block of noise, which is exactly what FFTDataGenerator asks for.
+
+ - juce:     juce::dsp::FFT, whichever engine JUCE was built with on this platform
+ - bundled:  RealFFT, the in-tree real FFT
+ */
+
+#include "BenchmarkUtils.h"
+#include "FFTBackend.h"
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace
+{
+constexpr int numFrames = 4000;
+
+bench::Timings run(FFTBackend& backend)
+{
+    const auto size = backend.getSize();
+    std::vector<float> input((size_t)size), magnitudes((size_t)backend.getNumBins());
+
+    juce::Random random;
+    for( auto& x : input )
+        x = random.nextFloat() * 2.f - 1.f;
+
+    juce::dsp::WindowingFunction<float> window((size_t)size, juce::dsp::WindowingFunction<float>::blackmanHarris);
+    window.multiplyWithWindowingTable(input.data(), (size_t)size);
+
+    bench::Timings timings;
+    timings.reserve(numFrames);
+
+    for( int f = 0; f < numFrames; ++f )
+    {
+        auto start = bench::Clock::now();
+        backend.performMagnitudes(input.data(), magnitudes.data());
+        timings.add(bench::nanosecondsSince(start));
+
+        bench::doNotOptimise(magnitudes[(size_t)f % magnitudes.size()]);
+    }
+
+    return timings;
+}
+}
+
+int main()
+{
+    std::printf("forward magnitude transform, default backend: %s\n", FFTBackend::getName(FFTBackend::defaultType));
+
+    for( int order : { 11, 12, 13 } )
+    {
+        for( auto type : { JuceFFTBackend, BundledFFTBackend } )
+        {
+            auto backend = FFTBackend::create(type, order);
+            const auto name = juce::String(FFTBackend::getName(type)) + ", " + juce::String(1 << order) + " points";
+            run(*backend).print(name.toRawUTF8());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ Cold-cache per-block cost of the filter state at 500 simulated instances.
+
+ Compares the old layout (two juce::dsp::ProcessorChain MonoChains, every Filter holding its own
+ heap-allocated coefficients and state) with the contiguous FilterBank arena.  Coefficient design
+ is done once up front so only the coefficient writes and the filtering itself are measured;
+ the caches are thrashed between instances to model a busy host graph.
+ */
+
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+constexpr int numInstances = 500;
+constexpr int numRounds = 20;
+constexpr int blockSize = 256;
+constexpr double sampleRate = 48000.0;
+
+ChainSettings makeSettings()
+{
+    ChainSettings settings;
+    settings.lowCutFreq = 40.f;
+    settings.highCutFreq = 15000.f;
+    settings.peakFreq = 1000.f;
+    settings.peakGainInDecibels = 6.f;
+    settings.peakQuality = 1.f;
+    settings.lowCutSlope = Slope_48;
+    settings.highCutSlope = Slope_48;
+    return settings;
+}
+
+struct ChainInstance
+{
+    MonoChain left, right;
+
+    void prepare()
+    {
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32)blockSize, 1 };
+        left.prepare(spec);
+        right.prepare(spec);
+    }
+
+    template<typename CutCoefficients>
+    void update(const CutCoefficients& loCut, const Coefficients& peak, const CutCoefficients& hiCut)
+    {
+        for( auto* chain : { &left, &right } )
+        {
+            updateCoefficients(chain->get<ChainPositions::Peak>().coefficients, peak);
+            updateCutFilter(chain->get<ChainPositions::LowCut>(), loCut, Slope_48);
+            updateCutFilter(chain->get<ChainPositions::HiCut>(), hiCut, Slope_48);
+        }
+    }
+
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        juce::dsp::AudioBlock<float> block(buffer);
+        auto leftBlock = block.getSingleChannelBlock(0);
+        auto rightBlock = block.getSingleChannelBlock(1);
+        left.process(juce::dsp::ProcessContextReplacing<float>(leftBlock));
+        right.process(juce::dsp::ProcessContextReplacing<float>(rightBlock));
+    }
+};
+
+struct BankInstance
+{
+    FilterBank<float> bank;
+
+    void prepare() { bank.prepare(2, blockSize); }
+
+    template<typename CutCoefficients>
+    void update(const CutCoefficients& loCut, const Coefficients& peak, const CutCoefficients& hiCut)
+    {
+        updateCutSections(bank, FilterBank<float>::lowCutStart, loCut, Slope_48, false);
+        bank.setSection(FilterBank<float>::peakIndex, peak->getRawCoefficients());
+        bank.setSectionEnabled(FilterBank<float>::peakIndex, true);
+        updateCutSections(bank, FilterBank<float>::hiCutStart, hiCut, Slope_48, false);
+    }
+
+    void process(juce::AudioBuffer<float>& buffer)
+    {
+        bank.process(juce::dsp::AudioBlock<float>(buffer));
+    }
+};
+
+template<typename Instance>
+bench::Timings run()
+{
+    const auto settings = makeSettings();
+    const auto loCut = makeLoCutFilter(settings, sampleRate);
+    const auto hiCut = makeHiCutFilter(settings, sampleRate);
+    const auto peak = makePeakFilter(settings, sampleRate);
+
+    std::vector<std::unique_ptr<Instance>> instances;
+    std::vector<juce::AudioBuffer<float>> buffers;
+    for( int i = 0; i < numInstances; ++i )
+    {
+        instances.push_back(std::make_unique<Instance>());
+        instances.back()->prepare();
+        buffers.emplace_back(2, blockSize);
+    }
+
+    juce::Random random;
+    bench::CacheThrasher thrasher;
+    bench::Timings timings;
+    timings.reserve(size_t(numInstances * numRounds));
+
+    for( int round = 0; round < numRounds; ++round )
+    {
+        for( int i = 0; i < numInstances; ++i )
+        {
+            auto& buffer = buffers[(size_t)i];
+            for( int ch = 0; ch < 2; ++ch )
+                for( int n = 0; n < blockSize; ++n )
+                    buffer.setSample(ch, n, random.nextFloat() * 2.f - 1.f);
+
+            thrasher.thrash();
+
+            auto start = bench::Clock::now();
+            instances[(size_t)i]->update(loCut, peak, hiCut);
+            instances[(size_t)i]->process(buffer);
+            timings.add(bench::nanosecondsSince(start));
+
+            bench::doNotOptimise(buffer.getSample(0, blockSize - 1));
+        }
+    }
+
+    return timings;
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("%d instances, %d-sample stereo blocks, Slope_48 / peak / Slope_48, cold cache\n",
+                numInstances, blockSize);
+
+    run<ChainInstance>().print("MonoChain x2 (scattered heap objects)");
+    run<BankInstance>().print("FilterBank (contiguous arena)");
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ Cost of the linear-phase engine against FIR length, 4k to 64k taps, 256-sample stereo blocks:
+
+ - steady:      one kernel, the usual case
+ - crossfading: two kernels convolved at once, as for crossfadeSeconds after every change
+ - design:      designKernel() on the message thread, per parameter change
+
+ Partitions are processed every partitionSize samples, so most host blocks only move samples
+ through the FIFO and a few carry a whole partition; the p99 is the one to watch.
+ */
+
+#include "BenchmarkUtils.h"
+#include "LinearPhaseFilter.h"
+
+namespace
+{
+constexpr int blockSize = 256;
+constexpr int numBlocks = 4000;
+constexpr double sampleRate = 48000.0;
+
+ChainSettings makeSettings(float peakGain)
+{
+    ChainSettings settings;
+    settings.lowCutFreq = 30.f;
+    settings.highCutFreq = 18000.f;
+    settings.lowCutSlope = Slope_48;
+    settings.peakFreq = 2500.f;
+    settings.peakGainInDecibels = peakGain;
+    settings.peakQuality = 1.f;
+    settings.engine = LinearPhaseEngine;
+    return settings;
+}
+
+// keepCrossfading designs a new kernel whenever the last fade finishes
+bench::Timings run(LinearPhaseFilter& filter, bool keepCrossfading)
+{
+    const auto other = designChainSnapshot(makeSettings(-6.f), sampleRate);
+    const auto snapshot = designChainSnapshot(makeSettings(6.f), sampleRate);
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::Random random;
+    bench::Timings timings;
+    timings.reserve(numBlocks);
+
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        for( int ch = 0; ch < 2; ++ch )
+            for( int i = 0; i < blockSize; ++i )
+                buffer.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+        if( keepCrossfading && ! filter.isCrossfading() )
+            filter.designKernel(b % 2 == 0 ? other : snapshot);
+
+        auto start = bench::Clock::now();
+        filter.process(juce::dsp::AudioBlock<float>(buffer));
+        timings.add(bench::nanosecondsSince(start));
+
+        bench::doNotOptimise(buffer.getSample(1, blockSize - 1));
+    }
+
+    return timings;
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    const auto blockPeriodNs = 1e9 * blockSize / sampleRate;
+    std::printf("%d-sample stereo blocks at %g Hz (%.0f ns per block), partition size %d\n",
+                blockSize, sampleRate, blockPeriodNs, LinearPhaseFilter::partitionSize);
+
+    for( int order = 12; order <= 16; ++order )
+    {
+        LinearPhaseFilter filter;
+        filter.prepare(sampleRate, 2, order);
+
+        const auto snapshot = designChainSnapshot(makeSettings(6.f), sampleRate);
+        bench::Timings design;
+        for( int i = 0; i < 20; ++i )
+        {
+            auto start = bench::Clock::now();
+            filter.designKernel(snapshot);
+            design.add(bench::nanosecondsSince(start));
+        }
+        filter.reset();
+
+        const auto taps = juce::String(1 << order) + " taps";
+        const auto steady = run(filter, false);
+        const auto crossfading = run(filter, true);
+
+        steady.print((taps + ", steady").toRawUTF8());
+        crossfading.print((taps + ", crossfading").toRawUTF8());
+        design.print((taps + ", design").toRawUTF8());
+        std::printf("%-40s %.2f%% of one core (mean), latency %d samples\n\n", (taps + ", load").toRawUTF8(),
+                    100.0 * steady.mean() / blockPeriodNs, filter.getLatencySamples());
+    }
+
+    return 0;
+}
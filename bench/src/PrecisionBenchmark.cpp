@@ -0,0 +1,74 @@
+/*
+ Cost of the double-precision path relative to float, hot cache.
+
+ Both banks run the same Slope_48 / peak / Slope_48 cascade on a stereo block; the double bank
+ uses the 2-lane stereo kernel so it should stay close to the float cost.
+ */
+
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+constexpr int blockSize = 512;
+constexpr int numBlocks = 20000;
+constexpr double sampleRate = 192000.0;
+
+template<typename SampleType>
+bench::Timings run()
+{
+    ChainSettings settings;
+    settings.lowCutFreq = 20.f;
+    settings.highCutFreq = 18000.f;
+    settings.peakFreq = 1000.f;
+    settings.peakGainInDecibels = 6.f;
+    settings.lowCutSlope = Slope_48;
+    settings.highCutSlope = Slope_48;
+
+    FilterBank<SampleType> bank;
+    bank.prepare(2, blockSize);
+    updateCutSections(bank, FilterBank<SampleType>::lowCutStart,
+                      makeLoCutFilter<SampleType>(settings, sampleRate), settings.lowCutSlope, false);
+    updateCutSections(bank, FilterBank<SampleType>::hiCutStart,
+                      makeHiCutFilter<SampleType>(settings, sampleRate), settings.highCutSlope, false);
+    bank.setSection(FilterBank<SampleType>::peakIndex,
+                    makePeakFilter<SampleType>(settings, sampleRate)->getRawCoefficients());
+    bank.setSectionEnabled(FilterBank<SampleType>::peakIndex, true);
+
+    juce::AudioBuffer<SampleType> buffer(2, blockSize);
+    juce::Random random;
+    for( int ch = 0; ch < 2; ++ch )
+        for( int i = 0; i < blockSize; ++i )
+            buffer.setSample(ch, i, SampleType(random.nextFloat() * 2.f - 1.f));
+
+    bench::Timings timings;
+    timings.reserve(numBlocks);
+
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        auto start = bench::Clock::now();
+        bank.process(juce::dsp::AudioBlock<SampleType>(buffer));
+        timings.add(bench::nanosecondsSince(start));
+    }
+
+    bench::doNotOptimise(buffer.getSample(0, 0));
+    return timings;
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("%d-sample stereo blocks at %.0f Hz, Slope_48 / peak / Slope_48\n", blockSize, sampleRate);
+
+    auto floatTimings = run<float>();
+    auto doubleTimings = run<double>();
+
+    floatTimings.print("FilterBank<float>");
+    doubleTimings.print("FilterBank<double> (2-lane SIMD)");
+    std::printf("double / float cost ratio (p50): %.2f\n",
+                doubleTimings.percentile(0.5) / floatTimings.percentile(0.5));
+
+    return 0;
+}
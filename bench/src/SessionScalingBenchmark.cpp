@@ -0,0 +1,260 @@
+/*
+ A large host session: N SimpleEQAudioProcessor instances, each with its own buffers, processed
+ every block period by a pool of worker threads that take instances off a shared counter, the way
+ a host graph schedules independent tracks.  At these counts the cost is dominated by how much of
+ each instance has to come back into cache and by any lines the workers share, not by the DSP.
+
+ The instances cycle through a realistic mix of settings:
+
+ - static:      both cuts, the Peak band and four parametric bands, biquad engine
+ - automating:  the same, with the Peak frequency and a band gain moving every block and a
+                simulated message thread publishing the changes at the editor timer's 100 Hz
+ - bypassed:    every band bypassed, so only the block overhead and the analyzer tap are left
+ - analyzer:    like static, with the simulated message thread pulling the analyzer FIFOs the way
+                an open editor does
+ - dual-mono:   the SVF engine with independent left and right settings
+
+ Reported per instance count: the wall time of one instance's processBlock (p50 / p99), the wall
+ time of a whole graph cycle against the block period, instance-blocks per second, and resident
+ memory per instance, which the one instance's MemoryFootprint printed first breaks down.
+
+ Usage: SessionScalingBenchmark [instance counts...]    (default 1 10 100 300 1000)
+ */
+
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+namespace
+{
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 256;
+constexpr int totalInstanceBlocks = 200000;     // per instance count, so small sessions run long enough to measure
+
+enum InstanceKind
+{
+    Static,
+    Automating,
+    Bypassed,
+    Analyzer,
+    DualMono,
+    numInstanceKinds
+};
+
+void setParameter(SimpleEQAudioProcessor& processor, const juce::String& id, float normalised)
+{
+    processor.apvts.getParameter(id)->setValueNotifyingHost(normalised);
+}
+
+void configure(SimpleEQAudioProcessor& processor, InstanceKind kind)
+{
+    setParameter(processor, "LoCut Slope", 1.f / 3.f);
+    setParameter(processor, "Peak Gain", 0.6f);
+    setParameter(processor, "Band Count", 4.f / BandTable::maxBands);
+    for( int band = 0; band < 4; ++band )
+        setParameter(processor, getBandParameterID(band, "Gain"), 0.3f + 0.1f * (float)band);
+
+    if( kind == Bypassed )
+    {
+        for( auto* id : { "LowCut Bypassed", "Peak Bypassed", "HighCut Bypassed" } )
+            setParameter(processor, id, 1.f);
+        for( int band = 0; band < 4; ++band )
+            setParameter(processor, getBandParameterID(band, "Bypassed"), 1.f);
+    }
+    else if( kind == DualMono )
+    {
+        setParameter(processor, "Filter Engine", 0.5f);
+        setParameter(processor, "Channel Mode", 0.5f);
+        setParameter(processor, getChannelParameterID(1, "Peak Gain"), 0.3f);
+        setParameter(processor, getChannelParameterID(1, "Band Count"), 2.f / BandTable::maxBands);
+    }
+
+    processor.getLatestChainSnapshot();
+}
+
+struct Instance
+{
+    std::unique_ptr<SimpleEQAudioProcessor> processor;
+    InstanceKind kind = Static;
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    juce::AudioBuffer<float> analyzerBuffer;
+};
+
+struct Result
+{
+    bench::Timings instanceBlocks, cycles;
+    double graphSeconds = 0.0;          // inside the cycles only, not the simulated message thread's turns
+    size_t residentBytesPerInstance = 0;
+};
+
+Result runSession(int numInstances, int numThreads)
+{
+    Result result;
+    const auto residentBefore = bench::getResidentBytes();
+
+    // every block starts from the same noise, so boosts don't compound from block to block
+    juce::AudioBuffer<float> noise(2, blockSize);
+    juce::Random random;
+    for( int ch = 0; ch < 2; ++ch )
+        for( int s = 0; s < blockSize; ++s )
+            noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+
+    std::vector<Instance> instances((size_t)numInstances);
+    for( int i = 0; i < numInstances; ++i )
+    {
+        auto& instance = instances[(size_t)i];
+        instance.processor = std::make_unique<SimpleEQAudioProcessor>();
+        instance.kind = InstanceKind(i % numInstanceKinds);
+        instance.processor->prepareToPlay(sampleRate, blockSize);
+        configure(*instance.processor, instance.kind);
+
+        instance.buffer.setSize(2, blockSize);
+        instance.analyzerBuffer.setSize(1, blockSize);
+    }
+
+    const auto residentAfter = bench::getResidentBytes();
+    result.residentBytesPerInstance = residentAfter > residentBefore ? (residentAfter - residentBefore) / (size_t)numInstances : 0;
+
+    const auto numCycles = juce::jmax(50, totalInstanceBlocks / numInstances);
+
+    std::atomic<int> cycle { -1 }, nextInstance { 0 }, workersDone { 0 };
+    std::atomic<bool> quit { false };
+    std::vector<bench::Timings> workerTimings((size_t)numThreads);
+
+    auto worker = [&](int index)
+    {
+        auto& timings = workerTimings[(size_t)index];
+        timings.reserve(size_t(numCycles) * size_t(numInstances) / size_t(numThreads) + 1024);
+        int seenCycle = -1;
+
+        for( ;; )
+        {
+            while( cycle.load(std::memory_order_acquire) == seenCycle && ! quit.load(std::memory_order_relaxed) )
+                std::this_thread::yield();
+
+            if( quit.load(std::memory_order_relaxed) )
+                return;
+
+            seenCycle = cycle.load(std::memory_order_acquire);
+
+            for( auto i = nextInstance.fetch_add(1); i < numInstances; i = nextInstance.fetch_add(1) )
+            {
+                auto& instance = instances[(size_t)i];
+                for( int ch = 0; ch < 2; ++ch )
+                    instance.buffer.copyFrom(ch, 0, noise, ch, 0, blockSize);
+
+                const auto start = bench::Clock::now();
+                instance.processor->processBlock(instance.buffer, instance.midi);
+                timings.add(bench::nanosecondsSince(start));
+            }
+
+            workersDone.fetch_add(1, std::memory_order_acq_rel);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for( int t = 0; t < numThreads; ++t )
+        workers.emplace_back(worker, t);
+
+    const auto blocksPerTimerTick = juce::jmax(1, int(0.01 * sampleRate / blockSize));
+
+    for( int c = 0; c < numCycles; ++c )
+    {
+        // the host's automation lands between blocks; the message thread runs alongside the graph
+        // in a real host, but here it takes its turn between cycles so the timings stay about the graph
+        for( auto& instance : instances )
+        {
+            if( instance.kind == Automating )
+            {
+                setParameter(*instance.processor, "Peak Freq", 0.3f + 0.2f * float(c % 50) / 50.f);
+                setParameter(*instance.processor, getBandParameterID(1, "Gain"), 0.4f + 0.2f * float(c % 30) / 30.f);
+            }
+        }
+
+        if( c % blocksPerTimerTick == 0 )
+        {
+            for( auto& instance : instances )
+            {
+                if( instance.kind == Automating )
+                    instance.processor->getLatestChainSnapshot();
+
+                if( instance.kind == Analyzer )
+                    for( auto* fifo : { &instance.processor->leftChannelFifo, &instance.processor->rightChannelFifo } )
+                        while( fifo->getNumCompleteBuffersAvailable() > 0 )
+                            fifo->getAudioBuffer(instance.analyzerBuffer);
+            }
+        }
+
+        const auto cycleStart = bench::Clock::now();
+        nextInstance.store(0, std::memory_order_relaxed);
+        workersDone.store(0, std::memory_order_relaxed);
+        cycle.store(c, std::memory_order_release);
+
+        while( workersDone.load(std::memory_order_acquire) < numThreads )
+            std::this_thread::yield();
+
+        const auto cycleNanoseconds = bench::nanosecondsSince(cycleStart);
+        result.cycles.add(cycleNanoseconds);
+        result.graphSeconds += cycleNanoseconds * 1e-9;
+    }
+
+    quit.store(true);
+    for( auto& thread : workers )
+        thread.join();
+
+    for( auto& timings : workerTimings )
+        result.instanceBlocks.nanoseconds.insert(result.instanceBlocks.nanoseconds.end(),
+                                                 timings.nanoseconds.begin(), timings.nanoseconds.end());
+
+    return result;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> counts;
+    for( int i = 1; i < argc; ++i )
+        counts.push_back(juce::jlimit(1, 1000, std::atoi(argv[i])));
+    if( counts.empty() )
+        counts = { 1, 10, 100, 300, 1000 };
+
+    const auto numThreads = juce::jmax(1, (int)std::thread::hardware_concurrency());
+    const auto blockPeriodMicroseconds = 1e6 * blockSize / sampleRate;
+
+    std::printf("%d-sample stereo blocks at %.0f Hz (%.0f us period), %d worker threads\n\n",
+                blockSize, sampleRate, blockPeriodMicroseconds, numThreads);
+
+    {
+        // what RSS per instance should be made of
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(sampleRate, blockSize);
+        std::printf("one instance's memory footprint:\n%s\n", processor.getMemoryFootprint().toString().toRawUTF8());
+    }
+
+    std::printf("%9s  %12s  %12s  %12s  %12s  %10s  %16s  %12s\n",
+                "instances", "block p50", "block p99", "cycle p50", "cycle p99", "cycle load", "inst-blocks/s", "RSS/inst");
+
+    for( auto numInstances : counts )
+    {
+        const auto result = runSession(numInstances, numThreads);
+        const auto& blocks = result.instanceBlocks;
+        const auto& cycles = result.cycles;
+
+        std::printf("%9d  %9.1f us  %9.1f us  %9.1f us  %9.1f us  %9.1f%%  %16.0f  %9.1f kB\n",
+                    numInstances,
+                    blocks.percentile(0.5) * 1e-3,
+                    blocks.percentile(0.99) * 1e-3,
+                    cycles.percentile(0.5) * 1e-3,
+                    cycles.percentile(0.99) * 1e-3,
+                    100.0 * cycles.percentile(0.99) * 1e-3 / blockPeriodMicroseconds,
+                    double(blocks.nanoseconds.size()) / result.graphSeconds,
+                    double(result.residentBytesPerInstance) / 1024.0);
+    }
+
+    return 0;
+}
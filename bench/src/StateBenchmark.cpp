@@ -0,0 +1,78 @@
+/*
+ Message thread cost of saving and restoring the plugin's state, which some hosts do for every
+ autosave and undo step, and of recalling a preset.
+
+ - ValueTree:   what getStateInformation / setStateInformation did before the binary format
+ - binary:      the fixed-layout BinaryState both ways
+ - bank recall: recallPreset() from a memory-mapped PresetBank, alternating between two presets
+                so every recall changes parameters and publishes a new chain
+ */
+
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+constexpr int numIterations = 2000;
+}
+
+int main()
+{
+    SimpleEQAudioProcessor processor{};
+    processor.prepareToPlay(48000.0, 256);
+
+    std::vector<float> first, second;
+    processor.apvts.getParameter("Band Count")->setValueNotifyingHost(0.5f);
+    processor.getParameterValues(first);
+    processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.8f);
+    processor.apvts.getParameter(getBandParameterID(2, "Gain"))->setValueNotifyingHost(0.3f);
+    processor.getParameterValues(second);
+
+    std::printf("%zu parameters\n", first.size());
+
+    bench::Timings treeSave, treeRestore, binarySave, binaryRestore, recall;
+
+    for( int i = 0; i < numIterations; ++i )
+    {
+        juce::MemoryBlock tree;
+        auto start = bench::Clock::now();
+        {
+            juce::MemoryOutputStream mos(tree, true);
+            processor.apvts.state.writeToStream(mos);
+        }
+        treeSave.add(bench::nanosecondsSince(start));
+
+        start = bench::Clock::now();
+        processor.setStateInformation(tree.getData(), (int)tree.getSize());
+        treeRestore.add(bench::nanosecondsSince(start));
+
+        juce::MemoryBlock binary;
+        start = bench::Clock::now();
+        processor.getStateInformation(binary);
+        binarySave.add(bench::nanosecondsSince(start));
+
+        start = bench::Clock::now();
+        processor.setStateInformation(binary.getData(), (int)binary.getSize());
+        binaryRestore.add(bench::nanosecondsSince(start));
+    }
+
+    const auto file = juce::File::createTempFile("bank");
+    PresetBank::write(file, { { "First", first }, { "Second", second } }, (int)first.size());
+    processor.openPresetBank(file);
+
+    for( int i = 0; i < numIterations; ++i )
+    {
+        const auto start = bench::Clock::now();
+        processor.recallPreset(i % 2);
+        recall.add(bench::nanosecondsSince(start));
+    }
+
+    treeSave.print("save, ValueTree");
+    treeRestore.print("restore, ValueTree");
+    binarySave.print("save, binary");
+    binaryRestore.print("restore, binary");
+    recall.print("bank recall");
+
+    file.deleteFile();
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ Per-block cost under continuous automation: the peak and low-cut frequencies follow an LFO so
+ every block carries new targets.
+
+ - biquad, per block:        today's behaviour, FilterDesign + makePeakFilter once per block
+ - biquad, every 8 samples:  what the biquad engine would need to track the same modulation rate
+ - SVF:                      SvfBank with its smoothed, every-8-samples coefficient updates
+ */
+
+#include "BenchmarkUtils.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+constexpr int blockSize = 256;
+constexpr int numBlocks = 4000;
+constexpr double sampleRate = 48000.0;
+
+ChainSettings automatedSettings(int blockIndex)
+{
+    const auto lfo = (float)std::sin(juce::MathConstants<double>::twoPi * 0.5 * blockIndex * blockSize / sampleRate);
+
+    ChainSettings settings;
+    settings.lowCutFreq = 80.f + 60.f * lfo;
+    settings.highCutFreq = 12000.f;
+    settings.peakFreq = 1000.f * std::pow(4.f, lfo);
+    settings.peakGainInDecibels = 9.f;
+    settings.peakQuality = 2.f;
+    settings.lowCutSlope = Slope_48;
+    settings.highCutSlope = Slope_24;
+    return settings;
+}
+
+void designInto(FilterBank<float>& bank, const ChainSettings& settings)
+{
+    updateCutSections(bank, FilterBank<float>::lowCutStart,
+                      makeLoCutFilter(settings, sampleRate), settings.lowCutSlope, false);
+    updateCutSections(bank, FilterBank<float>::hiCutStart,
+                      makeHiCutFilter(settings, sampleRate), settings.highCutSlope, false);
+    bank.setSection(FilterBank<float>::peakIndex, makePeakFilter(settings, sampleRate)->getRawCoefficients());
+    bank.setSectionEnabled(FilterBank<float>::peakIndex, true);
+}
+
+template<typename ProcessFn>
+bench::Timings run(ProcessFn&& processBlock)
+{
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::Random random;
+    bench::Timings timings;
+    timings.reserve(numBlocks);
+
+    for( int b = 0; b < numBlocks; ++b )
+    {
+        for( int ch = 0; ch < 2; ++ch )
+            for( int i = 0; i < blockSize; ++i )
+                buffer.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+        auto start = bench::Clock::now();
+        processBlock(buffer, automatedSettings(b));
+        timings.add(bench::nanosecondsSince(start));
+
+        bench::doNotOptimise(buffer.getSample(1, blockSize - 1));
+    }
+
+    return timings;
+}
+}
+
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("%d-sample stereo blocks, peak and low cut automated every block\n", blockSize);
+
+    FilterBank<float> perBlockBank;
+    perBlockBank.prepare(2, blockSize);
+    run([&](juce::AudioBuffer<float>& buffer, const ChainSettings& settings)
+    {
+        designInto(perBlockBank, settings);
+        perBlockBank.process(juce::dsp::AudioBlock<float>(buffer));
+    }).print("biquad, redesigned per block");
+
+    FilterBank<float> perSubBlockBank;
+    perSubBlockBank.prepare(2, blockSize);
+    run([&](juce::AudioBuffer<float>& buffer, const ChainSettings& settings)
+    {
+        juce::dsp::AudioBlock<float> block(buffer);
+        for( int start = 0; start < blockSize; start += SvfBank<float>::updateInterval )
+        {
+            designInto(perSubBlockBank, settings);
+            perSubBlockBank.process(block.getSubBlock((size_t)start, SvfBank<float>::updateInterval));
+        }
+    }).print("biquad, redesigned every 8 samples");
+
+    SvfBank<float> svfBank;
+    svfBank.prepare(sampleRate, 2);
+    run([&](juce::AudioBuffer<float>& buffer, const ChainSettings& settings)
+    {
+        svfBank.setTargets(settings);
+        svfBank.process(juce::dsp::AudioBlock<float>(buffer));
+    }).print("SVF, updated every 8 samples");
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ A trivially copyable value that any number of threads may store() and one thread load()s, with no
+ locks and no waiting: the value is kept as 32-bit atomic words, bracketed by counts of the stores
+ started and finished.
+
+ load() copies the words and only succeeds when no store was in progress when it began and none
+ started while it copied, so the reader never acts on a half-written value; it simply tries again
+ later.  Two stores running at once can interleave word by word.  As long as no field of T
+ straddles a word, the result is still a valid T made of fields from one or the other, the way two
+ parameters automated at once end up in the plugin's apvts.
+ */
+template<typename T>
+class AtomicWords
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "stored by copying its bytes");
+    static_assert(sizeof(T) % sizeof(uint32_t) == 0, "stored as whole 32-bit words");
+
+    // any thread
+    void store(const T& value)
+    {
+        std::array<uint32_t, numWords> source;
+        std::memcpy(source.data(), &value, sizeof(T));
+
+        started.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for( size_t i = 0; i < numWords; ++i )
+            words[i].store(source[i], std::memory_order_relaxed);
+
+        finished.fetch_add(1, std::memory_order_release);
+    }
+
+    // one reader; false, leaving value alone, if a store got in the way
+    bool load(T& value) const
+    {
+        const auto startedBefore = started.load(std::memory_order_acquire);
+        if( finished.load(std::memory_order_acquire) != startedBefore )
+            return false;
+
+        std::array<uint32_t, numWords> copy;
+        for( size_t i = 0; i < numWords; ++i )
+            copy[i] = words[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if( started.load(std::memory_order_relaxed) != startedBefore )
+            return false;
+
+        std::memcpy(&value, copy.data(), sizeof(T));
+        return true;
+    }
+
+    // changes with every completed store
+    uint32_t getVersion() const { return finished.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t numWords = sizeof(T) / sizeof(uint32_t);
+
+    std::array<std::atomic<uint32_t>, numWords> words {};
+    std::atomic<uint32_t> started { 0 }, finished { 0 };
+};
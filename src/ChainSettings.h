@@ -0,0 +1,179 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum FilterEngine
+{
+    BiquadEngine,       // FilterBank, redesigned once per parameter change
+    SvfEngine,          // SvfBank, smoothed and updated every few samples
+    LinearPhaseEngine   // LinearPhaseFilter, an FIR with the chain's magnitude and no phase shift
+};
+
+// what the dynamic peak's envelope follower listens to
+enum DynamicSource
+{
+    DetectInput,        // the signal arriving at the band
+    DetectSidechain     // the sidechain bus, falling back to the input when it isn't connected
+};
+
+// how the two channels share the chain
+enum ChannelMode
+{
+    LinkedStereo,       // one design, run on left and right alike
+    DualMono,           // left and right each with their own settings
+    MidSide             // mid and side each with their own settings, encoded and decoded around the filters
+};
+
+enum BandType
+{
+    BellBand,
+    LowShelfBand,
+    HighShelfBand,
+    NotchBand
+};
+
+/*
+ The parametric bands that sit between the Peak band and the high cut, one array per parameter so
+ that walking one parameter across the bands (checking what changed, building the active list)
+ reads contiguous memory.  Bands at or beyond numBands keep their settings but are never processed.
+ */
+struct BandTable
+{
+    static constexpr int maxBands = 16;
+
+    int numBands { 0 };
+    std::array<BandType, maxBands> type {};
+    std::array<float, maxBands> freq {}, gainInDecibels {}, quality {};
+    std::array<bool, maxBands> bypassed {};
+
+    // in use, not bypassed, and not a 0 dB bell or shelf (a notch cuts whatever its gain)
+    bool isActive(int band) const
+    {
+        return band < numBands
+            && ! bypassed[(size_t)band]
+            && (type[(size_t)band] == NotchBand || gainInDecibels[(size_t)band] != 0.f);
+    }
+
+    uint32_t getActiveMask() const
+    {
+        uint32_t mask = 0;
+        for( int band = 0; band < numBands; ++band )
+            if( isActive(band) )
+                mask |= 1u << band;
+
+        return mask;
+    }
+
+    // same response: same type, frequency, gain and Q
+    bool hasSameResponse(const BandTable& other, int band) const
+    {
+        const auto b = (size_t)band;
+        return type[b] == other.type[b]
+            && freq[b] == other.freq[b]
+            && gainInDecibels[b] == other.gainInDecibels[b]
+            && quality[b] == other.quality[b];
+    }
+};
+
+struct ChainSettings
+{
+    float peakFreq { 0 }, peakGainInDecibels{ 0 }, peakQuality { 1.f };
+    float lowCutFreq { 0 }, highCutFreq { 0 };
+    Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
+
+    bool loCutBypassed { false }, peakBypassed { false }, hiCutBypassed { false };
+
+    FilterEngine engine { FilterEngine::BiquadEngine };
+
+    // with peakDynamic set, the bell sits at 0 dB below the threshold and moves towards
+    // peakGainInDecibels as the detector goes above it (see DynamicPeak)
+    bool peakDynamic { false };
+    float dynamicThreshold { -24.f }, dynamicRatio { 4.f };
+    float dynamicAttackMs { 5.f }, dynamicReleaseMs { 100.f };
+    DynamicSource dynamicSource { DynamicSource::DetectInput };
+
+    BandTable bands;
+};
+
+inline bool operator==(const BandTable& a, const BandTable& b)
+{
+    return a.numBands == b.numBands && a.type == b.type && a.freq == b.freq
+        && a.gainInDecibels == b.gainInDecibels && a.quality == b.quality && a.bypassed == b.bypassed;
+}
+
+inline bool operator==(const ChainSettings& a, const ChainSettings& b)
+{
+    auto tie = [](const ChainSettings& s)
+    {
+        return std::tie(s.peakFreq, s.peakGainInDecibels, s.peakQuality, s.lowCutFreq, s.highCutFreq,
+                        s.lowCutSlope, s.highCutSlope, s.loCutBypassed, s.peakBypassed, s.hiCutBypassed,
+                        s.engine, s.peakDynamic, s.dynamicThreshold, s.dynamicRatio,
+                        s.dynamicAttackMs, s.dynamicReleaseMs, s.dynamicSource, s.bands);
+    };
+
+    return tie(a) == tie(b);
+}
+
+inline bool operator!=(const ChainSettings& a, const ChainSettings& b) { return ! (a == b); }
+
+// designs in SampleType; the GUI uses float, the processor designs in whichever precision the host runs
+template<typename SampleType = float>
+auto makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    // reference-counted wrapper around an array on the heap
+    // we want to copy its value here so we must de-reference it
+    // referencing the heap in an Audio program is bad design but here we are
+    return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate,
+                                                                    chainSettings.peakFreq,
+                                                                    chainSettings.peakQuality,
+                                                                    juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+template<typename SampleType = float>
+auto makeBandFilter(const BandTable& bands, int band, double sampleRate)
+{
+    using Coefficients = juce::dsp::IIR::Coefficients<SampleType>;
+
+    const auto b = (size_t)band;
+    const auto frequency = juce::jmin(SampleType(bands.freq[b]), SampleType(0.49 * sampleRate));
+    const auto quality = SampleType(bands.quality[b]);
+    const auto gain = juce::Decibels::decibelsToGain(SampleType(bands.gainInDecibels[b]));
+
+    switch( bands.type[b] )
+    {
+        case LowShelfBand:  return Coefficients::makeLowShelf(sampleRate, frequency, quality, gain);
+        case HighShelfBand: return Coefficients::makeHighShelf(sampleRate, frequency, quality, gain);
+        case NotchBand:     return Coefficients::makeNotch(sampleRate, frequency, quality);
+        case BellBand:      break;
+    }
+
+    return Coefficients::makePeakFilter(sampleRate, frequency, quality, gain);
+}
+
+template<typename SampleType = float>
+auto makeLoCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
+                                                                                             sampleRate,
+                                                                                             2 * (chainSettings.lowCutSlope + 1));
+}
+
+template<typename SampleType = float>
+auto makeHiCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
+                                                                                            sampleRate,
+                                                                                            2 * (chainSettings.highCutSlope + 1));
+}
@@ -0,0 +1,204 @@
+#include "ChainSnapshot.h"
+#include "MemoryFootprint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace
+{
+template<typename CoefficientArray>
+void storeCutSections(ChainSnapshot& snapshot,
+                      int firstSection,
+                      const CoefficientArray& cutCoefficients,
+                      Slope slope,
+                      bool bypassed)
+{
+    for( int stage = 0; stage < FilterBank<double>::numCutStages; ++stage )
+    {
+        if( bypassed || stage > (int)slope )
+            continue;
+
+        auto* raw = cutCoefficients[stage]->getRawCoefficients();
+        std::copy(raw, raw + ChainSnapshot::numCoefficients, snapshot.coefficients[size_t(firstSection + stage)].begin());
+        snapshot.enabledMask |= 1u << (firstSection + stage);
+    }
+}
+}
+
+double ChainSnapshot::getMagnitudeForFrequency(double frequency) const
+{
+    if( sampleRate <= 0.0 )
+        return 1.0;
+
+    const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto z1 = std::polar(1.0, -w);    // z^-1
+    const auto z2 = z1 * z1;                 // z^-2
+
+    double magnitude = 1.0;
+    for( int s = 0; s < numSections; ++s )
+    {
+        if( ! isSectionEnabled(s) )
+            continue;
+
+        const auto& c = coefficients[(size_t)s];
+        const auto numerator = c[0] + c[1] * z1 + c[2] * z2;
+        const auto denominator = 1.0 + c[3] * z1 + c[4] * z2;
+        magnitude *= std::abs(numerator / denominator);
+    }
+
+    return magnitude;
+}
+
+ChainSnapshot designChainSnapshot(const ChainSettings& chainSettings, double sampleRate, const ChainSnapshot* previous)
+{
+    ChainSnapshot snapshot;
+    snapshot.settings = chainSettings;
+    snapshot.sampleRate = sampleRate;
+
+    storeCutSections(snapshot,
+                     FilterBank<double>::lowCutStart,
+                     makeLoCutFilter<double>(chainSettings, sampleRate),
+                     chainSettings.lowCutSlope,
+                     chainSettings.loCutBypassed);
+
+    // a dynamic peak is run by DynamicPeak, which redesigns it every few samples
+    if( ! chainSettings.peakBypassed && ! chainSettings.peakDynamic )
+    {
+        auto peak = makePeakFilter<double>(chainSettings, sampleRate);
+        auto* raw = peak->getRawCoefficients();
+        std::copy(raw, raw + ChainSnapshot::numCoefficients, snapshot.coefficients[(size_t)FilterBank<double>::peakIndex].begin());
+        snapshot.enabledMask |= 1u << FilterBank<double>::peakIndex;
+    }
+
+    // dragging one band should cost one band's design, not all of them
+    const auto& bands = chainSettings.bands;
+    const auto canReuse = previous != nullptr && previous->sampleRate == sampleRate;
+
+    for( int band = 0; band < BandTable::maxBands; ++band )
+    {
+        if( ! bands.isActive(band) )
+            continue;
+
+        const auto section = FilterBank<double>::bandStart + band;
+        auto& coefficients = snapshot.coefficients[(size_t)section];
+
+        if( canReuse && previous->isSectionEnabled(section) && previous->settings.bands.hasSameResponse(bands, band) )
+        {
+            coefficients = previous->coefficients[(size_t)section];
+        }
+        else
+        {
+            auto designed = makeBandFilter<double>(bands, band, sampleRate);
+            auto* raw = designed->getRawCoefficients();
+            std::copy(raw, raw + ChainSnapshot::numCoefficients, coefficients.begin());
+            snapshot.designedBandMask |= 1u << band;
+        }
+
+        snapshot.enabledMask |= 1u << section;
+    }
+
+    storeCutSections(snapshot,
+                     FilterBank<double>::hiCutStart,
+                     makeHiCutFilter<double>(chainSettings, sampleRate),
+                     chainSettings.highCutSlope,
+                     chainSettings.hiCutBypassed);
+
+    return snapshot;
+}
+
+StereoChainSnapshot designStereoChainSnapshot(ChannelMode mode, const std::array<ChainSettings, 2>& settings,
+                                              double sampleRate, const StereoChainSnapshot* previous)
+{
+    StereoChainSnapshot snapshot;
+    snapshot.mode = mode;
+
+    if( previous != nullptr )
+        snapshot.channels = previous->channels;
+
+    const auto numChannels = mode == LinkedStereo ? 1 : 2;
+    for( int channel = 0; channel < numChannels; ++channel )
+    {
+        auto& target = snapshot.channels[(size_t)channel];
+        const auto& channelSettings = settings[(size_t)channel];
+
+        if( previous != nullptr && target.sampleRate == sampleRate && target.settings == channelSettings )
+        {
+            target.designedBandMask = 0;
+            continue;
+        }
+
+        target = designChainSnapshot(channelSettings, sampleRate, previous != nullptr ? &previous->channels[(size_t)channel] : nullptr);
+        snapshot.designedChannelMask |= 1u << channel;
+    }
+
+    return snapshot;
+}
+
+void ChainMagnitudeEvaluator::prepare(const std::vector<double>& frequencies, double sampleRate)
+{
+    const auto n = frequencies.size();
+    cosW.resize(n);
+    cos2W.resize(n);
+    numerator.resize(n);
+    denominator.resize(n);
+
+    for( size_t k = 0; k < n; ++k )
+    {
+        const auto w = juce::MathConstants<double>::twoPi * frequencies[k] / sampleRate;
+        cosW[k] = std::cos(w);
+        cos2W[k] = std::cos(2.0 * w);
+    }
+}
+
+size_t ChainMagnitudeEvaluator::getHeapSizeInBytes() const
+{
+    return ::getHeapSizeInBytes(cosW) + ::getHeapSizeInBytes(cos2W)
+         + ::getHeapSizeInBytes(numerator) + ::getHeapSizeInBytes(denominator);
+}
+
+void ChainMagnitudeEvaluator::accumulate(const ChainSnapshot& snapshot)
+{
+    const auto n = cosW.size();
+    std::fill(numerator.begin(), numerator.end(), 1.0);
+    std::fill(denominator.begin(), denominator.end(), 1.0);
+
+    double* num = numerator.data();
+    double* den = denominator.data();
+    const double* c1 = cosW.data();
+    const double* c2 = cos2W.data();
+
+    for( int s = 0; s < ChainSnapshot::numSections; ++s )
+    {
+        if( ! snapshot.isSectionEnabled(s) )
+            continue;
+
+        const auto& c = snapshot.coefficients[(size_t)s];
+        const auto b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+
+        const auto n0 = b0 * b0 + b1 * b1 + b2 * b2, n1 = 2.0 * b1 * (b0 + b2), n2 = 2.0 * b0 * b2;
+        const auto d0 = 1.0 + a1 * a1 + a2 * a2,     d1 = 2.0 * a1 * (1.0 + a2), d2 = 2.0 * a2;
+
+        for( size_t k = 0; k < n; ++k )
+        {
+            num[k] *= n0 + n1 * c1[k] + n2 * c2[k];
+            den[k] *= d0 + d1 * c1[k] + d2 * c2[k];
+        }
+    }
+}
+
+void ChainMagnitudeEvaluator::evaluate(const ChainSnapshot& snapshot, double* decibels)
+{
+    accumulate(snapshot);
+
+    for( size_t k = 0; k < cosW.size(); ++k )
+        decibels[k] = 10.0 * std::log10(juce::jmax(numerator[k], 1e-30) / denominator[k]);
+}
+
+void ChainMagnitudeEvaluator::evaluateGains(const ChainSnapshot& snapshot, double* gains)
+{
+    accumulate(snapshot);
+
+    for( size_t k = 0; k < cosW.size(); ++k )
+        gains[k] = std::sqrt(juce::jmax(numerator[k], 0.0) / denominator[k]);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ChainSettings.h"
+#include "FilterBank.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ An immutable, fully designed description of the chain: the settings it came from plus every
+ biquad section and the enabled-section mask.  Parametric band i is section FilterBank::bandStart + i.
+
+ Snapshots are designed on the message thread (the design allocates) and handed to the audio
+ thread through a TripleBuffer; the response curve draws from the same snapshot instead of
+ designing its own copy of the filters.  Coefficients are always designed in double and narrowed
+ by FilterBank<float> when it adopts them.
+ */
+struct ChainSnapshot
+{
+    static constexpr int numSections = FilterBank<double>::numSections;
+    static constexpr int numCoefficients = 5;   // {b0, b1, b2, a1, a2}
+
+    ChainSettings settings;
+    double sampleRate = 0.0;
+    uint32_t enabledMask = 0;
+    uint32_t version = 0;
+    uint32_t designedBandMask = 0;     // bands designed for this snapshot rather than carried over
+    std::array<std::array<double, numCoefficients>, numSections> coefficients {};
+
+    bool isSectionEnabled(int index) const { return (enabledMask & (1u << index)) != 0; }
+
+    // product of every enabled section's magnitude, as a linear gain
+    double getMagnitudeForFrequency(double frequency) const;
+
+    template<typename SampleType>
+    void applyTo(FilterBank<SampleType>& bank) const
+    {
+        for( int s = 0; s < numSections; ++s )
+        {
+            bank.setSection(s, coefficients[(size_t)s].data());
+            bank.setSectionEnabled(s, isSectionEnabled(s));
+        }
+    }
+};
+
+// runs the coefficient design for the given settings; allocates, so never call it on the audio thread.
+// Bands whose response is the same as in previous (at the same sample rate) keep its coefficients.
+ChainSnapshot designChainSnapshot(const ChainSettings& chainSettings, double sampleRate,
+                                  const ChainSnapshot* previous = nullptr);
+
+/*
+ What the audio thread adopts: the channel mode and a snapshot per lane.  Linked stereo runs
+ channels[0] on both channels; dual-mono runs channels[0] on the left and channels[1] on the
+ right, mid/side on the mid and the side.  channels[1] is left as it was while linked, so going
+ back to dual-mono or mid/side with the same settings costs no design.
+ */
+struct StereoChainSnapshot
+{
+    ChannelMode mode = LinkedStereo;
+    std::array<ChainSnapshot, 2> channels;
+    uint32_t designedChannelMask = 0;     // channels designed for this snapshot rather than carried over
+    uint32_t version = 0;
+
+    bool isLinked() const { return mode == LinkedStereo; }
+    const ChainSnapshot& getChannel(int lane) const { return channels[isLinked() ? 0 : (size_t)lane]; }
+
+    template<typename SampleType>
+    void applyTo(FilterBank<SampleType>& bank) const
+    {
+        bank.setMidSide(mode == MidSide);
+
+        if( isLinked() )
+        {
+            channels[0].applyTo(bank);
+            return;
+        }
+
+        // a section only one lane uses still runs on both, as a pass-through on the other
+        static constexpr double passThrough[ChainSnapshot::numCoefficients] { 1.0, 0.0, 0.0, 0.0, 0.0 };
+
+        for( int s = 0; s < ChainSnapshot::numSections; ++s )
+        {
+            for( int lane = 0; lane < FilterBank<SampleType>::numLanes; ++lane )
+            {
+                const auto& channel = channels[(size_t)lane];
+                bank.setSection(s, lane, channel.isSectionEnabled(s) ? channel.coefficients[(size_t)s].data() : passThrough);
+            }
+
+            bank.setSectionEnabled(s, channels[0].isSectionEnabled(s) || channels[1].isSectionEnabled(s));
+        }
+    }
+};
+
+// settings[1] is only looked at when the mode isn't linked; a channel whose settings match previous's is carried over
+StereoChainSnapshot designStereoChainSnapshot(ChannelMode mode, const std::array<ChainSettings, 2>& settings,
+                                              double sampleRate, const StereoChainSnapshot* previous = nullptr);
+
+/*
+ |H| of a whole chain at a fixed set of frequencies, for evaluating many candidate chains
+ quickly (the Match EQ fit) or one chain at thousands of frequencies (the linear-phase design).
+
+ prepare() stores cos(w) and cos(2w) per frequency.  For each section, |b0 + b1 z^-1 + b2 z^-2|^2
+ is then b0^2 + b1^2 + b2^2 + 2 b1 (b0 + b2) cos(w) + 2 b0 b2 cos(2w), and likewise for the poles,
+ so evaluating a chain is a few multiply-adds per section over contiguous arrays (which the
+ compiler vectorises) and one log or square root per frequency.  No complex arithmetic, no per-frequency calls.
+ */
+class ChainMagnitudeEvaluator
+{
+public:
+    void prepare(const std::vector<double>& frequencies, double sampleRate);
+
+    int getNumFrequencies() const { return (int)cosW.size(); }
+    size_t getHeapSizeInBytes() const;
+
+    void evaluate(const ChainSnapshot& snapshot, double* decibels);
+
+    // |H| as a linear gain instead of dB
+    void evaluateGains(const ChainSnapshot& snapshot, double* gains);
+
+private:
+    std::vector<double> cosW, cos2W, numerator, denominator;
+
+    // |numerator|^2 and |denominator|^2 of the whole chain, per frequency
+    void accumulate(const ChainSnapshot& snapshot);
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <cstdint>
+
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #include <x86intrin.h>
+#elif JUCE_INTEL && JUCE_MSVC
+ #include <intrin.h>
+#endif
+
+/*
+ Cheapest available monotonic counter for timing short stretches of DSP.  On x86 this is the TSC
+ and on 64-bit ARM the virtual counter, so the units are CPU-specific "cycles" - compare them with
+ each other, not with wall-clock time.  Other targets fall back to JUCE's high resolution ticks.
+ */
+inline uint64_t readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (uint64_t)__rdtsc();
+   #elif JUCE_ARM && JUCE_64BIT && (JUCE_GCC || JUCE_CLANG)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+   #else
+    return (uint64_t)juce::Time::getHighResolutionTicks();
+   #endif
+}
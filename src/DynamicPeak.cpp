@@ -0,0 +1,304 @@
+#include "DynamicPeak.h"
+#include "Instrumentation.h"
+#include "MemoryFootprint.h"
+
+template<typename SampleType>
+size_t DynamicPeak<SampleType>::getHeapSizeInBytes() const
+{
+    size_t bytes = 0;
+    for( const auto* v : { &envelope, &z1, &z2, &scratch, &detectorScratch } )
+        bytes += ::getHeapSizeInBytes(*v);
+
+    return bytes;
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::prepare(double newSampleRate, int newNumChannels, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    numChannels = juce::jmax(1, newNumChannels);
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+
+    // at least two, so the stereo path can always load a pair
+    const auto numStates = (size_t)juce::jmax(2, numChannels);
+    envelope.assign(numStates, SampleType(0));
+    z1.assign(numStates, SampleType(0));
+    z2.assign(numStates, SampleType(0));
+
+    const auto scratchSize = numChannels == 2 ? size_t(2 * maxBlockSize) : 0;
+    scratch.assign(scratchSize, SampleType(0));
+    detectorScratch.assign(scratchSize, SampleType(0));
+
+    active = false;
+    updateCoefficients(0);
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::reset()
+{
+    std::fill(envelope.begin(), envelope.end(), SampleType(0));
+    std::fill(z1.begin(), z1.end(), SampleType(0));
+    std::fill(z2.begin(), z2.end(), SampleType(0));
+
+    updateCoefficients(0);
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::setSettings(const ChainSettings& chainSettings)
+{
+    const auto wasActive = active;
+    active = chainSettings.peakDynamic && ! chainSettings.peakBypassed && chainSettings.peakGainInDecibels != 0.f;
+
+    const auto frequency = juce::jmin(double(chainSettings.peakFreq), 0.49 * sampleRate);
+    const auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    cosTerm = SampleType(-2.0 * std::cos(w0));
+    alpha = SampleType(std::sin(w0) / (2.0 * chainSettings.peakQuality));
+
+    thresholdPower = SampleType(std::pow(10.0, chainSettings.dynamicThreshold / 10.0));
+    exponent = SampleType((1.0 - 1.0 / juce::jmax(1.f, chainSettings.dynamicRatio)) / 4.0);
+    maxA = SampleType(std::pow(10.0, std::abs(chainSettings.peakGainInDecibels) / 40.0));
+    cuts = chainSettings.peakGainInDecibels < 0.f;
+
+    auto onePole = [this](float milliseconds)
+    {
+        return SampleType(std::exp(-1.0 / (juce::jmax(0.01, milliseconds * 0.001 * sampleRate))));
+    };
+
+    const auto attack = onePole(chainSettings.dynamicAttackMs);
+    const auto release = onePole(chainSettings.dynamicReleaseMs);
+
+    // the follower steps once per sub-block of n samples, so it needs the coefficients to the nth power
+    attackSteps[0] = releaseSteps[0] = SampleType(1);
+    for( size_t n = 1; n < attackSteps.size(); ++n )
+    {
+        attackSteps[n] = attackSteps[n - 1] * attack;
+        releaseSteps[n] = releaseSteps[n - 1] * release;
+    }
+
+    // a band switching in starts from silence rather than whatever it held when it was switched off
+    if( active && ! wasActive )
+        reset();
+}
+
+template<typename SampleType>
+float DynamicPeak<SampleType>::getCurrentGainDecibels() const
+{
+    return 40.f * std::log10(currentA.load(std::memory_order_relaxed));
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::updateCoefficients(SampleType power)
+{
+    // 10^(gain / 40), from (1 - 1 / ratio) dB of gain per dB of overshoot
+    auto A = SampleType(1);
+    if( power > thresholdPower )
+        A = juce::jmin(maxA, std::pow(power / thresholdPower, exponent));
+
+    if( cuts )
+        A = SampleType(1) / A;
+
+    // RBJ bell with numerator and denominator multiplied through by A, so a0 = A + alpha
+    const auto inverseA0 = SampleType(1) / (A + alpha);
+    b0 = A * (SampleType(1) + alpha * A) * inverseA0;
+    b1 = cosTerm * A * inverseA0;
+    b2 = A * (SampleType(1) - alpha * A) * inverseA0;
+    a2 = (A - alpha) * inverseA0;
+
+    currentA.store(float(A), std::memory_order_relaxed);
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block,
+                                      const juce::dsp::AudioBlock<SampleType>* sidechain)
+{
+    SIMPLEEQ_ZONE_NAMED("DynamicPeak::process");
+
+    jassert(isPrepared());
+
+    if( ! active )
+        return;
+
+    if( sidechain != nullptr && sidechain->getNumChannels() == 0 )
+        sidechain = nullptr;
+
+    jassert(sidechain == nullptr || sidechain->getNumSamples() >= block.getNumSamples());
+
+    if( numChannels == 2 && block.getNumChannels() >= 2 )
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+        const SampleType* detectorLeft = nullptr;
+        const SampleType* detectorRight = nullptr;
+
+        if( sidechain != nullptr )
+        {
+            detectorLeft = sidechain->getChannelPointer(0);
+            detectorRight = sidechain->getChannelPointer(juce::jmin((size_t)1, sidechain->getNumChannels() - 1));
+        }
+
+        // hosts may send bigger blocks than promised; the scratch only holds maxBlockSize frames
+        for( int start = 0, remaining = (int)block.getNumSamples(); remaining > 0; )
+        {
+            const auto n = juce::jmin(remaining, maxBlockSize);
+            processStereo(left + start, right + start,
+                          detectorLeft != nullptr ? detectorLeft + start : nullptr,
+                          detectorRight != nullptr ? detectorRight + start : nullptr,
+                          n);
+            start += n;
+            remaining -= n;
+        }
+        return;
+    }
+
+    processChannels(block, sidechain);
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::processStereo(SampleType* left, SampleType* right,
+                                            const SampleType* detectorLeft, const SampleType* detectorRight,
+                                            int numSamples)
+{
+    using Lanes = StereoLanes<SampleType>;
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        scratch[size_t(2 * i)] = left[i];
+        scratch[size_t(2 * i + 1)] = right[i];
+    }
+
+    const SampleType* detector = scratch.data();
+    if( detectorLeft != nullptr )
+    {
+        for( int i = 0; i < numSamples; ++i )
+        {
+            detectorScratch[size_t(2 * i)] = detectorLeft[i];
+            detectorScratch[size_t(2 * i + 1)] = detectorRight[i];
+        }
+        detector = detectorScratch.data();
+    }
+
+    auto* samples = scratch.data();
+    auto env = Lanes::load(envelope.data());
+    auto s1 = Lanes::load(z1.data());
+    auto s2 = Lanes::load(z2.data());
+
+    for( int start = 0; start < numSamples; start += updateInterval )
+    {
+        const auto end = juce::jmin(numSamples, start + updateInterval);
+
+        // mean square over the sub-block, then one attack/release step for all of it
+        auto sum = Lanes::expand(SampleType(0));
+        for( int i = start; i < end; ++i )
+        {
+            const auto x = Lanes::load(detector + 2 * i);
+            sum = sum + x * x;
+        }
+
+        const auto n = size_t(end - start);
+        const auto power = sum * Lanes::expand(SampleType(1) / SampleType(n));
+        // the envelope releases by the part of the distance above the power and attacks by the
+        // part below it; one of the two is always zero, which picks the coefficient without a branch
+        const auto distance = env - power;
+        const auto falling = Lanes::max(distance, Lanes::expand(SampleType(0)));
+        env = power + Lanes::expand(releaseSteps[n]) * falling + Lanes::expand(attackSteps[n]) * (distance - falling);
+
+        env.store(envelope.data());
+        updateCoefficients(juce::jmax(envelope[0], envelope[1]));
+
+        const auto cb0 = Lanes::expand(b0);
+        const auto cb1 = Lanes::expand(b1);
+        const auto cb2 = Lanes::expand(b2);
+        const auto ca2 = Lanes::expand(a2);
+
+        // transposed direct form II, as FilterBank; a1 == b1 for a bell
+        for( int i = start; i < end; ++i )
+        {
+            const auto x = Lanes::load(samples + 2 * i);
+            const auto y = cb0 * x + s1;
+            s1 = cb1 * (x - y) + s2;
+            s2 = cb2 * x - ca2 * y;
+            y.store(samples + 2 * i);
+        }
+    }
+
+    s1.store(z1.data());
+    s2.store(z2.data());
+
+    for( int ch = 0; ch < 2; ++ch )
+    {
+        JUCE_SNAP_TO_ZERO(envelope[(size_t)ch]);
+        JUCE_SNAP_TO_ZERO(z1[(size_t)ch]);
+        JUCE_SNAP_TO_ZERO(z2[(size_t)ch]);
+    }
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        left[i] = scratch[size_t(2 * i)];
+        right[i] = scratch[size_t(2 * i + 1)];
+    }
+}
+
+template<typename SampleType>
+void DynamicPeak<SampleType>::processChannels(const juce::dsp::AudioBlock<SampleType>& block,
+                                              const juce::dsp::AudioBlock<SampleType>* sidechain)
+{
+    const auto channelsToProcess = juce::jmin((int)block.getNumChannels(), numChannels);
+    const auto numSamples = (int)block.getNumSamples();
+
+    for( int start = 0; start < numSamples; start += updateInterval )
+    {
+        const auto n = juce::jmin(updateInterval, numSamples - start);
+        auto level = SampleType(0);
+
+        for( int ch = 0; ch < channelsToProcess; ++ch )
+        {
+            const auto* detector = sidechain != nullptr
+                                 ? sidechain->getChannelPointer(juce::jmin((size_t)ch, sidechain->getNumChannels() - 1))
+                                 : block.getChannelPointer((size_t)ch);
+            detector += start;
+
+            auto sum = SampleType(0);
+            for( int i = 0; i < n; ++i )
+                sum += detector[i] * detector[i];
+
+            const auto power = sum / SampleType(n);
+            const auto distance = envelope[(size_t)ch] - power;
+            const auto falling = juce::jmax(distance, SampleType(0));
+            const auto env = power + releaseSteps[(size_t)n] * falling + attackSteps[(size_t)n] * (distance - falling);
+
+            envelope[(size_t)ch] = env;
+            level = juce::jmax(level, env);
+        }
+
+        updateCoefficients(level);
+
+        for( int ch = 0; ch < channelsToProcess; ++ch )
+        {
+            auto* samples = block.getChannelPointer((size_t)ch) + start;
+            auto s1 = z1[(size_t)ch];
+            auto s2 = z2[(size_t)ch];
+
+            for( int i = 0; i < n; ++i )
+            {
+                const auto x = samples[i];
+                const auto y = b0 * x + s1;
+                s1 = b1 * (x - y) + s2;
+                s2 = b2 * x - a2 * y;
+                samples[i] = y;
+            }
+
+            z1[(size_t)ch] = s1;
+            z2[(size_t)ch] = s2;
+        }
+    }
+
+    for( int ch = 0; ch < channelsToProcess; ++ch )
+    {
+        JUCE_SNAP_TO_ZERO(envelope[(size_t)ch]);
+        JUCE_SNAP_TO_ZERO(z1[(size_t)ch]);
+        JUCE_SNAP_TO_ZERO(z2[(size_t)ch]);
+    }
+}
+
+template class DynamicPeak<float>;
+template class DynamicPeak<double>;
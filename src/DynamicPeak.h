@@ -0,0 +1,79 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChainSettings.h"
+#include "FilterBank.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+/*
+ The Peak band as a dynamic EQ: an envelope follower moves the bell's gain between 0 dB and the
+ Peak Gain setting.
+
+ Above the threshold the gain moves by (1 - 1 / ratio) dB per dB of overshoot, capped at Peak Gain,
+ so a negative Peak Gain ducks the band when the signal gets loud and a positive one lifts it.  The
+ detector listens to the sidechain bus when that is selected and connected, and otherwise to the
+ signal arriving at the band, which has been through the rest of the chain, high cut included.  It
+ takes the mean square of each update interval and runs one attack/release step on it, per channel
+ side by side in StereoLanes; the channels are linked by taking the loudest.
+
+ Frequency and Q only change with a new snapshot, so setSettings() caches cos(w0) and alpha and an
+ update, every updateInterval samples, recomputes just the gain-dependent terms of the RBJ bell:
+ one pow() and one division, no FilterDesign and no allocation.
+ */
+template<typename SampleType>
+class DynamicPeak
+{
+public:
+    static constexpr int updateInterval = 16;
+
+    void prepare(double sampleRate, int numChannels, int maximumBlockSize);
+    void reset();
+    bool isPrepared() const { return numChannels > 0; }
+    size_t getHeapSizeInBytes() const;
+
+    // cheap and allocation free, so the audio thread can call it when it adopts a snapshot
+    void setSettings(const ChainSettings& chainSettings);
+
+    // dynamic, not bypassed, and with some gain to move through
+    bool isActive() const { return active; }
+
+    // filters block in place; the detector listens to sidechain if given, block otherwise
+    void process(const juce::dsp::AudioBlock<SampleType>& block,
+                 const juce::dsp::AudioBlock<SampleType>* sidechain = nullptr);
+
+    // the bell's gain as of the last update; safe to read from any thread
+    float getCurrentGainDecibels() const;
+
+private:
+    // cached per snapshot
+    SampleType cosTerm = 0, alpha = 0;              // -2 cos(w0) and sin(w0) / 2Q
+    SampleType thresholdPower = 1, exponent = 0;    // A = (power / thresholdPower) ^ exponent above threshold
+    SampleType maxA = 1;
+    std::array<SampleType, updateInterval + 1> attackSteps {}, releaseSteps {};    // one-pole coefficients per n samples
+    bool cuts = false;
+    bool active = false;
+
+    // current bell, {b0, b1, b2, a1, a2} normalised by a0; b1 == a1 for a bell
+    SampleType b0 = 1, b1 = 0, b2 = 0, a2 = 0;
+    std::atomic<float> currentA { 1.f };
+
+    // per channel; the stereo path loads these as one 2-lane value (vector storage is 16-byte aligned)
+    std::vector<SampleType> envelope, z1, z2;
+
+    // interleaved stereo, 2 * maxBlockSize each
+    std::vector<SampleType> scratch, detectorScratch;
+
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+
+    void updateCoefficients(SampleType power);
+    void processStereo(SampleType* left, SampleType* right,
+                       const SampleType* detectorLeft, const SampleType* detectorRight, int numSamples);
+    void processChannels(const juce::dsp::AudioBlock<SampleType>& block,
+                         const juce::dsp::AudioBlock<SampleType>* sidechain);
+};
@@ -0,0 +1,195 @@
+#include "EqEngine.h"
+
+#include <thread>
+#include <cmath>
+
+EqEngine::Settings EqEngine::getDefaultSettings()
+{
+    Settings settings;
+
+    for( auto& chain : settings.channels )
+    {
+        chain.lowCutFreq = 20.f;
+        chain.highCutFreq = 20000.f;
+        chain.peakFreq = 750.f;
+        chain.peakGainInDecibels = 0.f;
+        chain.peakQuality = 1.f;
+
+        // log-spaced from 50 Hz to 20 kHz, as in the parameter layout
+        for( int band = 0; band < BandTable::maxBands; ++band )
+        {
+            const auto b = (size_t)band;
+            chain.bands.freq[b] = std::round(50.f * std::pow(10.f, 2.6f * float(band) / float(BandTable::maxBands - 1)));
+            chain.bands.quality[b] = 1.f;
+        }
+    }
+
+    return settings;
+}
+
+EqEngine::EqEngine()
+{
+    pendingSettings.store(getDefaultSettings());
+}
+
+void EqEngine::setSettings(const Settings& settings)
+{
+    pendingSettings.store(settings);
+}
+
+void EqEngine::prepare(double newSampleRate, int newNumChannels, int maximumBlockSize)
+{
+    const std::lock_guard<std::mutex> lock(designLock);
+
+    sampleRate = newSampleRate;
+    numChannels = juce::jlimit(1, 2, newNumChannels);
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+
+    engines.biquads.prepare(numChannels, maxBlockSize);
+    engines.biquads.reset();
+    engines.svfs.prepare(sampleRate, numChannels);
+    engines.dynamicPeak.prepare(sampleRate, numChannels, maxBlockSize);
+    linearPhase.prepare(sampleRate, numChannels, LinearPhaseFilter::getFirOrderForSampleRate(sampleRate));
+
+    planarScratch.assign(size_t(numChannels) * size_t(maxBlockSize), 0.f);
+
+    // the sample rate may have changed, so design now; nothing is processing while we're in here,
+    // which makes it safe to take the reader's side of the hand-off too
+    Settings settings;
+    designedVersion = pendingSettings.getVersion();
+    while( ! pendingSettings.load(settings) )
+        std::this_thread::yield();
+
+    publish(settings);
+    snapshots.acquireLatest();
+
+    if( engines.adopt(snapshots.getReadBuffer()) )
+        linearPhase.reset();
+
+    // settle the SVF smoothers on the current settings rather than gliding in from the last ones
+    engines.svfs.reset();
+}
+
+bool EqEngine::update()
+{
+    const std::lock_guard<std::mutex> lock(designLock);
+
+    // nothing sensible to design until prepare() has told us the sample rate, which designs
+    // whatever was stored before it
+    if( sampleRate <= 0.0 )
+        return false;
+
+    const auto version = pendingSettings.getVersion();
+    if( version == designedVersion )
+        return false;
+
+    // a store in progress; the next update() will see it finished
+    Settings settings;
+    if( ! pendingSettings.load(settings) )
+        return false;
+
+    designedVersion = version;
+    publish(settings);
+    return true;
+}
+
+void EqEngine::publish(Settings settings)
+{
+    // the engine and the dynamic peak are the first channel's for both, as with the plugin's
+    // parameters; the dynamic peak's detector is shared by both channels, so it only runs linked
+    settings.channels[1].engine = settings.channels[0].engine;
+    if( settings.mode != LinkedStereo )
+        settings.channels[0].peakDynamic = false;
+
+    auto& snapshot = snapshots.getWriteBuffer();
+    snapshot = designStereoChainSnapshot(settings.mode, settings.channels, sampleRate, &latestSnapshot);
+    snapshot.version = nextSnapshotVersion++;
+
+    // queued before the snapshot that selects it, so the audio thread never runs without a kernel
+    const auto linearPhaseActive = snapshot.channels[0].settings.engine == FilterEngine::LinearPhaseEngine && linearPhase.isPrepared();
+    if( linearPhaseActive )
+        linearPhase.designKernel(snapshot);
+
+    latencySamples.store(linearPhaseActive ? linearPhase.getLatencySamples() : 0, std::memory_order_relaxed);
+
+    latestSnapshot = snapshot;
+    snapshots.publish();
+}
+
+void EqEngine::adoptLatestSnapshot()
+{
+    if( snapshots.acquireLatest() && engines.adopt(snapshots.getReadBuffer()) )
+        linearPhase.reset();
+}
+
+void EqEngine::process(float* const* channels, int numChannelsToProcess, int numSamples)
+{
+    if( ! isPrepared() )
+        return;
+
+    juce::ScopedNoDenormals noDenormals;
+    adoptLatestSnapshot();
+
+    const auto channelsToProcess = (size_t)juce::jmin(numChannelsToProcess, numChannels);
+
+    for( int done = 0; done < numSamples; )
+    {
+        const auto n = juce::jmin(numSamples - done, maxBlockSize);
+        processBlock(juce::dsp::AudioBlock<float>(channels, channelsToProcess, (size_t)done, (size_t)n));
+        done += n;
+    }
+}
+
+void EqEngine::processInterleaved(float* frames, int numInterleavedChannels, int numFrames)
+{
+    if( ! isPrepared() )
+        return;
+
+    juce::ScopedNoDenormals noDenormals;
+    adoptLatestSnapshot();
+
+    if( numInterleavedChannels == numChannels
+        && engines.active == FilterEngine::BiquadEngine
+        && ! engines.dynamicPeak.isActive() )
+    {
+        engines.biquads.processInterleaved(frames, numFrames);
+        return;
+    }
+
+    const auto channelsToProcess = juce::jmin(numInterleavedChannels, numChannels);
+
+    float* planar[2] {};
+    for( int ch = 0; ch < channelsToProcess; ++ch )
+        planar[ch] = planarScratch.data() + ch * maxBlockSize;
+
+    for( int done = 0; done < numFrames; )
+    {
+        const auto n = juce::jmin(numFrames - done, maxBlockSize);
+        auto* block = frames + done * numInterleavedChannels;
+
+        for( int ch = 0; ch < channelsToProcess; ++ch )
+            for( int i = 0; i < n; ++i )
+                planar[ch][i] = block[i * numInterleavedChannels + ch];
+
+        processBlock(juce::dsp::AudioBlock<float>(planar, (size_t)channelsToProcess, (size_t)n));
+
+        for( int ch = 0; ch < channelsToProcess; ++ch )
+            for( int i = 0; i < n; ++i )
+                block[i * numInterleavedChannels + ch] = planar[ch][i];
+
+        done += n;
+    }
+}
+
+void EqEngine::processBlock(const juce::dsp::AudioBlock<float>& block)
+{
+    if( engines.active == FilterEngine::LinearPhaseEngine )
+        linearPhase.process(block);
+    else if( engines.active == FilterEngine::SvfEngine )
+        engines.svfs.process(block);
+    else
+        engines.biquads.process(block);
+
+    if( engines.dynamicPeak.isActive() )
+        engines.dynamicPeak.process(block);
+}
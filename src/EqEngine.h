@@ -0,0 +1,88 @@
+#pragma once
+
+#include "AtomicWords.h"
+#include "ChainSettings.h"
+#include "ChainSnapshot.h"
+#include "FilterEngines.h"
+#include "LinearPhaseFilter.h"
+#include "TripleBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/*
+ The plugin's DSP without juce::AudioProcessor, an apvts or an editor: the biquad and SVF engines,
+ the dynamic peak and the linear-phase FIR, driven by plain settings instead of parameters.  The C
+ API in SimpleEQCore.h is a thin wrapper around it; the processor runs the same classes itself.
+
+ The threads split the work the way they do in the plugin, except that the engine owns no thread
+ of its own; whoever embeds it decides where and how often designing happens:
+
+    setSettings()       any thread, wait-free; only stores the settings (see AtomicWords)
+    update()            any thread that may block and allocate; designs the settings into a snapshot
+                        (and a linear-phase kernel) and publishes it, if they changed since last time
+    process...()        the audio thread; adopts the newest snapshot at the start of a call
+    prepare()           allocates and designs inline; never while process...() is running
+
+ Always processes in float, up to two channels; channels beyond those are left alone.
+ */
+class EqEngine
+{
+public:
+    struct Settings
+    {
+        ChannelMode mode { LinkedStereo };
+        std::array<ChainSettings, 2> channels;     // channels[1] is only used when not linked
+    };
+
+    // the plugin's parameter defaults: both cuts open, a flat Peak band, no parametric bands
+    static Settings getDefaultSettings();
+
+    EqEngine();
+
+    void prepare(double sampleRate, int numChannels, int maximumBlockSize);
+    bool isPrepared() const { return engines.isPrepared(); }
+
+    void setSettings(const Settings& settings);
+
+    // true if there were new settings to design; cheap when there weren't
+    bool update();
+
+    // the linear-phase FIR's delay while it is the active engine, 0 otherwise
+    int getLatencySamples() const { return latencySamples.load(std::memory_order_relaxed); }
+
+    // In place, on the caller's buffers.  Blocks longer than the prepared maximum are processed in pieces.
+    void process(float* const* channels, int numChannels, int numSamples);
+
+    // Frames of numChannels interleaved samples.  The biquad engine filters them where they are;
+    // the SVF and linear-phase engines and the dynamic peak only run on separate channels, so
+    // with those the frames are split into a scratch buffer and back, a prepared block at a time.
+    void processInterleaved(float* frames, int numChannels, int numFrames);
+
+private:
+    FilterEngines<float> engines;
+    LinearPhaseFilter linearPhase;
+
+    AtomicWords<Settings> pendingSettings;
+    TripleBuffer<StereoChainSnapshot> snapshots;
+
+    // writer side only: the design thread vs. prepare()
+    std::mutex designLock;
+    StereoChainSnapshot latestSnapshot;     // the last one published
+    uint32_t designedVersion = 0;
+    uint32_t nextSnapshotVersion = 1;
+
+    std::atomic<int> latencySamples { 0 };
+
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    std::vector<float> planarScratch;       // numChannels * maxBlockSize, for processInterleaved()
+
+    void publish(Settings settings);        // with designLock held
+
+    void adoptLatestSnapshot();
+    void processBlock(const juce::dsp::AudioBlock<float>& block);
+};
@@ -0,0 +1,76 @@
+#include "FFTBackend.h"
+
+#include "MemoryFootprint.h"
+#include "RealFFT.h"
+#include "SharedTables.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+struct JuceEngine final : FFTBackend
+{
+    explicit JuceEngine(int order) :
+    FFTBackend(order),
+    fft(SharedTables::getJuceFFT(order)),
+    workspace((size_t)getSize() * 2, 0.f)
+    {
+    }
+
+    void performMagnitudes(const float* input, float* magnitudes) noexcept override
+    {
+        const auto size = getSize();
+        std::copy(input, input + size, workspace.begin());
+        fft->performFrequencyOnlyForwardTransform(workspace.data(), true);
+        std::copy(workspace.begin(), workspace.begin() + getNumBins(), magnitudes);
+    }
+
+    size_t getHeapSizeInBytes() const override { return ::getHeapSizeInBytes(workspace); }
+
+    std::shared_ptr<const juce::dsp::FFT> fft;
+    std::vector<float> workspace;   // works in place on 2N floats
+};
+
+struct BundledEngine final : FFTBackend
+{
+    explicit BundledEngine(int order) :
+    FFTBackend(order),
+    fft(order)
+    {
+    }
+
+    void performMagnitudes(const float* input, float* magnitudes) noexcept override
+    {
+        fft.performMagnitudes(input, magnitudes);
+    }
+
+    size_t getHeapSizeInBytes() const override { return fft.getHeapSizeInBytes(); }
+
+    RealFFT fft;
+};
+}
+
+std::unique_ptr<FFTBackend> FFTBackend::create(FFTBackendType type, int order)
+{
+    switch( type )
+    {
+        case JuceFFTBackend:    return std::make_unique<JuceEngine>(order);
+        case BundledFFTBackend: return std::make_unique<BundledEngine>(order);
+    }
+
+    jassertfalse;
+    return std::make_unique<BundledEngine>(order);
+}
+
+const char* FFTBackend::getName(FFTBackendType type)
+{
+    switch( type )
+    {
+        case JuceFFTBackend:    return "juce";
+        case BundledFFTBackend: return "bundled";
+    }
+
+    jassertfalse;
+    return "";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+
+enum FFTBackendType
+{
+    JuceFFTBackend,
+    BundledFFTBackend
+};
+
+#ifndef SIMPLEEQ_DEFAULT_FFT_BACKEND
+ #define SIMPLEEQ_DEFAULT_FFT_BACKEND BundledFFTBackend
+#endif
+
+/*
+ The forward magnitude transform the analyzer needs, behind one interface so the engine can be
+ chosen at build time (SIMPLEEQ_FFT_BACKEND in CMake sets the default) or switched at run time.
+
+ JuceFFTBackend is juce::dsp::FFT, i.e. whatever engine JUCE picks for the platform.
+ BundledFFTBackend is RealFFT, which is the same everywhere and cheaper than JUCE's fallback engine.
+ */
+class FFTBackend
+{
+public:
+    virtual ~FFTBackend() = default;
+
+    static constexpr FFTBackendType defaultType = SIMPLEEQ_DEFAULT_FFT_BACKEND;
+
+    static std::unique_ptr<FFTBackend> create(FFTBackendType type, int order);
+    static const char* getName(FFTBackendType type);
+
+    int getSize() const { return 1 << order; }
+    int getNumBins() const { return getSize() / 2 + 1; }
+
+    /**
+     writes |X[k]| for the getNumBins() non-negative frequency bins of getSize() input samples,
+     unnormalised.  Never allocates.
+     */
+    virtual void performMagnitudes(const float* input, float* magnitudes) noexcept = 0;
+
+    // this backend's own buffers, not the plans it shares with every other backend of its order
+    virtual size_t getHeapSizeInBytes() const = 0;
+
+protected:
+    explicit FFTBackend(int fftOrder) : order(fftOrder) {}
+
+private:
+    int order;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "MemoryFootprint.h"
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// what Fifo::push() does when every slot holds an entry the reader hasn't pulled yet
+enum FifoOverflowPolicy
+{
+    DropNewest,         // keep what is queued and refuse the new entry
+    OverwriteOldest     // replace the oldest unread entry, so the reader always gets the newest data
+};
+
+/*
+ Single-producer / single-consumer queue of preallocated entries, sized in prepare().
+
+ Each slot carries a sequence number (seqlock style), so with OverwriteOldest the writer never
+ waits for the reader: a reader that has been lapped skips ahead to the oldest surviving entry, and
+ a copy that raced with an overwrite is detected and thrown away.  Entries must keep the size they
+ were prepared with so that copying one in or out never allocates.
+ */
+template<typename T>
+struct Fifo
+{
+    static constexpr int defaultCapacity = 30;
+
+    Fifo() { allocate(defaultCapacity); }
+
+    void prepare(int numChannels, int numSamples, int numEntries = defaultCapacity)
+    {
+        static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
+                      "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
+        allocate(numEntries);
+        for( auto& buffer : buffers)
+        {
+            buffer.setSize(numChannels,
+                           numSamples,
+                           false,   //clear everything?
+                           true,    //including the extra space?
+                           true);   //avoid reallocating if you can?
+            buffer.clear();
+        }
+    }
+    
+    void prepare(size_t numElements, int numEntries = defaultCapacity)
+    {
+        static_assert( std::is_same_v<T, std::vector<typename T::value_type>>,
+                      "prepare(numElements) should only be used when the Fifo is holding a std::vector");
+        allocate(numEntries);
+        for( auto& buffer : buffers )
+        {
+            buffer.clear();
+            buffer.resize(numElements, 0);
+        }
+    }
+
+    // for entries that need no preparing, e.g. juce::Path; empties the queue like prepare()
+    void setCapacity(int numEntries) { allocate(numEntries); }
+
+    // set this before the producer starts pushing
+    void setOverflowPolicy(FifoOverflowPolicy newPolicy) { policy = newPolicy; }
+    
+    bool push(const T& t)
+    {
+        const auto write = writePosition.load(std::memory_order_relaxed);
+        const auto read = readPosition.load(std::memory_order_acquire);
+
+        if( write - read >= (uint64_t)capacity )
+        {
+            if( policy == DropNewest )
+            {
+                numDropped += 1;
+                return false;
+            }
+
+            numOverwritten += 1;
+        }
+
+        const auto slot = size_t(write % (uint64_t)capacity);
+        auto& sequence = sequences[slot];
+
+        // odd while the slot is being written
+        sequence.store(2 * write + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffers[slot] = t;
+        sequence.store(2 * write + 2, std::memory_order_release);
+
+        writePosition.store(write + 1, std::memory_order_release);
+        return true;
+    }
+    
+    bool pull(T& t)
+    {
+        for( ;; )
+        {
+            const auto write = writePosition.load(std::memory_order_acquire);
+            auto read = readPosition.load(std::memory_order_relaxed);
+
+            if( read == write )
+                return false;
+
+            // lapped: everything older than one capacity behind the writer is gone
+            if( write - read > (uint64_t)capacity )
+                read = write - (uint64_t)capacity;
+
+            const auto slot = size_t(read % (uint64_t)capacity);
+            const auto expected = 2 * read + 2;
+
+            if( sequences[slot].load(std::memory_order_acquire) == expected )
+            {
+                t = buffers[slot];
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if( sequences[slot].load(std::memory_order_relaxed) == expected )
+                {
+                    readPosition.store(read + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+
+            // overwritten while we looked; move on to the newer entries
+            readPosition.store(read + 1, std::memory_order_release);
+        }
+    }
+    
+    int getNumAvailableForReading() const
+    {
+        const auto available = writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_acquire);
+        return (int)juce::jmin(available, (uint64_t)capacity);
+    }
+
+    int getCapacity() const { return capacity; }
+
+    // the slots, their sequence numbers and whatever the entries own; message thread
+    size_t getHeapSizeInBytes() const
+    {
+        auto bytes = buffers.capacity() * sizeof(T) + size_t(capacity) * sizeof(std::atomic<uint64_t>);
+        for( const auto& buffer : buffers )
+            bytes += ::getHeapSizeInBytes(buffer);
+
+        return bytes;
+    }
+
+    // entries refused (DropNewest) or lost unread (OverwriteOldest) since prepare()
+    int getNumDropped() const { return numDropped.get(); }
+    int getNumOverwritten() const { return numOverwritten.get(); }
+private:
+    std::vector<T> buffers;
+    std::unique_ptr<std::atomic<uint64_t>[]> sequences;
+    int capacity = 0;
+    FifoOverflowPolicy policy = DropNewest;
+
+    std::atomic<uint64_t> writePosition { 0 }, readPosition { 0 };
+    juce::Atomic<int> numDropped { 0 }, numOverwritten { 0 };
+
+    void allocate(int newCapacity)
+    {
+        newCapacity = juce::jmax(1, newCapacity);
+
+        if( newCapacity != capacity )
+        {
+            buffers.resize((size_t)newCapacity);
+            buffers.shrink_to_fit();    // the default 30 slots, when a smaller capacity follows construction
+            sequences = std::make_unique<std::atomic<uint64_t>[]>((size_t)newCapacity);
+            capacity = newCapacity;
+        }
+
+        for( int i = 0; i < capacity; ++i )
+            sequences[(size_t)i].store(0);
+
+        writePosition.store(0);
+        readPosition.store(0);
+        numDropped.set(0);
+        numOverwritten.set(0);
+    }
+};
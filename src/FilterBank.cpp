@@ -0,0 +1,319 @@
+#include "FilterBank.h"
+#include "CycleCounter.h"
+#include "Instrumentation.h"
+
+template<typename SampleType>
+void FilterBank<SampleType>::prepare(int newNumChannels, int maximumBlockSize)
+{
+    numChannels = juce::jmax(1, newNumChannels);
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+    stateStride = padToCacheLine(numSections * numChannels);
+
+    const auto scratchSize = numChannels == 2 ? padToCacheLine(2 * maxBlockSize) : 0;
+    const auto numValues = size_t(NumCoefficientRows * rowStride + 2 * stateStride + scratchSize);
+    arenaSize = numValues * sizeof(SampleType);
+
+    // over-allocate by one cache line so the arena can start on a line boundary
+    storage.calloc(arenaSize + cacheLineSize);
+    auto address = reinterpret_cast<uintptr_t>(storage.get());
+    address = (address + cacheLineSize - 1) & ~uintptr_t(cacheLineSize - 1);
+
+    coefficientRows = reinterpret_cast<SampleType*>(address);
+    z1Row = coefficientRows + NumCoefficientRows * rowStride;
+    z2Row = z1Row + stateStride;
+    scratch = scratchSize > 0 ? z2Row + stateStride : nullptr;
+
+    // start out as a pass-through: b0 = 1, everything else 0
+    for( int c = 0; c < numLanes * numSections; ++c )
+        row(B0)[c] = SampleType(1);
+
+    enabledMask = 0;
+    updateActiveSections();
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::reset()
+{
+    if( ! isPrepared() )
+        return;
+
+    std::fill(z1Row, z1Row + 2 * stateStride, SampleType(0));
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::setSectionEnabled(int index, bool shouldBeEnabled)
+{
+    jassert(juce::isPositiveAndBelow(index, numSections));
+
+    if( shouldBeEnabled )
+        enabledMask |= (1u << index);
+    else
+        enabledMask &= ~(1u << index);
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::updateActiveSections()
+{
+    int count = 0;
+    for( int stage = 0; stage < NumStages; ++stage )
+    {
+        activeStageStarts[(size_t)stage] = count;
+
+        for( int s = stageBoundaries[stage]; s < stageBoundaries[stage + 1]; ++s )
+            if( isSectionEnabled(s) )
+                activeSections[(size_t)count++] = (uint8_t)s;
+    }
+
+    activeStageStarts[NumStages] = count;
+    activeListMask = enabledMask;
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block, StageCycles* stageCycles)
+{
+    jassert(isPrepared());
+
+    if( enabledMask == 0 )
+        return;
+
+    // setSectionEnabled() is called per section when a snapshot is adopted; rebuild once, here
+    if( activeListMask != enabledMask )
+        updateActiveSections();
+
+    if( numChannels == 2 && block.getNumChannels() >= 2 )
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+        auto remaining = (int)block.getNumSamples();
+
+        // hosts may send bigger blocks than promised; the scratch only holds maxBlockSize frames
+        while( remaining > 0 )
+        {
+            const auto n = juce::jmin(remaining, maxBlockSize);
+            processStereo(left, right, n, stageCycles);
+            left += n;
+            right += n;
+            remaining -= n;
+        }
+        return;
+    }
+
+    processChannels(block, stageCycles);
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processChannels(const juce::dsp::AudioBlock<SampleType>& block, StageCycles* stageCycles)
+{
+    SIMPLEEQ_ZONE_NAMED("FilterBank channels");
+
+    const auto channelsToProcess = juce::jmin((int)block.getNumChannels(), numChannels);
+    const auto numSamples = block.getNumSamples();
+
+    for( int ch = 0; ch < channelsToProcess; ++ch )
+    {
+        auto* samples = block.getChannelPointer((size_t)ch);
+
+        for( int stage = 0; stage < NumStages; ++stage )
+        {
+            const auto start = stageCycles != nullptr ? readCycleCounter() : 0;
+
+            for( int a = activeStageStarts[(size_t)stage]; a < activeStageStarts[size_t(stage + 1)]; ++a )
+                processChannelSection(activeSections[(size_t)a], ch, samples, numSamples);
+
+            if( stageCycles != nullptr )
+                (*stageCycles)[(size_t)stage] += readCycleCounter() - start;
+        }
+    }
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processChannelSection(int s, int ch, SampleType* samples, size_t numSamples)
+{
+    // mono takes the left lane; there is no layout with more than two channels
+    const auto c = numLanes * s + juce::jmin(ch, numLanes - 1);
+    const auto b0 = row(B0)[c], b1 = row(B1)[c], b2 = row(B2)[c];
+    const auto a1 = row(A1)[c], a2 = row(A2)[c];
+    auto& z1Ref = z1Row[s * numChannels + ch];
+    auto& z2Ref = z2Row[s * numChannels + ch];
+    auto z1 = z1Ref;
+    auto z2 = z2Ref;
+
+    // transposed direct form II, same recurrence as juce::dsp::IIR::Filter
+    for( size_t i = 0; i < numSamples; ++i )
+    {
+        const auto x = samples[i];
+        const auto y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        samples[i] = y;
+    }
+
+    JUCE_SNAP_TO_ZERO(z1);
+    JUCE_SNAP_TO_ZERO(z2);
+    z1Ref = z1;
+    z2Ref = z2;
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processStereo(SampleType* left, SampleType* right, int numSamples, StageCycles* stageCycles)
+{
+    if( midSide )
+    {
+        for( int i = 0; i < numSamples; ++i )
+        {
+            scratch[2 * i] = SampleType(0.5) * (left[i] + right[i]);
+            scratch[2 * i + 1] = SampleType(0.5) * (left[i] - right[i]);
+        }
+    }
+    else
+    {
+        for( int i = 0; i < numSamples; ++i )
+        {
+            scratch[2 * i] = left[i];
+            scratch[2 * i + 1] = right[i];
+        }
+    }
+
+    processStereoSections(scratch, numSamples, stageCycles);
+
+    if( midSide )
+    {
+        for( int i = 0; i < numSamples; ++i )
+        {
+            left[i] = scratch[2 * i] + scratch[2 * i + 1];
+            right[i] = scratch[2 * i] - scratch[2 * i + 1];
+        }
+    }
+    else
+    {
+        for( int i = 0; i < numSamples; ++i )
+        {
+            left[i] = scratch[2 * i];
+            right[i] = scratch[2 * i + 1];
+        }
+    }
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processStereoSections(SampleType* frames, int numSamples, StageCycles* stageCycles)
+{
+    for( int stage = 0; stage < NumStages; ++stage )
+    {
+        const auto start = stageCycles != nullptr ? readCycleCounter() : 0;
+
+        // a static zone per stage; a zone named at run time would allocate on every call
+        switch( stage )
+        {
+            case LowCutStage: { SIMPLEEQ_ZONE_NAMED("LowCut"); processStereoStage(stage, frames, numSamples); break; }
+            case PeakStage:   { SIMPLEEQ_ZONE_NAMED("Peak");   processStereoStage(stage, frames, numSamples); break; }
+            case BandsStage:  { SIMPLEEQ_ZONE_NAMED("Bands");  processStereoStage(stage, frames, numSamples); break; }
+            case HiCutStage:  { SIMPLEEQ_ZONE_NAMED("HiCut");  processStereoStage(stage, frames, numSamples); break; }
+            default:          jassertfalse; break;
+        }
+
+        if( stageCycles != nullptr )
+            (*stageCycles)[(size_t)stage] += readCycleCounter() - start;
+    }
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processStereoStage(int stage, SampleType* frames, int numSamples)
+{
+    for( int a = activeStageStarts[(size_t)stage]; a < activeStageStarts[size_t(stage + 1)]; ++a )
+        processStereoSection(activeSections[(size_t)a], frames, numSamples);
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processInterleaved(SampleType* frames, int numFrames)
+{
+    jassert(isPrepared());
+
+    if( enabledMask == 0 )
+        return;
+
+    if( activeListMask != enabledMask )
+        updateActiveSections();
+
+    if( numChannels == 1 )
+    {
+        const juce::dsp::AudioBlock<SampleType> block(&frames, 1, (size_t)numFrames);
+        processChannels(block, nullptr);
+        return;
+    }
+
+    // the kernel loads a frame as one StereoLanes value; for double that is a 16-byte aligned
+    // SIMD load, so a misaligned buffer goes through the scratch a block at a time instead
+    if( reinterpret_cast<uintptr_t>(frames) % alignof(StereoLanes<SampleType>) != 0 )
+    {
+        for( int done = 0; done < numFrames; )
+        {
+            const auto n = juce::jmin(numFrames - done, maxBlockSize);
+            std::copy(frames + 2 * done, frames + 2 * (done + n), scratch);
+            processInterleaved(scratch, n);
+            std::copy(scratch, scratch + 2 * n, frames + 2 * done);
+            done += n;
+        }
+        return;
+    }
+
+    if( midSide )
+    {
+        for( int i = 0; i < numFrames; ++i )
+        {
+            const auto l = frames[2 * i], r = frames[2 * i + 1];
+            frames[2 * i] = SampleType(0.5) * (l + r);
+            frames[2 * i + 1] = SampleType(0.5) * (l - r);
+        }
+    }
+
+    processStereoSections(frames, numFrames, nullptr);
+
+    if( midSide )
+    {
+        for( int i = 0; i < numFrames; ++i )
+        {
+            const auto m = frames[2 * i], s = frames[2 * i + 1];
+            frames[2 * i] = m + s;
+            frames[2 * i + 1] = m - s;
+        }
+    }
+}
+
+template<typename SampleType>
+void FilterBank<SampleType>::processStereoSection(int s, SampleType* frames, int numSamples)
+{
+    using Lanes = StereoLanes<SampleType>;
+
+    const auto c = numLanes * s;
+    const auto b0 = Lanes::load(row(B0) + c);
+    const auto b1 = Lanes::load(row(B1) + c);
+    const auto b2 = Lanes::load(row(B2) + c);
+    const auto a1 = Lanes::load(row(A1) + c);
+    const auto a2 = Lanes::load(row(A2) + c);
+
+    auto* z1Ptr = z1Row + 2 * s;
+    auto* z2Ptr = z2Row + 2 * s;
+    auto z1 = Lanes::load(z1Ptr);
+    auto z2 = Lanes::load(z2Ptr);
+
+    for( int i = 0; i < numSamples; ++i )
+    {
+        const auto x = Lanes::load(frames + 2 * i);
+        const auto y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        y.store(frames + 2 * i);
+    }
+
+    z1.store(z1Ptr);
+    z2.store(z2Ptr);
+
+    for( int ch = 0; ch < 2; ++ch )
+    {
+        JUCE_SNAP_TO_ZERO(z1Ptr[ch]);
+        JUCE_SNAP_TO_ZERO(z2Ptr[ch]);
+    }
+}
+
+template class FilterBank<float>;
+template class FilterBank<double>;
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChainSettings.h"
+
+#include <array>
+#include <cstdint>
+
+/*
+ Both channels of a stereo signal as the two lanes of one value, so a biquad recurrence can run on
+ left and right at once.  The generic version is two scalars the compiler can schedule side by side;
+ double uses a 2-lane SIMD register, which keeps the double path close to the cost of float.
+ */
+template<typename SampleType>
+struct StereoLanes
+{
+    SampleType l, r;
+
+    static StereoLanes load(const SampleType* p) { return { p[0], p[1] }; }
+    static StereoLanes expand(SampleType v) { return { v, v }; }
+    void store(SampleType* p) const { p[0] = l; p[1] = r; }
+
+    StereoLanes operator+(StereoLanes o) const { return { l + o.l, r + o.r }; }
+    StereoLanes operator-(StereoLanes o) const { return { l - o.l, r - o.r }; }
+    StereoLanes operator*(StereoLanes o) const { return { l * o.l, r * o.r }; }
+
+    static StereoLanes max(StereoLanes a, StereoLanes b) { return { juce::jmax(a.l, b.l), juce::jmax(a.r, b.r) }; }
+};
+
+#if JUCE_USE_SIMD
+template<>
+struct StereoLanes<double>
+{
+    using Register = juce::dsp::SIMDRegister<double>;
+    static_assert(Register::SIMDNumElements == 2, "the stereo double kernel expects 2-lane registers");
+
+    Register v;
+
+    // p must be 16-byte aligned
+    static StereoLanes load(const double* p) { return { Register::fromRawArray(p) }; }
+    static StereoLanes expand(double x) { return { Register::expand(x) }; }
+    void store(double* p) const { v.copyToRawArray(p); }
+
+    StereoLanes operator+(StereoLanes o) const { return { v + o.v }; }
+    StereoLanes operator-(StereoLanes o) const { return { v - o.v }; }
+    StereoLanes operator*(StereoLanes o) const { return { v * o.v }; }
+
+    static StereoLanes max(StereoLanes a, StereoLanes b) { return { Register::max(a.v, b.v) }; }
+};
+#endif
+
+/*
+ All of the biquads for one processor instance, laid out in a single cache-line aligned arena
+ that is allocated in prepare():
+
+    [ b0 | b1 | b2 | a1 | a2 ]      one row per coefficient, one pair of columns per section: the
+                                    left (or mid) lane's value, then the right (or side) lane's
+    [ z1 | z2 ]                     one row per state variable, section-major with the channels
+                                    interleaved, so a section's stereo state is one 2-lane load
+    [ scratch ]                     interleaved stereo block for the 2-lane kernel
+
+ Every row is padded to a whole number of cache lines, so a stereo block touches a handful of
+ cache lines instead of ~18 separately allocated filter objects.  Linked stereo writes the same
+ coefficients to both lanes; dual-mono and mid/side write each lane's own, and a section that only
+ one lane needs runs as a pass-through on the other.  The 2-lane kernel loads a section's pair of
+ coefficients the way it loads its pair of states, so both cost the same.  In mid/side the encode
+ and decode happen in the loops that interleave the block into the scratch and back.
+
+ process() walks a compacted list of the enabled sections, rebuilt only when the enabled set
+ changes, so the cost follows the number of bands in use rather than the maximum.
+ */
+template<typename SampleType>
+class FilterBank
+{
+public:
+    static constexpr int numLanes = 2;
+    static constexpr int numCutStages = 4;
+    static constexpr int lowCutStart = 0;
+    static constexpr int peakIndex = lowCutStart + numCutStages;
+    static constexpr int bandStart = peakIndex + 1;
+    static constexpr int numBands = BandTable::maxBands;
+    static constexpr int hiCutStart = bandStart + numBands;
+    static constexpr int numSections = hiCutStart + numCutStages;
+
+    static_assert(numSections <= 32, "the enabled mask is a uint32_t");
+
+    // groups of sections that are processed (and profiled) together
+    enum Stage { LowCutStage, PeakStage, BandsStage, HiCutStage, NumStages };
+    static constexpr int stageBoundaries[NumStages + 1] { lowCutStart, peakIndex, bandStart, hiCutStart, numSections };
+
+    // cycles spent in each stage, accumulated by process() when asked for
+    using StageCycles = std::array<uint64_t, NumStages>;
+
+    void prepare(int numChannels, int maximumBlockSize);
+    void reset();
+    bool isPrepared() const { return coefficientRows != nullptr; }
+
+    // coefficients are {b0, b1, b2, a1, a2}, already normalised by a0 (juce::dsp::IIR::Coefficients layout)
+    template<typename CoefficientType>
+    void setSection(int index, int lane, const CoefficientType* coefficients)
+    {
+        jassert(juce::isPositiveAndBelow(index, numSections));
+        jassert(juce::isPositiveAndBelow(lane, numLanes));
+        jassert(isPrepared());
+
+        for( int r = 0; r < NumCoefficientRows; ++r )
+            row(CoefficientRow(r))[numLanes * index + lane] = static_cast<SampleType>(coefficients[r]);
+    }
+
+    // both lanes, as in linked stereo
+    template<typename CoefficientType>
+    void setSection(int index, const CoefficientType* coefficients)
+    {
+        for( int lane = 0; lane < numLanes; ++lane )
+            setSection(index, lane, coefficients);
+    }
+
+    // mid/side: encode into the lanes before the first section and decode after the last; stereo only
+    void setMidSide(bool shouldUseMidSide) { midSide = shouldUseMidSide; }
+
+    void setSectionEnabled(int index, bool shouldBeEnabled);
+    bool isSectionEnabled(int index) const { return (enabledMask & (1u << index)) != 0; }
+
+    // processes every enabled section in place, adding each stage's cost to stageCycles if given
+    void process(const juce::dsp::AudioBlock<SampleType>& block, StageCycles* stageCycles = nullptr);
+
+    // the same on frames of getNumChannels() interleaved samples.  Stereo frames are already the
+    // layout the 2-lane kernel runs on, so it filters the caller's buffer directly, with no
+    // interleaving into the scratch and back; mid/side is encoded and decoded in place.
+    void processInterleaved(SampleType* frames, int numFrames);
+
+    int getNumChannels() const { return numChannels; }
+    size_t getArenaSizeInBytes() const { return arenaSize; }
+
+private:
+    static constexpr size_t cacheLineSize = 64;
+    static constexpr int valuesPerCacheLine = int(cacheLineSize / sizeof(SampleType));
+
+    static constexpr int padToCacheLine(int n)
+    {
+        return ((n + valuesPerCacheLine - 1) / valuesPerCacheLine) * valuesPerCacheLine;
+    }
+
+    static constexpr int rowStride = padToCacheLine(numLanes * numSections);
+
+    enum CoefficientRow { B0, B1, B2, A1, A2, NumCoefficientRows };
+
+    juce::HeapBlock<char> storage;
+    size_t arenaSize = 0;
+
+    SampleType* coefficientRows = nullptr;  // NumCoefficientRows * rowStride
+    SampleType* z1Row = nullptr;            // stateStride, index [section * numChannels + channel]
+    SampleType* z2Row = nullptr;            // stateStride
+    SampleType* scratch = nullptr;          // 2 * maxBlockSize, interleaved stereo
+
+    uint32_t enabledMask = 0;
+    bool midSide = false;
+
+    // the enabled sections in order, and where each stage's run of them starts
+    std::array<uint8_t, numSections> activeSections {};
+    std::array<int, NumStages + 1> activeStageStarts {};
+    uint32_t activeListMask = 0;
+
+    int numChannels = 0;
+    int stateStride = 0;
+    int maxBlockSize = 0;
+
+    SampleType* row(CoefficientRow r) const { return coefficientRows + r * rowStride; }
+
+    void updateActiveSections();
+
+    void processChannels(const juce::dsp::AudioBlock<SampleType>& block, StageCycles* stageCycles);
+    void processChannelSection(int index, int channel, SampleType* samples, size_t numSamples);
+    void processStereo(SampleType* left, SampleType* right, int numSamples, StageCycles* stageCycles);
+    void processStereoSections(SampleType* frames, int numSamples, StageCycles* stageCycles);
+    void processStereoStage(int stage, SampleType* frames, int numSamples);
+    void processStereoSection(int index, SampleType* frames, int numSamples);
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ChainSnapshot.h"
+#include "DynamicPeak.h"
+#include "FilterBank.h"
+#include "SvfBank.h"
+
+// the two interchangeable filter engines for one processing precision, plus the dynamic peak,
+// which runs after whichever engine is active and takes over the peak band from it
+template<typename SampleType>
+struct FilterEngines
+{
+    FilterBank<SampleType> biquads;
+    SvfBank<SampleType> svfs;
+    DynamicPeak<SampleType> dynamicPeak;
+    FilterEngine active { FilterEngine::BiquadEngine };
+    ChannelMode mode { LinkedStereo };
+
+    bool isPrepared() const { return biquads.isPrepared() && svfs.isPrepared() && dynamicPeak.isPrepared(); }
+
+    size_t getHeapSizeInBytes() const
+    {
+        return biquads.getArenaSizeInBytes() + svfs.getHeapSizeInBytes() + dynamicPeak.getHeapSizeInBytes();
+    }
+
+    // Audio thread.  Takes over a newly published snapshot.  Returns true when the engine or the
+    // channel mode changed, in which case every engine here starts from clean state and the caller
+    // should reset whatever else it runs (the linear-phase FIR).
+    bool adopt(const StereoChainSnapshot& snapshot)
+    {
+        const auto& settings = snapshot.channels[0].settings;
+
+        // whichever engine takes over starts from clean state, as does one whose state is in the other domain
+        const auto restart = settings.engine != active || snapshot.mode != mode;
+        if( restart )
+        {
+            biquads.reset();
+            dynamicPeak.reset();
+            active = settings.engine;
+            mode = snapshot.mode;
+        }
+
+        snapshot.applyTo(biquads);
+
+        svfs.setChannelMode(snapshot.mode);
+        svfs.setTargets(settings, 0);
+        if( ! snapshot.isLinked() )
+            svfs.setTargets(snapshot.channels[1].settings, 1);
+
+        if( restart )
+            svfs.reset();
+
+        dynamicPeak.setSettings(settings);
+        return restart;
+    }
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+ Thin wrapper around the Tracy profiler.  Configure with -DSIMPLEEQ_ENABLE_TRACY=ON to turn these
+ into Tracy zones, plots and frame marks; otherwise they compile to nothing.
+ Zone and plot names must be string literals (or otherwise outlive the program).
+ */
+#ifndef SIMPLEEQ_ENABLE_TRACY
+ #define SIMPLEEQ_ENABLE_TRACY 0
+#endif
+
+#if SIMPLEEQ_ENABLE_TRACY
+ #include <tracy/Tracy.hpp>
+
+ #define SIMPLEEQ_ZONE                      ZoneScoped
+ #define SIMPLEEQ_ZONE_NAMED(name)          ZoneScopedN(name)
+ #define SIMPLEEQ_PLOT(name, value)         TracyPlot(name, value)
+ #define SIMPLEEQ_FRAME_MARK_NAMED(name)    FrameMarkNamed(name)
+#else
+ #define SIMPLEEQ_ZONE
+ #define SIMPLEEQ_ZONE_NAMED(name)
+ #define SIMPLEEQ_PLOT(name, value)
+ #define SIMPLEEQ_FRAME_MARK_NAMED(name)
+#endif
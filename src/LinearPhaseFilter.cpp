@@ -0,0 +1,403 @@
+#include "LinearPhaseFilter.h"
+#include "Instrumentation.h"
+#include "MemoryFootprint.h"
+
+#include <cmath>
+
+int LinearPhaseFilter::getFirOrderForSampleRate(double sampleRate)
+{
+    const auto octavesAbove48k = std::ceil(std::log2(juce::jmax(1.0, sampleRate / 48000.0)));
+    return juce::jlimit(12, 16, 14 + (int)octavesAbove48k);
+}
+
+size_t LinearPhaseFilter::getHeapSizeInBytes() const
+{
+    size_t bytes = evaluator.getHeapSizeInBytes() + ::getHeapSizeInBytes(gains);
+
+    for( const auto* transform : { designFFT.get(), partitionDesignFFT.get(), fft.get() } )
+        if( transform != nullptr )
+            bytes += transform->getHeapSizeInBytes();
+
+    for( const auto* v : { &designReal, &designImag, &impulse, &blackman, &padded,
+                           &accumulatorReal, &accumulatorImag, &convolved, &fadingIn } )
+        bytes += ::getHeapSizeInBytes(*v);
+
+    for( const auto& kernel : kernels )
+        for( const auto& spectra : kernel.spectra )
+            bytes += ::getHeapSizeInBytes(spectra);
+
+    bytes += ::getHeapSizeInBytes(channels);
+    for( const auto& state : channels )
+        bytes += ::getHeapSizeInBytes(state.window) + ::getHeapSizeInBytes(state.spectra) + ::getHeapSizeInBytes(state.output);
+
+    return bytes;
+}
+
+void LinearPhaseFilter::prepare(double sampleRate, int numChannels, int firOrder)
+{
+    firLength = 1 << firOrder;
+    numPartitions = juce::jmax(1, firLength / partitionSize);
+    crossfadeLength = juce::jmax(partitionSize, (int)std::ceil(crossfadeSeconds * sampleRate));
+
+    const auto spectraSize = size_t(numPartitions * 2 * numBins);
+
+    designFFT = std::make_unique<RealFFT>(firOrder);
+    partitionDesignFFT = std::make_unique<RealFFT>((int)std::log2(2 * partitionSize));
+    fft = std::make_unique<RealFFT>((int)std::log2(2 * partitionSize));
+
+    const auto numDesignBins = (size_t)designFFT->getNumBins();
+    std::vector<double> frequencies(numDesignBins);
+    for( size_t k = 0; k < numDesignBins; ++k )
+        frequencies[k] = double(k) * sampleRate / firLength;
+
+    evaluator.prepare(frequencies, sampleRate);
+    gains.assign(numDesignBins, 0.0);
+    designReal.assign(numDesignBins, 0.f);
+    designImag.assign(numDesignBins, 0.f);
+    impulse.assign((size_t)firLength, 0.f);
+    padded.assign(size_t(2 * partitionSize), 0.f);
+
+    // periodic, so it is symmetric about firLength / 2 where the FIR is centred
+    blackman.resize((size_t)firLength);
+    for( int n = 0; n < firLength; ++n )
+    {
+        const auto phase = juce::MathConstants<double>::twoPi * n / firLength;
+        blackman[(size_t)n] = float(0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+    }
+
+    numLanes = juce::jmin(juce::jmax(1, numChannels), maxLanes);
+
+    for( auto& kernel : kernels )
+    {
+        for( int lane = 0; lane < maxLanes; ++lane )
+            kernel.spectra[(size_t)lane].assign(lane < numLanes ? spectraSize : 0, 0.f);
+
+        kernel.mode = LinkedStereo;
+        kernel.busy.store(false);
+    }
+    pendingKernel.store(-1);
+    lastDesignedSlot = -1;
+    lastDesignedLane = {};
+
+    channels.resize((size_t)juce::jmax(1, numChannels));
+    for( auto& state : channels )
+    {
+        state.window.assign(size_t(2 * partitionSize), 0.f);
+        state.spectra.assign(spectraSize, 0.f);
+        state.output.assign((size_t)partitionSize, 0.f);
+    }
+
+    accumulatorReal.assign((size_t)numBins, 0.f);
+    accumulatorImag.assign((size_t)numBins, 0.f);
+    convolved.assign(size_t(2 * partitionSize), 0.f);
+    fadingIn.assign(size_t(2 * partitionSize), 0.f);
+
+    currentKernel = incomingKernel = -1;
+    fifoPosition = 0;
+    newestSpectrum = 0;
+    fadePosition = 0;
+}
+
+void LinearPhaseFilter::reset()
+{
+    for( auto& state : channels )
+    {
+        std::fill(state.window.begin(), state.window.end(), 0.f);
+        std::fill(state.spectra.begin(), state.spectra.end(), 0.f);
+        std::fill(state.output.begin(), state.output.end(), 0.f);
+    }
+
+    fifoPosition = 0;
+
+    // with nothing to fade from, switch straight to the newest kernel
+    if( incomingKernel >= 0 )
+    {
+        kernels[(size_t)currentKernel].busy.store(false, std::memory_order_release);
+        currentKernel = incomingKernel;
+        incomingKernel = -1;
+    }
+
+    const auto next = pendingKernel.exchange(-1, std::memory_order_acq_rel);
+    if( next >= 0 )
+    {
+        if( currentKernel >= 0 )
+            kernels[(size_t)currentKernel].busy.store(false, std::memory_order_release);
+
+        currentKernel = next;
+    }
+}
+
+void LinearPhaseFilter::designKernel(const ChainSnapshot& snapshot)
+{
+    StereoChainSnapshot linked;
+    linked.channels[0] = snapshot;
+    designKernel(linked);
+}
+
+void LinearPhaseFilter::designKernel(const StereoChainSnapshot& snapshot)
+{
+    SIMPLEEQ_ZONE;
+
+    jassert(isPrepared());
+
+    const auto numLanesToDesign = snapshot.isLinked() ? 1 : numLanes;
+
+    // the kernel last queued already is this one, and fading into a copy of it would only double the convolution
+    if( lastDesignedSlot >= 0 && kernels[(size_t)lastDesignedSlot].mode == snapshot.mode )
+    {
+        bool unchanged = true;
+        for( size_t l = 0; l < (size_t)numLanesToDesign && unchanged; ++l )
+            unchanged = lastDesignedLane[l] && lastDesignedSettings[l] == snapshot.channels[l].settings;
+
+        if( unchanged )
+            return;
+    }
+
+    // the audio thread holds at most two slots and one more can be pending, so one is always free
+    int slot = -1;
+    for( int i = 0; i < numKernelSlots && slot < 0; ++i )
+        if( ! kernels[(size_t)i].busy.load(std::memory_order_acquire) )
+            slot = i;
+
+    if( slot < 0 )
+    {
+        jassertfalse;
+        return;
+    }
+
+    auto& kernel = kernels[(size_t)slot];
+    kernel.mode = snapshot.mode;
+
+    for( int lane = 0; lane < maxLanes; ++lane )
+    {
+        const auto l = (size_t)lane;
+
+        if( lane >= numLanesToDesign )
+        {
+            // whatever is left in this slot's lane isn't what lastDesignedSettings describes
+            lastDesignedLane[l] = false;
+            continue;
+        }
+
+        const auto& settings = snapshot.channels[l].settings;
+        if( lastDesignedSlot >= 0 && lastDesignedLane[l] && lastDesignedSettings[l] == settings )
+        {
+            const auto& source = kernels[(size_t)lastDesignedSlot].spectra[l];
+            std::copy(source.begin(), source.end(), kernel.spectra[l].begin());
+            continue;
+        }
+
+        designLane(snapshot.channels[l], kernel.spectra[l].data());
+        lastDesignedSettings[l] = settings;
+        lastDesignedLane[l] = true;
+    }
+
+    lastDesignedSlot = slot;
+
+    // hand it over, taking back a design the audio thread never got round to
+    kernel.busy.store(true, std::memory_order_relaxed);
+    const auto unclaimed = pendingKernel.exchange(slot, std::memory_order_acq_rel);
+    if( unclaimed >= 0 )
+        kernels[(size_t)unclaimed].busy.store(false, std::memory_order_release);
+}
+
+void LinearPhaseFilter::designLane(const ChainSnapshot& snapshot, float* spectra)
+{
+    // zero-phase magnitude, so the impulse response is real, even, and centred on sample 0
+    evaluator.evaluateGains(snapshot, gains.data());
+    for( size_t k = 0; k < gains.size(); ++k )
+        designReal[k] = float(gains[k]);
+    std::fill(designImag.begin(), designImag.end(), 0.f);
+
+    designFFT->performInverse(designReal.data(), designImag.data(), impulse.data());
+
+    // rotate the centre to firLength / 2 and window, one partition at a time
+    const auto half = firLength / 2;
+
+    for( int p = 0; p < numPartitions; ++p )
+    {
+        for( int i = 0; i < partitionSize; ++i )
+        {
+            const auto n = p * partitionSize + i;
+            padded[(size_t)i] = impulse[size_t((n + half) % firLength)] * blackman[(size_t)n];
+        }
+
+        auto* real = spectra + p * 2 * numBins;
+        partitionDesignFFT->performForward(padded.data(), real, real + numBins);
+    }
+}
+
+void LinearPhaseFilter::takePendingKernel()
+{
+    // finish the fade in progress first; the newest design stays pending until then
+    if( incomingKernel >= 0 )
+        return;
+
+    const auto next = pendingKernel.exchange(-1, std::memory_order_acq_rel);
+    if( next < 0 )
+        return;
+
+    if( currentKernel < 0 )
+    {
+        currentKernel = next;
+        return;
+    }
+
+    // left/right and mid/side outputs can't be crossfaded sample for sample
+    if( kernels[(size_t)next].mode != kernels[(size_t)currentKernel].mode )
+    {
+        kernels[(size_t)currentKernel].busy.store(false, std::memory_order_release);
+        currentKernel = next;
+        return;
+    }
+
+    incomingKernel = next;
+    fadePosition = 0;
+}
+
+template<typename SampleType>
+void LinearPhaseFilter::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    SIMPLEEQ_ZONE_NAMED("LinearPhaseFilter::process");
+
+    jassert(isPrepared());
+
+    takePendingKernel();
+
+    const auto numChannelsToProcess = juce::jmin((int)block.getNumChannels(), (int)channels.size());
+    const auto numSamples = (int)block.getNumSamples();
+
+    // kernels only change mode between blocks, in takePendingKernel()
+    const auto midSide = currentKernel >= 0 && kernels[(size_t)currentKernel].mode == MidSide && numChannelsToProcess >= 2;
+
+    for( int start = 0; start < numSamples; )
+    {
+        const auto run = juce::jmin(numSamples - start, partitionSize - fifoPosition);
+
+        if( midSide )
+        {
+            // encode on the way into the windows, decode on the way out of the outputs
+            auto* left = block.getChannelPointer(0) + start;
+            auto* right = block.getChannelPointer(1) + start;
+            auto* mid = channels[0].window.data() + partitionSize + fifoPosition;
+            auto* side = channels[1].window.data() + partitionSize + fifoPosition;
+            const auto* midOut = channels[0].output.data() + fifoPosition;
+            const auto* sideOut = channels[1].output.data() + fifoPosition;
+
+            for( int i = 0; i < run; ++i )
+            {
+                const auto l = static_cast<float>(left[i]);
+                const auto r = static_cast<float>(right[i]);
+                mid[i] = 0.5f * (l + r);
+                side[i] = 0.5f * (l - r);
+                left[i] = static_cast<SampleType>(midOut[i] + sideOut[i]);
+                right[i] = static_cast<SampleType>(midOut[i] - sideOut[i]);
+            }
+        }
+
+        for( int ch = midSide ? 2 : 0; ch < numChannelsToProcess; ++ch )
+        {
+            auto& state = channels[(size_t)ch];
+            auto* samples = block.getChannelPointer((size_t)ch) + start;
+            auto* input = state.window.data() + partitionSize + fifoPosition;
+            const auto* output = state.output.data() + fifoPosition;
+
+            for( int i = 0; i < run; ++i )
+            {
+                input[i] = static_cast<float>(samples[i]);
+                samples[i] = static_cast<SampleType>(output[i]);
+            }
+        }
+
+        start += run;
+        fifoPosition += run;
+
+        if( fifoPosition == partitionSize )
+        {
+            processPartition(numChannelsToProcess);
+            fifoPosition = 0;
+        }
+    }
+}
+
+void LinearPhaseFilter::processPartition(int numChannelsToProcess)
+{
+    newestSpectrum = (newestSpectrum + 1) % numPartitions;
+
+    for( int ch = 0; ch < numChannelsToProcess; ++ch )
+    {
+        auto& state = channels[(size_t)ch];
+
+        auto* real = state.spectra.data() + newestSpectrum * 2 * numBins;
+        fft->performForward(state.window.data(), real, real + numBins);
+
+        // this partition's input becomes the next one's history
+        std::copy(state.window.begin() + partitionSize, state.window.end(), state.window.begin());
+
+        if( currentKernel < 0 )
+        {
+            std::fill(state.output.begin(), state.output.end(), 0.f);
+            continue;
+        }
+
+        // overlap-save: only the second half of the circular convolution is valid
+        convolve(state, kernels[(size_t)currentKernel].getSpectraForChannel(ch), convolved.data());
+        const auto* valid = convolved.data() + partitionSize;
+
+        if( incomingKernel < 0 )
+        {
+            std::copy(valid, valid + partitionSize, state.output.begin());
+            continue;
+        }
+
+        convolve(state, kernels[(size_t)incomingKernel].getSpectraForChannel(ch), fadingIn.data());
+        const auto* validIncoming = fadingIn.data() + partitionSize;
+
+        for( int i = 0; i < partitionSize; ++i )
+        {
+            const auto g = juce::jmin(1.f, float(fadePosition + i) / float(crossfadeLength));
+            state.output[(size_t)i] = valid[i] + g * (validIncoming[i] - valid[i]);
+        }
+    }
+
+    if( incomingKernel >= 0 )
+    {
+        fadePosition += partitionSize;
+
+        if( fadePosition >= crossfadeLength )
+        {
+            kernels[(size_t)currentKernel].busy.store(false, std::memory_order_release);
+            currentKernel = incomingKernel;
+            incomingKernel = -1;
+        }
+    }
+}
+
+void LinearPhaseFilter::convolve(const ChannelState& state, const float* kernelSpectra, float* timeDomain)
+{
+    float* __restrict accReal = accumulatorReal.data();
+    float* __restrict accImag = accumulatorImag.data();
+    std::fill(accReal, accReal + numBins, 0.f);
+    std::fill(accImag, accImag + numBins, 0.f);
+
+    // input spectrum p partitions old times kernel partition p
+    for( int p = 0; p < numPartitions; ++p )
+    {
+        const auto slot = (newestSpectrum - p + numPartitions) % numPartitions;
+        const float* __restrict xr = state.spectra.data() + slot * 2 * numBins;
+        const float* __restrict xi = xr + numBins;
+        const float* __restrict hr = kernelSpectra + p * 2 * numBins;
+        const float* __restrict hi = hr + numBins;
+
+        for( int k = 0; k < numBins; ++k )
+        {
+            accReal[k] += xr[k] * hr[k] - xi[k] * hi[k];
+            accImag[k] += xr[k] * hi[k] + xi[k] * hr[k];
+        }
+    }
+
+    fft->performInverse(accReal, accImag, timeDomain);
+}
+
+template void LinearPhaseFilter::process<float>(const juce::dsp::AudioBlock<float>&);
+template void LinearPhaseFilter::process<double>(const juce::dsp::AudioBlock<double>&);
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChainSnapshot.h"
+#include "RealFFT.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ The chain as a linear-phase FIR: the magnitude of a snapshot, sampled on the FIR's own frequency
+ grid with zero phase, inverse transformed, centred and Blackman windowed.  The FIR is convolved
+ with a uniformly partitioned overlap-save engine.
+
+    - the FIR is cut into partitionSize-sample pieces, each zero padded and transformed once,
+      when the kernel is designed
+    - every partitionSize input samples, the newest 2 * partitionSize window is transformed into a
+      ring of input spectra, and the output is the sum over partitions of input spectrum times
+      kernel spectrum, inverse transformed once
+
+ The partition size is fixed, whatever block size the host uses: input and output go through a
+ one-partition FIFO, which is where partitionSize of the latency comes from.  The rest is the
+ FIR's centre, firLength / 2.
+
+ Kernels are designed on the writer's side (the message thread, or the audio thread during
+ offline renders) into preallocated slots and handed over lock-free.  The audio thread
+ crossfades from the old kernel to the new one over crossfadeSeconds by running both for that
+ long; a kernel that arrives mid-fade waits for the fade to finish.  Convolution runs in float
+ whatever the host's precision.
+
+ A kernel holds one FIR per lane: linked stereo convolves both channels with lane 0, dual-mono
+ and mid/side give the second channel lane 1.  In mid/side the encode and decode happen in the
+ FIFO loop that already copies every sample in and out.  A lane whose settings haven't changed
+ since the last design is copied rather than redesigned, and a kernel in another channel mode is
+ switched to without a crossfade, since the two can't be mixed sample for sample.  A snapshot
+ that changes no lane and keeps the mode isn't queued at all.
+ */
+class LinearPhaseFilter
+{
+public:
+    static constexpr int partitionSize = 512;
+    static constexpr double crossfadeSeconds = 0.05;
+
+    // 16384 taps up to 48 kHz, so the resolution at the low end stays the same at higher rates
+    static int getFirOrderForSampleRate(double sampleRate);
+
+    void prepare(double sampleRate, int numChannels, int firOrder);
+    bool isPrepared() const { return fft != nullptr; }
+
+    // audio thread: clears the convolution state and switches to the newest kernel without a crossfade
+    void reset();
+
+    int getFirLength() const { return firLength; }
+    int getLatencySamples() const { return firLength / 2 + partitionSize; }
+
+    // message thread; the kernel slots are most of it
+    size_t getHeapSizeInBytes() const;
+
+    // writer side; allocation free once prepared, but costs a few FFTs of the FIR's length per lane designed
+    void designKernel(const StereoChainSnapshot& snapshot);
+    void designKernel(const ChainSnapshot& snapshot);       // linked stereo
+
+    // in place; silent until the first kernel has been designed
+    template<typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+    bool isCrossfading() const { return incomingKernel >= 0; }
+
+private:
+    static constexpr int numKernelSlots = 4;        // current, incoming, pending and one to design into
+    static constexpr int numBins = partitionSize + 1;
+    static constexpr int maxLanes = 2;
+
+    struct Kernel
+    {
+        std::array<std::vector<float>, maxLanes> spectra;   // per lane and partition: numBins real parts, then numBins imaginary parts
+        ChannelMode mode = LinkedStereo;
+        std::atomic<bool> busy { false };
+
+        const float* getSpectraForChannel(int channel) const
+        {
+            return spectra[mode == LinkedStereo ? 0 : (size_t)juce::jmin(channel, maxLanes - 1)].data();
+        }
+    };
+
+    struct ChannelState
+    {
+        std::vector<float> window;      // 2 * partitionSize: the previous partition's input, then this one's
+        std::vector<float> spectra;     // ring of input spectra, laid out like Kernel::spectra
+        std::vector<float> output;      // partitionSize, being played out while the next partition fills
+    };
+
+    int firLength = 0;
+    int numPartitions = 0;
+    int numLanes = 0;                   // 1 for a mono bus, where there is nothing to split
+    int crossfadeLength = 0;
+
+    //==============================================================================
+    // writer side
+    std::unique_ptr<RealFFT> designFFT, partitionDesignFFT;
+    ChainMagnitudeEvaluator evaluator;
+    std::vector<double> gains;
+    std::vector<float> designReal, designImag, impulse, blackman, padded;
+    int lastDesignedSlot = -1;          // never released by the audio thread until a newer design replaces it
+    std::array<ChainSettings, maxLanes> lastDesignedSettings;
+    std::array<bool, maxLanes> lastDesignedLane {};
+
+    void designLane(const ChainSnapshot& snapshot, float* spectra);
+
+    //==============================================================================
+    // shared
+    std::array<Kernel, numKernelSlots> kernels;
+    std::atomic<int> pendingKernel { -1 };
+
+    //==============================================================================
+    // audio thread
+    std::unique_ptr<RealFFT> fft;
+    std::vector<ChannelState> channels;
+    std::vector<float> accumulatorReal, accumulatorImag, convolved, fadingIn;
+    int currentKernel = -1, incomingKernel = -1;
+    int fifoPosition = 0;
+    int newestSpectrum = 0;
+    int fadePosition = 0;
+
+    void takePendingKernel();
+    void processPartition(int numChannelsToProcess);
+    void convolve(const ChannelState& state, const float* kernelSpectra, float* timeDomain);
+};
@@ -0,0 +1,171 @@
+#include "LongTermSpectrum.h"
+
+#include "RealFFT.h"
+
+#include <memory>
+#include <thread>
+
+namespace
+{
+// one worker's view of the signal, already mixed to mono
+struct SampleSource
+{
+    virtual ~SampleSource() = default;
+    virtual void read(juce::int64 start, int numSamples, float* mono) = 0;
+};
+
+struct BufferSource final : SampleSource
+{
+    explicit BufferSource(const juce::AudioBuffer<float>& source) : audio(source) {}
+
+    void read(juce::int64 start, int numSamples, float* mono) override
+    {
+        const auto gain = 1.f / (float)audio.getNumChannels();
+        juce::FloatVectorOperations::copyWithMultiply(mono, audio.getReadPointer(0, (int)start), gain, numSamples);
+
+        for( int ch = 1; ch < audio.getNumChannels(); ++ch )
+            juce::FloatVectorOperations::addWithMultiply(mono, audio.getReadPointer(ch, (int)start), gain, numSamples);
+    }
+
+    const juce::AudioBuffer<float>& audio;
+};
+
+struct ReaderSource final : SampleSource
+{
+    explicit ReaderSource(std::unique_ptr<juce::AudioFormatReader> r) : reader(std::move(r)) {}
+
+    void read(juce::int64 start, int numSamples, float* mono) override
+    {
+        const auto numChannels = (int)reader->numChannels;
+        scratch.setSize(numChannels, numSamples, false, false, true);
+        reader->read(&scratch, 0, numSamples, start, true, true);
+
+        const auto gain = 1.f / (float)numChannels;
+        juce::FloatVectorOperations::copyWithMultiply(mono, scratch.getReadPointer(0), gain, numSamples);
+
+        for( int ch = 1; ch < numChannels; ++ch )
+            juce::FloatVectorOperations::addWithMultiply(mono, scratch.getReadPointer(ch), gain, numSamples);
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::AudioBuffer<float> scratch;
+};
+
+// adds |X[k]|^2 of frames [firstFrame, firstFrame + numFrames) to powerSum
+void accumulateFrames(SampleSource& source, int order, juce::int64 firstFrame, juce::int64 numFrames,
+                      std::vector<double>& powerSum)
+{
+    RealFFT fft(order);
+    const auto size = fft.getSize();
+    const auto hop = size / 2;
+
+    std::vector<float> window((size_t)size), frame((size_t)size), windowed((size_t)size);
+    std::vector<float> real((size_t)fft.getNumBins()), imag((size_t)fft.getNumBins());
+
+    for( int n = 0; n < size; ++n )
+        window[(size_t)n] = 0.5f - 0.5f * (float)std::cos(juce::MathConstants<double>::twoPi * n / size);
+
+    // every frame after the first shares its first half with the previous one, so read a hop at a time
+    source.read(firstFrame * hop, size, frame.data());
+
+    for( juce::int64 f = 0; f < numFrames; ++f )
+    {
+        if( f > 0 )
+        {
+            std::copy(frame.begin() + hop, frame.end(), frame.begin());
+            source.read((firstFrame + f) * hop + hop, hop, frame.data() + hop);
+        }
+
+        juce::FloatVectorOperations::multiply(windowed.data(), frame.data(), window.data(), size);
+        fft.performForward(windowed.data(), real.data(), imag.data());
+
+        for( size_t k = 0; k < powerSum.size(); ++k )
+            powerSum[k] += (double)real[k] * real[k] + (double)imag[k] * imag[k];
+    }
+}
+
+LongTermSpectrum analyseSources(std::vector<std::unique_ptr<SampleSource>>& sources, juce::int64 length,
+                                double sampleRate, int order)
+{
+    LongTermSpectrum result;
+    result.sampleRate = sampleRate;
+    result.fftSize = 1 << order;
+
+    const auto hop = result.fftSize / 2;
+    const auto numBins = (size_t)result.fftSize / 2 + 1;
+    result.power.assign(numBins, 0.0);
+
+    if( length < result.fftSize || sources.empty() )
+        return result;
+
+    result.numFrames = (length - result.fftSize) / hop + 1;
+
+    // contiguous runs of frames, as even as possible
+    const auto numWorkers = (juce::int64)sources.size();
+    std::vector<std::vector<double>> partialSums(sources.size(), std::vector<double>(numBins, 0.0));
+    std::vector<std::thread> workers;
+
+    for( juce::int64 w = 0; w < numWorkers; ++w )
+    {
+        const auto first = result.numFrames * w / numWorkers;
+        const auto last = result.numFrames * (w + 1) / numWorkers;
+
+        if( last > first )
+            workers.emplace_back([&, w, first, last]
+            {
+                accumulateFrames(*sources[(size_t)w], order, first, last - first, partialSums[(size_t)w]);
+            });
+    }
+
+    for( auto& worker : workers )
+        worker.join();
+
+    for( auto& partial : partialSums )
+        for( size_t k = 0; k < numBins; ++k )
+            result.power[k] += partial[k];
+
+    for( auto& p : result.power )
+        p /= (double)result.numFrames;
+
+    return result;
+}
+
+int getNumWorkers(int numThreads)
+{
+    return numThreads > 0 ? numThreads : juce::jmax(1, juce::SystemStats::getNumCpus());
+}
+}
+
+LongTermSpectrum LongTermSpectrum::analyse(const juce::AudioBuffer<float>& audio, double sampleRate, int order, int numThreads)
+{
+    std::vector<std::unique_ptr<SampleSource>> sources;
+    if( audio.getNumChannels() > 0 )
+        for( int w = 0; w < getNumWorkers(numThreads); ++w )
+            sources.push_back(std::make_unique<BufferSource>(audio));
+
+    return analyseSources(sources, audio.getNumSamples(), sampleRate, order);
+}
+
+LongTermSpectrum LongTermSpectrum::analyse(const juce::File& file, int order, int numThreads)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // a reader per worker, so none of them share stream state
+    std::vector<std::unique_ptr<SampleSource>> sources;
+    juce::int64 length = 0;
+    double sampleRate = 0.0;
+
+    for( int w = 0; w < getNumWorkers(numThreads); ++w )
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if( reader == nullptr || reader->numChannels == 0 )
+            return {};
+
+        length = reader->lengthInSamples;
+        sampleRate = reader->sampleRate;
+        sources.push_back(std::make_unique<ReaderSource>(std::move(reader)));
+    }
+
+    return analyseSources(sources, length, sampleRate, order);
+}
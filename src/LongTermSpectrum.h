@@ -0,0 +1,29 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <vector>
+
+/*
+ Long-term average power spectrum of a whole signal, mixed to mono: |X[k]|^2 averaged over every
+ Hann-windowed, half-overlapping frame.
+
+ Multi-minute files are the common case, so the frames are split into one contiguous run per
+ worker thread.  Each worker reads and transforms only its own part of the file, through its own
+ reader, and the partial sums are added up at the end.
+ */
+struct LongTermSpectrum
+{
+    double sampleRate = 0.0;
+    int fftSize = 0;
+    juce::int64 numFrames = 0;
+    std::vector<double> power;  // fftSize/2 + 1 bins
+
+    bool isValid() const { return numFrames > 0; }
+
+    // numThreads <= 0 uses one per CPU
+    static LongTermSpectrum analyse(const juce::AudioBuffer<float>& audio, double sampleRate, int order, int numThreads = 0);
+
+    // an invalid result if the file can't be read or is shorter than one frame
+    static LongTermSpectrum analyse(const juce::File& file, int order, int numThreads = 0);
+};
@@ -0,0 +1,257 @@
+#include "MatchEQ.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+//==============================================================================
+namespace
+{
+constexpr int numDimensions = 5;
+using Point = std::array<double, numDimensions>;
+
+// the search runs in [0, 1] per dimension; cut ranges are narrower than the parameters' so that
+// the cuts stay cuts rather than standing in for a tilt
+struct SearchSpace
+{
+    static ChainSettings toSettings(const Point& x, Slope lowCutSlope, Slope highCutSlope)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = (float)juce::mapToLog10(x[0], 20.0, 1000.0);
+        settings.highCutFreq = (float)juce::mapToLog10(x[1], 1000.0, 20000.0);
+        settings.peakFreq = (float)juce::mapToLog10(x[2], 20.0, 20000.0);
+        settings.peakGainInDecibels = (float)juce::jmap(x[3], -24.0, 24.0);
+        settings.peakQuality = (float)juce::mapToLog10(x[4], 0.1, 10.0);
+        settings.lowCutSlope = lowCutSlope;
+        settings.highCutSlope = highCutSlope;
+        return settings;
+    }
+
+    static Point clamp(Point x)
+    {
+        for( auto& v : x )
+            v = juce::jlimit(0.0, 1.0, v);
+        return x;
+    }
+};
+
+// the parameters' own step sizes, so the result can be set exactly
+ChainSettings snapToParameterSteps(ChainSettings settings)
+{
+    auto snap = [](float value, float step) { return std::round(value / step) * step; };
+
+    settings.lowCutFreq = snap(settings.lowCutFreq, 1.f);
+    settings.highCutFreq = snap(settings.highCutFreq, 1.f);
+    settings.peakFreq = snap(settings.peakFreq, 1.f);
+    settings.peakGainInDecibels = snap(settings.peakGainInDecibels, 0.5f);
+    settings.peakQuality = juce::jlimit(0.1f, 10.f, snap(settings.peakQuality, 0.05f));
+    return settings;
+}
+
+std::vector<double> smoothedDecibels(const LongTermSpectrum& spectrum, const MatchEQOptions& options)
+{
+    std::vector<float> power(spectrum.power.begin(), spectrum.power.end() - 1);   // drop Nyquist
+
+    SpectrumSmoother smoother;
+    smoother.prepare(spectrum.fftSize, spectrum.sampleRate, options.smoothing, options.numFrequencies, 20.f, 20000.f);
+
+    std::vector<float> columns((size_t)options.numFrequencies);
+    smoother.process(power.data(), columns.data(), -200.f);
+
+    return { columns.begin(), columns.end() };
+}
+
+void removeMean(std::vector<double>& values)
+{
+    const auto mean = std::accumulate(values.begin(), values.end(), 0.0) / (double)values.size();
+    for( auto& v : values )
+        v -= mean;
+}
+
+struct Objective
+{
+    ChainMagnitudeEvaluator& evaluator;
+    const std::vector<double>& target;
+    double sampleRate;
+    Slope lowCutSlope, highCutSlope;
+
+    std::vector<double>& scratch;
+    int& numEvaluations;
+
+    double operator()(const Point& x) const
+    {
+        ++numEvaluations;
+        evaluator.evaluate(designChainSnapshot(SearchSpace::toSettings(x, lowCutSlope, highCutSlope), sampleRate),
+                           scratch.data());
+
+        const auto mean = std::accumulate(scratch.begin(), scratch.end(), 0.0) / (double)scratch.size();
+
+        double error = 0.0;
+        for( size_t k = 0; k < scratch.size(); ++k )
+        {
+            const auto d = scratch[k] - mean - target[k];
+            error += d * d;
+        }
+
+        return error;
+    }
+};
+
+// plain Nelder-Mead with the standard coefficients, clamped to the unit box
+Point minimise(const Objective& f, const Point& start, int maxIterations, double& bestValue)
+{
+    std::array<Point, numDimensions + 1> simplex;
+    std::array<double, numDimensions + 1> values;
+
+    simplex[0] = start;
+    for( int d = 0; d < numDimensions; ++d )
+    {
+        auto vertex = start;
+        vertex[(size_t)d] += vertex[(size_t)d] < 0.5 ? 0.15 : -0.15;
+        simplex[(size_t)d + 1] = vertex;
+    }
+
+    for( size_t i = 0; i < simplex.size(); ++i )
+        values[i] = f(simplex[i]);
+
+    auto combine = [](const Point& a, const Point& b, double t)
+    {
+        Point p;
+        for( size_t d = 0; d < p.size(); ++d )
+            p[d] = a[d] + t * (b[d] - a[d]);
+        return SearchSpace::clamp(p);
+    };
+
+    for( int iteration = 0; iteration < maxIterations; ++iteration )
+    {
+        std::array<size_t, numDimensions + 1> order;
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+
+        const auto best = order.front(), worst = order.back(), secondWorst = order[order.size() - 2];
+
+        if( values[worst] - values[best] < 1e-9 * (1.0 + values[best]) )
+            break;
+
+        Point centroid {};
+        for( size_t i = 0; i < order.size() - 1; ++i )
+            for( size_t d = 0; d < centroid.size(); ++d )
+                centroid[d] += simplex[order[i]][d] / numDimensions;
+
+        const auto reflected = combine(centroid, simplex[worst], -1.0);
+        const auto reflectedValue = f(reflected);
+
+        if( reflectedValue < values[best] )
+        {
+            const auto expanded = combine(centroid, simplex[worst], -2.0);
+            const auto expandedValue = f(expanded);
+
+            if( expandedValue < reflectedValue )
+            {
+                simplex[worst] = expanded;
+                values[worst] = expandedValue;
+            }
+            else
+            {
+                simplex[worst] = reflected;
+                values[worst] = reflectedValue;
+            }
+        }
+        else if( reflectedValue < values[secondWorst] )
+        {
+            simplex[worst] = reflected;
+            values[worst] = reflectedValue;
+        }
+        else
+        {
+            const auto contracted = combine(centroid, simplex[worst], 0.5);
+            const auto contractedValue = f(contracted);
+
+            if( contractedValue < values[worst] )
+            {
+                simplex[worst] = contracted;
+                values[worst] = contractedValue;
+            }
+            else
+            {
+                for( size_t i = 0; i < simplex.size(); ++i )
+                {
+                    if( i == best )
+                        continue;
+
+                    simplex[i] = combine(simplex[best], simplex[i], 0.5);
+                    values[i] = f(simplex[i]);
+                }
+            }
+        }
+    }
+
+    const auto best = (size_t)std::distance(values.begin(), std::min_element(values.begin(), values.end()));
+    bestValue = values[best];
+    return simplex[best];
+}
+}
+
+MatchEQResult fitMatchEQ(const LongTermSpectrum& material, const LongTermSpectrum& reference,
+                         double sampleRate, const MatchEQOptions& options)
+{
+    MatchEQResult result;
+    if( ! material.isValid() || ! reference.isValid() || options.numFrequencies < 2 )
+        return result;
+
+    for( int k = 0; k < options.numFrequencies; ++k )
+        result.frequencies.push_back(juce::mapToLog10(double(k) / double(options.numFrequencies - 1), 20.0, 20000.0));
+
+    const auto materialDecibels = smoothedDecibels(material, options);
+    const auto referenceDecibels = smoothedDecibels(reference, options);
+
+    result.targetDecibels.resize(result.frequencies.size());
+    for( size_t k = 0; k < result.targetDecibels.size(); ++k )
+        result.targetDecibels[k] = referenceDecibels[k] - materialDecibels[k];
+
+    removeMean(result.targetDecibels);
+
+    ChainMagnitudeEvaluator evaluator;
+    evaluator.prepare(result.frequencies, sampleRate);
+    std::vector<double> scratch(result.frequencies.size());
+
+    auto bestError = std::numeric_limits<double>::max();
+
+    for( int lowCutSlope = Slope_12; lowCutSlope <= Slope_48; ++lowCutSlope )
+    {
+        for( int highCutSlope = Slope_12; highCutSlope <= Slope_48; ++highCutSlope )
+        {
+            const Objective objective { evaluator, result.targetDecibels, sampleRate,
+                                        Slope(lowCutSlope), Slope(highCutSlope),
+                                        scratch, result.numEvaluations };
+
+            // cuts open, a flat peak at a few places across the band
+            for( auto peakStart : { 0.1, 0.3, 0.5, 0.7, 0.9 } )
+            {
+                double error = 0.0;
+                const auto x = minimise(objective, { 0.0, 1.0, peakStart, 0.5, 0.5 }, options.maxIterations, error);
+
+                if( error < bestError )
+                {
+                    bestError = error;
+                    result.settings = SearchSpace::toSettings(x, Slope(lowCutSlope), Slope(highCutSlope));
+                }
+            }
+        }
+    }
+
+    result.settings = snapToParameterSteps(result.settings);
+
+    result.fittedDecibels.resize(result.frequencies.size());
+    evaluator.evaluate(designChainSnapshot(result.settings, sampleRate), result.fittedDecibels.data());
+    removeMean(result.fittedDecibels);
+
+    double squaredError = 0.0;
+    for( size_t k = 0; k < result.frequencies.size(); ++k )
+        squaredError += juce::square(result.fittedDecibels[k] - result.targetDecibels[k]);
+
+    result.rmsErrorDecibels = std::sqrt(squaredError / (double)result.frequencies.size());
+    return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ChainSnapshot.h"
+#include "LongTermSpectrum.h"
+#include "SpectrumSmoother.h"
+
+#include <vector>
+
+// FFT order for the spectra fitMatchEQ compares.  Low cuts sit in the bottom octaves, where a
+// shorter FFT's Hann main lobe smears a steep slope into a shallow one and the fit goes wrong.
+constexpr int matchEQSpectrumOrder = 14;
+
+struct MatchEQOptions
+{
+    int numFrequencies = 96;                        // log-spaced from 20 Hz to 20 kHz
+    AnalyzerSmoothing smoothing = ThirdOctave;      // applied to both spectra before comparing
+    int maxIterations = 400;                        // per Nelder-Mead run
+};
+
+struct MatchEQResult
+{
+    ChainSettings settings;
+    double rmsErrorDecibels = 0.0;
+    int numEvaluations = 0;
+
+    std::vector<double> frequencies;
+    std::vector<double> targetDecibels, fittedDecibels;     // both with their mean removed
+};
+
+/*
+ Chooses LoCut/Peak/HiCut settings that move material's long-term spectrum toward reference's.
+
+ The target is the smoothed dB difference reference - material, with its mean removed: the chain
+ has no output gain, so only the shape matters.  For every pair of cut slopes, a Nelder-Mead search
+ over cut frequencies and the peak's frequency, gain and Q minimises the squared error between the
+ mean-removed chain response and the target, starting from a few peak frequencies.  The best
+ result is snapped to the parameters' step sizes.
+ */
+MatchEQResult fitMatchEQ(const LongTermSpectrum& material, const LongTermSpectrum& reference,
+                         double sampleRate, const MatchEQOptions& options = {});
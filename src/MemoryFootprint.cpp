@@ -0,0 +1,35 @@
+#include "MemoryFootprint.h"
+
+#include <cstring>
+
+size_t MemoryFootprint::getBytes(const char* subsystem) const
+{
+    size_t bytes = 0;
+    for( const auto& entry : entries )
+        if( std::strcmp(entry.subsystem, subsystem) == 0 )
+            bytes += entry.bytes;
+
+    return bytes;
+}
+
+size_t MemoryFootprint::getInstanceBytes() const
+{
+    size_t bytes = 0;
+    for( const auto& entry : entries )
+        if( std::strcmp(entry.subsystem, sharedTables) != 0 )
+            bytes += entry.bytes;
+
+    return bytes;
+}
+
+juce::String MemoryFootprint::toString() const
+{
+    juce::String text;
+    for( const auto& entry : entries )
+        text << juce::String(entry.subsystem).paddedRight(' ', 32)
+             << juce::String(double(entry.bytes) / 1024.0, 1).paddedLeft(' ', 10) << " kB\n";
+
+    text << juce::String("instance total").paddedRight(' ', 32)
+         << juce::String(double(getInstanceBytes()) / 1024.0, 1).paddedLeft(' ', 10) << " kB\n";
+    return text;
+}
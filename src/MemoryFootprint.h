@@ -0,0 +1,51 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <vector>
+
+/*
+ What one processor or editor holds, by subsystem, so the cost of one more instance or one more
+ open editor can be read off rather than guessed from the process's resident size.
+
+ Each entry is the heap a subsystem owns; the objects themselves are counted once, as the size of
+ the processor or editor.  Tables from SharedTables are listed on their own line: they are paid
+ once per process, not again by the next instance.  Sizes are what was allocated, not what was
+ touched, so the figures are an upper bound on what the instance adds to the resident size.
+ */
+struct MemoryFootprint
+{
+    struct Entry
+    {
+        const char* subsystem;
+        size_t bytes;
+    };
+
+    std::vector<Entry> entries;
+
+    void add(const char* subsystem, size_t bytes) { entries.push_back({ subsystem, bytes }); }
+
+    size_t getBytes(const char* subsystem) const;
+
+    // everything except the shared tables
+    size_t getInstanceBytes() const;
+
+    // one line per entry, in kB
+    juce::String toString() const;
+
+    static constexpr const char* sharedTables = "shared tables (process-wide)";
+};
+
+// heap owned by the containers we store entries in; anything else is counted as owning none
+template<typename T>
+size_t getHeapSizeInBytes(const T&) { return 0; }
+
+template<typename T, typename Allocator>
+size_t getHeapSizeInBytes(const std::vector<T, Allocator>& v) { return v.capacity() * sizeof(T); }
+
+template<typename T>
+size_t getHeapSizeInBytes(const juce::AudioBuffer<T>& buffer)
+{
+    return size_t(buffer.getNumChannels()) * size_t(buffer.getNumSamples()) * sizeof(T)
+         + size_t(buffer.getNumChannels()) * sizeof(T*);
+}
@@ -1,6 +1,30 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+namespace
+{
+    // 'layer' sized to 'bounds' at 'scale' pixels per point and cleared, reusing its pixels when the size hasn't changed
+    void prepareLayer(juce::Image& layer, juce::Image::PixelFormat format, juce::Rectangle<int> bounds, float scale)
+    {
+        const auto width = juce::jmax(1, juce::roundToInt(float(bounds.getWidth()) * scale));
+        const auto height = juce::jmax(1, juce::roundToInt(float(bounds.getHeight()) * scale));
+
+        if( layer.isValid() && layer.getFormat() == format && layer.getWidth() == width && layer.getHeight() == height )
+            layer.clear(layer.getBounds());
+        else
+            layer = juce::Image(format, width, height, true);
+    }
+
+    size_t getImageBytes(const juce::Image& image)
+    {
+        if( ! image.isValid() )
+            return 0;
+
+        const juce::Image::BitmapData pixels(image, juce::Image::BitmapData::readOnly);
+        return size_t(pixels.lineStride) * size_t(pixels.height);
+    }
+}
+
 void LookAndFeel::drawRotarySlider(juce::Graphics& g,
                                     int x,
                                     int y,
@@ -15,46 +39,58 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g,
 
     auto bounds = Rectangle<float>(x,y, width, height);
 
-	auto enabled = slider.isEnabled();
+    drawRotarySliderFace(g, bounds, slider.isEnabled());
+
+    if( auto* lrs = dynamic_cast<LabeledRotarySlider*>(&slider))
+    {
+        jassert(rotaryStartAngle < rotaryEndAngle);
+        drawRotarySliderPointer(g, bounds, jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle), *lrs);
+    }
+}
+
+void LookAndFeel::drawRotarySliderFace(juce::Graphics& g, juce::Rectangle<float> bounds, bool enabled)
+{
+    using namespace juce;
+
     g.setColour(enabled ? Colour(0u, 0u, 51u) : Colours::darkgrey);
     g.fillEllipse(bounds);
 
     g.setColour(enabled ? Colour(0u, 204u, 102u) : Colours::grey);
     g.drawEllipse(bounds, 1.f);
+}
 
-    if( auto* lrs = dynamic_cast<LabeledRotarySlider*>(&slider))
-    {
-        auto center = bounds.getCentre();
-        Path p;
-
-        Rectangle<float> r;
-        r.setLeft(center.getX()-2);
-        r.setRight(center.getX()+2);
-        r.setTop(bounds.getY());
-        r.setBottom(center.getY() - lrs->getTextHeight() * 1.5);
+void LookAndFeel::drawRotarySliderPointer(juce::Graphics& g, juce::Rectangle<float> bounds, float angle, LabeledRotarySlider& lrs)
+{
+    using namespace juce;
 
-        p.addRoundedRectangle(r, 2.f);
-        jassert(rotaryStartAngle < rotaryEndAngle);
+    auto enabled = lrs.isEnabled();
+    auto center = bounds.getCentre();
+    Path p;
 
-        auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
+    Rectangle<float> r;
+    r.setLeft(center.getX()-2);
+    r.setRight(center.getX()+2);
+    r.setTop(bounds.getY());
+    r.setBottom(center.getY() - lrs.getTextHeight() * 1.5);
 
-        p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
+    p.addRoundedRectangle(r, 2.f);
+    p.applyTransform(AffineTransform().rotated(angle, center.getX(), center.getY()));
 
-        g.fillPath(p);
+    g.setColour(enabled ? Colour(0u, 204u, 102u) : Colours::grey);
+    g.fillPath(p);
 
-        g.setFont(lrs->getTextHeight());
-        auto text = lrs->getDisplayString();
-        auto strWidth = g.getCurrentFont().getStringWidth(text);
+    g.setFont(lrs.getTextHeight());
+    auto text = lrs.getDisplayString();
+    auto strWidth = g.getCurrentFont().getStringWidth(text);
 
-        r.setSize(strWidth + 4, lrs->getTextHeight() + 2);
-        r.setCentre(bounds.getCentre());
+    r.setSize(strWidth + 4, lrs.getTextHeight() + 2);
+    r.setCentre(bounds.getCentre());
 
-        g.setColour(enabled ? Colours::black : Colours::darkgrey);
-        g.fillRect(r);
+    g.setColour(enabled ? Colours::black : Colours::darkgrey);
+    g.fillRect(r);
 
-        g.setColour(enabled ? Colours::white : Colours::lightgrey);
-        g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
-    }
+    g.setColour(enabled ? Colours::white : Colours::lightgrey);
+    g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
 }
 
 void LookAndFeel::drawToggleButton(juce::Graphics &g,
@@ -108,6 +144,17 @@ void LookAndFeel::drawToggleButton(juce::Graphics &g,
 
         g.strokePath(analyzerButton->randomPath, PathStrokeType(1.f));
     }
+    else if( dynamic_cast<LoadButton*>(&toggleButton) || dynamic_cast<MeasureButton*>(&toggleButton) )
+    {
+        auto color = !toggleButton.getToggleState() ? Colours::dimgrey : Colour(0u, 172u, 1u);
+
+        g.setColour(color);
+
+        auto bounds = toggleButton.getLocalBounds();
+        g.drawRect(bounds);
+        g.setFont(12);
+        g.drawFittedText(dynamic_cast<LoadButton*>(&toggleButton) ? "LOAD" : "MEAS", bounds, Justification::centred, 1);
+    }
 }
 
 void LabeledRotarySlider::paint(juce::Graphics& g)
@@ -126,15 +173,36 @@ void LabeledRotarySlider::paint(juce::Graphics& g)
     // g.setColour(Colours::yellow);
     // g.drawRect(sliderBounds);
 
-    getLookAndFeel().drawRotarySlider(g, 
-                                        sliderBounds.getX(), 
-                                        sliderBounds.getY(), 
-                                        sliderBounds.getWidth(), 
-                                        sliderBounds.getHeight(), 
-                                        jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0),
-                                        startAng,
-                                        endAng,
-                                        *this);
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if( ! faceSprite.isValid()
+        || faceScale != scale
+        || faceEnabled != isEnabled()
+        || faceSprite.getWidth() != jmax(1, roundToInt(float(getWidth()) * scale))
+        || faceSprite.getHeight() != jmax(1, roundToInt(float(getHeight()) * scale)) )
+    {
+        renderFaceSprite(scale, startAng, endAng);
+    }
+
+    g.drawImage(faceSprite, getLocalBounds().toFloat());
+
+    auto sliderAngRad = (float)jmap(getValue(), range.getStart(), range.getEnd(), (double)startAng, (double)endAng);
+    laf.drawRotarySliderPointer(g, sliderBounds.toFloat(), sliderAngRad, *this);
+}
+
+void LabeledRotarySlider::renderFaceSprite(float scale, float startAng, float endAng)
+{
+    using namespace juce;
+
+    faceScale = scale;
+    faceEnabled = isEnabled();
+    prepareLayer(faceSprite, Image::ARGB, getLocalBounds(), scale);
+
+    Graphics g(faceSprite);
+    g.addTransform(AffineTransform::scale(scale));
+
+    auto sliderBounds = getSliderBounds();
+    laf.drawRotarySliderFace(g, sliderBounds.toFloat(), faceEnabled);
 
     auto center = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.getWidth() * 0.5f;
@@ -161,7 +229,6 @@ void LabeledRotarySlider::paint(juce::Graphics& g)
 
         g.drawFittedText(str, r.toNearestInt(), juce::Justification::centred, 1);
     }
-    
 }
 
 juce::Rectangle<int> LabeledRotarySlider::getSliderBounds() const
@@ -248,9 +315,21 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
     parametersChanged.set(true);
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+bool PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
 {
+    SIMPLEEQ_ZONE_NAMED("PathProducer::process");
+
+    auto ticks = juce::Time::getHighResolutionTicks();
+    auto millisecondsSinceLast = [&ticks]
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        const auto milliseconds = 1000.0 * juce::Time::highResolutionTicksToSeconds(now - ticks);
+        ticks = now;
+        return milliseconds;
+    };
+
     juce::AudioBuffer<float> tempIncomingBuffer;
+    bool receivedAudio = false;
 
     while( leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
     {
@@ -258,146 +337,224 @@ void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
         {
             // must make sure the samples are stuffed in the same order they came in
             // first, shift 
-            auto size = tempIncomingBuffer.getNumSamples();
+            auto size = juce::jmin(tempIncomingBuffer.getNumSamples(), monoBuffer.getNumSamples());
 
             juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
                                               monoBuffer.getReadPointer(0, size),
                                               monoBuffer.getNumSamples() - size);
 
             juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                                             tempIncomingBuffer.getReadPointer(0, 0),
+                                             tempIncomingBuffer.getReadPointer(0, tempIncomingBuffer.getNumSamples() - size),
                                              size);
-
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+            receivedAudio = true;
         }
     }
 
+    timings.fifoDrainMilliseconds = millisecondsSinceLast();
+
+    // blocks are produced and drained within this call, so switching the format here is safe
+    const auto smoothed = smoothing != SmoothingOff;
+    leftChannelFFTDataGenerator.setProducesPower(smoothed);
+
+    // only the newest spectrum gets drawn, so one FFT per tick over the latest audio is enough,
+    // however many small host buffers arrived since the last one
+    if( receivedAudio )
+        leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+
+    timings.fftMilliseconds = millisecondsSinceLast();
+
     const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    const auto binWidth = sampleRate / (double)fftSize;
+    const auto width = (int)fftBounds.getWidth();
+
+    if( ! smoothed && (binPixels == nullptr || ! binPixels->matches(fftSize, sampleRate, width)) )
+        binPixels = SharedTables::getBinPixelMap(fftSize, sampleRate, width);
+
+    if( smoothed )
+    {
+        // one smoothed value every 'pathResolution' pixels, the same density generatePath draws at
+        const int pathResolution = 2;
+        const auto numColumns = (int)fftBounds.getWidth() / pathResolution + 1;
+
+        smoother.prepare(fftSize, sampleRate, smoothing, numColumns, 20.f, 20000.f);
+        smoothedColumns.resize((size_t)numColumns);
+    }
 
     while( leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
     {
-        std::vector<float> fftData;
         if(leftChannelFFTDataGenerator.getFFTData(fftData) )
         {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+            if( smoothed )
+            {
+                smoother.process(fftData.data(), smoothedColumns.data(), -48.f);
+                pathProducer.generateColumnPath(smoothedColumns, fftBounds, -48.f);
+            }
+            else
+            {
+                pathProducer.generatePath(fftData, fftBounds, *binPixels, -48.f);
+            }
         }
     }
 
     // while paths exist to pull, pull as many as possible.  We'll only display the most recent path
+    bool pulledPath = false;
     while( pathProducer.getNumPathsAvailable() )
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        pulledPath = pathProducer.getPath(leftChannelFFTPath) || pulledPath;
     }
+
+    timings.pathMilliseconds = millisecondsSinceLast();
+    return pulledPath;
+}
+
+void PathProducer::discard()
+{
+    juce::AudioBuffer<float> tempIncomingBuffer;
+    while( leftChannelFifo->getNumCompleteBuffersAvailable() > 0 )
+        leftChannelFifo->getAudioBuffer(tempIncomingBuffer);
+
+    timings = {};
+}
+
+size_t PathProducer::getHeapSizeInBytes() const
+{
+    return ::getHeapSizeInBytes(monoBuffer)
+         + leftChannelFFTDataGenerator.getHeapSizeInBytes()
+         + pathProducer.getHeapSizeInBytes()
+         + smoother.getHeapSizeInBytes()
+         + ::getHeapSizeInBytes(smoothedColumns)
+         + ::getHeapSizeInBytes(fftData);
 }
 
 void ResponseCurveComponent::timerCallback()
 {
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if( resizeSettleTicks != 0 && startTicks >= resizeSettleTicks )
+        settleSize();
+
     auto fftBounds = getAnalysisArea().toFloat();
     auto sampleRate = processorRef.getSampleRate();
+
+    const auto smoothing = (AnalyzerSmoothing)(int)processorRef.apvts.getRawParameterValue("Analyzer Smoothing")->load();
+    leftPathProducer.setSmoothing(smoothing);
+    rightPathProducer.setSmoothing(smoothing);
     
-    leftPathProducer.process(fftBounds, sampleRate);
-    rightPathProducer.process(fftBounds, sampleRate);
+    const auto enabled = processorRef.apvts.getRawParameterValue("Analyzer Enabled")->load() > 0.5f;
+    if( enabled != analyzerEnabled )
+    {
+        analyzerEnabled = enabled;
+        analyzerLayerDirty = true;
+    }
+
+    if( analyzerEnabled )
+    {
+        // both run every tick so neither FIFO backs up, whichever of them has something new
+        const auto leftPulled = leftPathProducer.process(fftBounds, sampleRate);
+        const auto rightPulled = rightPathProducer.process(fftBounds, sampleRate);
+        if( leftPulled || rightPulled )
+            analyzerLayerDirty = true;
+    }
+    else
+    {
+        leftPathProducer.discard();
+        rightPathProducer.discard();
+    }
+
+    auto& measurement = processorRef.getMeasurement();
+    if( ! measurement.isEnabled() )
+    {
+        if( measuredResponse.isValid() )
+            curveLayerDirty = true;
+
+        measuredResponse = {};
+    }
+    else if( measurement.acquireLatestResponse() )
+    {
+        measuredResponse = measurement.getResponse();
+        curveLayerDirty = true;
+    }
 
     if( parametersChanged.compareAndSetBool(false, true))
     {
         updateChain();
     }
 
-    repaint();
+    // nothing changed, nothing to composite
+    if( backgroundDirty || analyzerLayerDirty || curveLayerDirty )
+        repaint();
+
+    timerCallbackMilliseconds = 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
 }
 
-void ResponseCurveComponent::updateChain()
+PathProducer::Timings ResponseCurveComponent::getAnalyzerTimings() const
 {
-    // update Editor local monochain
-    auto chainSettings = getChainSettings(processorRef.apvts);
+    const auto& left = leftPathProducer.getTimings();
+    const auto& right = rightPathProducer.getTimings();
 
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.loCutBypassed);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    monoChain.setBypassed<ChainPositions::HiCut>(chainSettings.hiCutBypassed);
-
-    auto peakCoefficients = makePeakFilter(chainSettings, processorRef.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    
-    auto lowCutCoefficients = makeLoCutFilter(chainSettings, processorRef.getSampleRate());
-    auto hiCutCoefficients  = makeHiCutFilter(chainSettings, processorRef.getSampleRate());
+    return { left.fifoDrainMilliseconds + right.fifoDrainMilliseconds,
+             left.fftMilliseconds + right.fftMilliseconds,
+             left.pathMilliseconds + right.pathMilliseconds };
+}
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HiCut>(), hiCutCoefficients, chainSettings.highCutSlope);
+void ResponseCurveComponent::updateChain()
+{
+    // the processor designed these already; drawing from the same snapshot the audio thread
+    // runs means the curve can't drift from what is actually heard
+    chainSnapshot = processorRef.getLatestStereoChainSnapshot();
+    curveLayerDirty = true;
 }
 
 void ResponseCurveComponent::paint (juce::Graphics& g)
 {
+    SIMPLEEQ_ZONE_NAMED("ResponseCurveComponent::paint");
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
     using namespace juce;
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll(Colours::black);
     // g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
 
-    g.drawImage(background, getLocalBounds().toFloat());
+    // moving the window to a display with another scale redraws everything at the new resolution
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if( scale != layerScale )
+    {
+        layerScale = scale;
+        backgroundDirty = analyzerLayerDirty = curveLayerDirty = true;
+    }
 
-    auto responseArea = getAnalysisArea();
-    auto w = responseArea.getWidth();
+    if( backgroundDirty )
+        renderBackground();
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& hicut = monoChain.get<ChainPositions::HiCut>();
+    if( analyzerLayerDirty )
+        renderAnalyzer();
 
-    auto sampleRate = processorRef.getSampleRate();
-    std::vector<double> mags;
+    if( curveLayerDirty )
+        renderCurves();
 
-    mags.resize(w);
+    const auto bounds = getLocalBounds().toFloat();
+    g.drawImage(background, bounds);
+    if( analyzerEnabled )
+        g.drawImage(analyzerLayer, bounds);
+    g.drawImage(curveLayer, bounds);
 
-    for (int i = 0; i < w; i++)
-    {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+    paintMilliseconds = 1000.0 * Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    SIMPLEEQ_FRAME_MARK_NAMED("Editor repaint");
+}
 
-        if( !monoChain.isBypassed<ChainPositions::Peak>() )
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+void ResponseCurveComponent::renderAnalyzer()
+{
+    using namespace juce;
 
-        if( !monoChain.isBypassed<ChainPositions::LowCut>() )
-        {
-            if(! lowcut.isBypassed<0>() )
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(! lowcut.isBypassed<1>() )
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(! lowcut.isBypassed<2>() )
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(! lowcut.isBypassed<3>() )
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        
-        if( !monoChain.isBypassed<ChainPositions::HiCut>() )
-        {
-            if(! hicut.isBypassed<0>() )
-                mag *= hicut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(! hicut.isBypassed<1>() )
-                mag *= hicut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(! hicut.isBypassed<2>() )
-                mag *= hicut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if(! hicut.isBypassed<3>() )
-                mag *= hicut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+    analyzerLayerDirty = false;
+    prepareLayer(analyzerLayer, Image::ARGB, layerBounds, layerScale);
 
-        // Convert magnitude into decibels
-        mags[i] = Decibels::gainToDecibels(mag);
-    }
-    
-    Path responseCurve;
-
-    const double outputMin = responseArea.getBottom();
-    const double outputMax = responseArea.getY();
-    auto map = [outputMin, outputMax](double input)
-    {
-        return jmap(input, -24.0, 24.0, outputMin, outputMax);
-    };
+    if( ! analyzerEnabled )
+        return;
 
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    Graphics g(analyzerLayer);
+    g.addTransform(AffineTransform::scale(layerScale));
 
-    for (size_t i = 1; i < mags.size(); ++i)
-    {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-    }
+    auto responseArea = getAnalysisArea();
 
     auto leftChannelFFTPath = leftPathProducer.getPath();
     leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(),responseArea.getY()));
@@ -409,20 +566,169 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     
     g.setColour(Colours::lightyellow);
     g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+}
+
+void ResponseCurveComponent::renderCurves()
+{
+    using namespace juce;
 
+    curveLayerDirty = false;
+    prepareLayer(curveLayer, Image::ARGB, layerBounds, layerScale);
+
+    Graphics g(curveLayer);
+    g.addTransform(AffineTransform::scale(layerScale));
+
+    auto responseArea = getAnalysisArea();
+    auto w = responseArea.getWidth();
+
+    const double outputMin = responseArea.getBottom();
+    const double outputMax = responseArea.getY();
+    auto map = [outputMin, outputMax](double input)
+    {
+        return jmap(input, -24.0, 24.0, outputMin, outputMax);
+    };
+
+    std::vector<double> mags;
+
+    mags.resize(w);
+
+    const auto& frequencies = *pixelFrequencies;
+
+    auto makeResponseCurve = [&](const ChainSnapshot& snapshot)
+    {
+        for (int i = 0; i < w; i++)
+        {
+            auto mag = snapshot.getMagnitudeForFrequency(frequencies[(size_t)i]);
+
+            // Convert magnitude into decibels
+            mags[i] = Decibels::gainToDecibels(mag);
+        }
+
+        Path curve;
+        curve.startNewSubPath(responseArea.getX(), map(mags.front()));
+
+        for (size_t i = 1; i < mags.size(); ++i)
+        {
+            curve.lineTo(responseArea.getX() + i, map(mags[i]));
+        }
+
+        return curve;
+    };
+
+    // the border lives here rather than in the background so the analyzer stays under it
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(getRenderArea().toFloat(),4.f, 1.f);
 
+    // left or mid in white; right or side on top of it when the channels have their own settings
     g.setColour(Colours::white);
-    g.strokePath(responseCurve, PathStrokeType(2.f));
+    g.strokePath(makeResponseCurve(chainSnapshot.channels[0]), PathStrokeType(2.f));
+
+    if( ! chainSnapshot.isLinked() )
+    {
+        g.setColour(Colours::skyblue);
+        g.strokePath(makeResponseCurve(chainSnapshot.channels[1]), PathStrokeType(2.f));
+    }
+
+    if( measuredResponse.isValid() )
+    {
+        // what the audio path really did, and how far to trust it: coherence runs from 0 at the
+        // bottom of the area to 1 at the top
+        Path measuredCurve, coherenceCurve;
+
+        for (int i = 0; i < w; i++)
+        {
+            auto freq = frequencies[(size_t)i];
+            auto x = float(responseArea.getX() + i);
+            auto measuredY = (float)map(measuredResponse.getMagnitudeDecibelsForFrequency(freq));
+            auto coherenceY = (float)jmap((double)measuredResponse.getCoherenceForFrequency(freq), outputMin, outputMax);
+
+            if( i == 0 )
+            {
+                measuredCurve.startNewSubPath(x, measuredY);
+                coherenceCurve.startNewSubPath(x, coherenceY);
+            }
+            else
+            {
+                measuredCurve.lineTo(x, measuredY);
+                coherenceCurve.lineTo(x, coherenceY);
+            }
+        }
+
+        g.setColour(Colours::mediumpurple.withAlpha(0.6f));
+        g.strokePath(coherenceCurve, PathStrokeType(1.f));
+
+        g.setColour(Colours::hotpink);
+        g.strokePath(measuredCurve, PathStrokeType(1.5f));
+    }
+}
+
+void ResponseCurveComponent::addToMemoryFootprint(MemoryFootprint& footprint) const
+{
+    footprint.add("response curve", getImageBytes(background)
+                                    + getImageBytes(curveLayer)
+                                    + getHeapSizeInBytes(measuredResponse.magnitudeDecibels)
+                                    + getHeapSizeInBytes(measuredResponse.coherence));
+    footprint.add("analyzer", getImageBytes(analyzerLayer)
+                              + leftPathProducer.getHeapSizeInBytes()
+                              + rightPathProducer.getHeapSizeInBytes());
 }
 
 void ResponseCurveComponent::resized()
+{
+    // the first size is taken straight away; after that paint() stretches the layers to follow a
+    // drag and the timer takes the new size once it has stopped changing
+    if( layerBounds.isEmpty() )
+    {
+        settleSize();
+        return;
+    }
+
+    resizeSettleTicks = juce::Time::getHighResolutionTicks()
+                      + juce::Time::secondsToHighResolutionTicks(resizeSettleSeconds);
+    repaint();
+}
+
+void ResponseCurveComponent::settleSize()
+{
+    resizeSettleTicks = 0;
+    layerBounds = getLocalBounds();
+
+    // the per-width tables: the curve's column frequencies here, the analyzer's bin and smoothing
+    // maps in PathProducer::process, which follows getAnalysisArea()
+    pixelFrequencies = SharedTables::getPixelFrequencies(getAnalysisArea().getWidth(), 20.0, 20000.0);
+
+    // the analyzer's paths are in the old size's coordinates until the next ones arrive, but
+    // redrawing them now keeps the layer the same size as the others
+    backgroundDirty = analyzerLayerDirty = curveLayerDirty = true;
+
+    // render the grid now, at the scale of the display the window is on, rather than in the next paint()
+    if( isShowing() )
+    {
+        if( auto* display = juce::Desktop::getInstance().getDisplays().getDisplayForRect(getScreenBounds()) )
+        {
+            const auto scale = float(display->scale) * juce::Component::getApproximateScaleFactorForComponent(this);
+            if( scale != layerScale )
+            {
+                layerScale = scale;
+                analyzerLayerDirty = curveLayerDirty = true;
+            }
+
+            renderBackground();
+        }
+    }
+
+    repaint();
+}
+
+void ResponseCurveComponent::renderBackground()
 {
     using namespace juce;
-    background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
+
+    backgroundDirty = false;
+    prepareLayer(background, Image::PixelFormat::RGB, layerBounds, layerScale);
 
     Graphics g(background);
+    g.addTransform(AffineTransform::scale(layerScale));
 
     Array<float> freqs
     {
@@ -509,7 +815,7 @@ void ResponseCurveComponent::resized()
         
         Rectangle<int> r;
         r.setSize(textWidth, fontHeight);
-        r.setX(getWidth() - textWidth);
+        r.setX(layerBounds.getWidth() - textWidth);
         r.setCentre(r.getCentreX(), y);
         
         g.setColour(gDb == 0.f ? Colour(0u, 172u, 1u) : Colours::lightgrey );
@@ -529,7 +835,7 @@ void ResponseCurveComponent::resized()
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
 {
-    auto bounds = getLocalBounds();
+    auto bounds = layerBounds;
     bounds.removeFromTop(12);
     bounds.removeFromBottom(6);
     bounds.removeFromLeft(16);
@@ -545,6 +851,77 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea()
     return bounds;
 }
 
+//==============================================================================
+LoadOverlay::LoadOverlay(SimpleEQAudioProcessor& p, const ResponseCurveComponent& curve) :
+processorRef(p),
+responseCurve(curve)
+{
+}
+
+void LoadOverlay::visibilityChanged()
+{
+    if( isVisible() )
+    {
+        timerCallback();
+        startTimerHz(10);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void LoadOverlay::timerCallback()
+{
+    const auto& loadHistogram = processorRef.getTelemetry().getLoadHistogram();
+    currentLoad = loadHistogram.getLast();
+    peakLoad = loadHistogram.getMax();
+
+    leftFifoFill = processorRef.leftChannelFifo.getNumCompleteBuffersAvailable();
+    rightFifoFill = processorRef.rightChannelFifo.getNumCompleteBuffersAvailable();
+    fifoCapacity = processorRef.leftChannelFifo.getCapacity();
+    droppedBuffers = processorRef.leftChannelFifo.getNumDroppedBuffers()
+                   + processorRef.rightChannelFifo.getNumDroppedBuffers();
+    overwrittenBuffers = processorRef.leftChannelFifo.getNumOverwrittenBuffers()
+                       + processorRef.rightChannelFifo.getNumOverwrittenBuffers();
+
+    timerCallbackMilliseconds = responseCurve.getTimerCallbackMilliseconds();
+    paintMilliseconds = responseCurve.getPaintMilliseconds();
+
+    repaint();
+}
+
+void LoadOverlay::mouseDoubleClick(const juce::MouseEvent&)
+{
+    processorRef.getTelemetry().reset();
+    timerCallback();
+}
+
+void LoadOverlay::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    g.setColour(Colours::black.withAlpha(0.75f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.f);
+
+    auto percent = [](double load) { return String(100.0 * load, 1) + "%"; };
+
+    StringArray lines;
+    lines.add("DSP load  " + percent(currentLoad) + "  (peak " + percent(peakLoad) + ")");
+    lines.add("FIFO  L " + String(leftFifoFill) + "/" + String(fifoCapacity)
+              + "  R " + String(rightFifoFill) + "/" + String(fifoCapacity));
+    lines.add("dropped " + String(droppedBuffers) + "  overwritten " + String(overwrittenBuffers));
+    lines.add("timer " + String(timerCallbackMilliseconds, 2) + " ms  paint " + String(paintMilliseconds, 2) + " ms");
+
+    g.setColour(peakLoad >= 1.0 ? Colours::orangered : Colours::lightgrey);
+    g.setFont(12);
+
+    auto bounds = getLocalBounds().reduced(6, 4);
+    const auto lineHeight = bounds.getHeight() / lines.size();
+    for( auto& line : lines )
+        g.drawFittedText(line, bounds.removeFromTop(lineHeight), Justification::centredLeft, 1);
+}
+
 //==============================================================================
 // Constructor of SimpleEQAudioProcessorEditor class;
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
@@ -559,6 +936,7 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     hiCutSlopeSlider(*processorRef.apvts.getParameter("HiCut Slope"),"dB/Oct"),
 
     responseCurveComponent(processorRef),
+    loadOverlay(processorRef, responseCurveComponent),
 
     peakFreqSliderAttachment(processorRef.apvts, "Peak Freq", peakFreqSlider),
     peakGainSliderAttachment(processorRef.apvts, "Peak Gain", peakGainSlider),
@@ -568,10 +946,14 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     loCutSlopeSliderAttachment(processorRef.apvts, "LoCut Slope", loCutSlopeSlider),
     hiCutSlopeSliderAttachment(processorRef.apvts, "HiCut Slope", hiCutSlopeSlider),
 
+    analyzerSmoothingBox(*processorRef.apvts.getParameter("Analyzer Smoothing")),
+
     locutBypassButtonAttachment(processorRef.apvts, "LowCut Bypassed", locutBypassButton),
     peakBypassButtonAttachment(processorRef.apvts, "Peak Bypassed", peakBypassButton),
     hicutBypassButtonAttachment(processorRef.apvts, "HighCut Bypassed", hicutBypassButton),
-    analyzerEnabledButtonAttachment(processorRef.apvts, "Analyzer Enabled", analyzerEnabledButton)
+    analyzerEnabledButtonAttachment(processorRef.apvts, "Analyzer Enabled", analyzerEnabledButton),
+
+    analyzerSmoothingBoxAttachment(processorRef.apvts, "Analyzer Smoothing", analyzerSmoothingBox)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
@@ -602,11 +984,25 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
         addAndMakeVisible(comp);
     }
 
+    // on top of the response curve, hidden (and not polling) until asked for
+    addChildComponent(loadOverlay);
+    loadButton.onClick = [this] { loadOverlay.setVisible(loadButton.getToggleState()); };
+
+    // the measurement outlives the editor, so pick up whatever state it is in
+    measureButton.setToggleState(processorRef.getMeasurement().isEnabled(), juce::dontSendNotification);
+    measureButton.onClick = [this] { processorRef.getMeasurement().setEnabled(measureButton.getToggleState()); };
+
     peakBypassButton.setLookAndFeel(&laf);
     locutBypassButton.setLookAndFeel(&laf);
     hicutBypassButton.setLookAndFeel(&laf);
     analyzerEnabledButton.setLookAndFeel(&laf);
+    loadButton.setLookAndFeel(&laf);
+    measureButton.setLookAndFeel(&laf);
     
+    // proportional layout, so any size in between works; the response curve keeps its layers
+    // stretched while the corner is dragged and redraws them once it lets go
+    setResizable(true, true);
+    setResizeLimits(450, 360, 1800, 1440);
     setSize (600, 480);
 }
 
@@ -616,6 +1012,17 @@ SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
     locutBypassButton.setLookAndFeel(nullptr);
     hicutBypassButton.setLookAndFeel(nullptr);
     analyzerEnabledButton.setLookAndFeel(nullptr);
+    loadButton.setLookAndFeel(nullptr);
+    measureButton.setLookAndFeel(nullptr);
+}
+
+MemoryFootprint SimpleEQAudioProcessorEditor::getMemoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("editor object", sizeof(*this));
+    responseCurveComponent.addToMemoryFootprint(footprint);
+    footprint.add(MemoryFootprint::sharedTables, SharedTables::getLiveTableBytes());
+    return footprint;
 }
 
 //==============================================================================
@@ -639,6 +1046,9 @@ void SimpleEQAudioProcessorEditor::resized()
     analyzerEnabledArea.removeFromTop(2);
 
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
+    analyzerSmoothingBox.setBounds(analyzerEnabledArea.withX(analyzerEnabledArea.getRight() + 5).withWidth(90));
+    loadButton.setBounds(analyzerEnabledArea.withX(getWidth() - 5 - 60).withWidth(60));
+    measureButton.setBounds(loadButton.getBounds().translated(-65, 0));
 
     bounds.removeFromTop(5);
 
@@ -648,6 +1058,7 @@ void SimpleEQAudioProcessorEditor::resized()
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
 
     responseCurveComponent.setBounds(responseArea);
+    loadOverlay.setBounds(responseArea.reduced(24, 16).removeFromRight(230).removeFromTop(72));
     bounds.removeFromTop(5);
 
     auto loCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
@@ -682,6 +1093,9 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
         &locutBypassButton,
         &peakBypassButton,
         &hicutBypassButton,
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+        &analyzerSmoothingBox,
+        &loadButton,
+        &measureButton
     };
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "PluginProcessor.h"
+#include "FFTBackend.h"
+#include "SharedTables.h"
+#include "SpectrumSmoother.h"
 
 enum FFTOrder
 {
@@ -9,25 +12,39 @@ enum FFTOrder
     order8192 = 13
 };
 
+// PathProducer::process() drains the FFT data and path FIFOs in the same call that fills them, and
+// only the newest entry is ever drawn, so two entries per FIFO are plenty
+constexpr int analyzerFifoCapacity = 2;
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
+    /*
+     Frames wait in the FIFO as the fftSize / 2 meaningful bins only, each a level in 1/256 dB
+     steps: 16 bits cover -128 to +128 dB far more finely than a pixel, at a quarter of the size of
+     the float spectrum.  getFFTData() expands a frame back to floats.
+     */
+    using Frame = std::vector<int16_t>;
+    static constexpr float frameStepsPerDecibel = 256.f;
+    static constexpr float frameFloorDecibels = -128.f;
+
     /**
      produces the FFT data from an audio buffer.
      */
     void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
     {
+        SIMPLEEQ_ZONE_NAMED("FFTDataGenerator::produceFFTDataForRendering");
+
         const auto fftSize = getFFTSize();
         
-        fftData.assign(fftData.size(), 0);
         auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        std::copy(readIndex, readIndex + fftSize, windowed.begin());
         
         // first apply a windowing function to our data
-        window->multiplyWithWindowingTable (fftData.data(), fftSize);       // [1]
+        juce::FloatVectorOperations::multiply(windowed.data(), window->data(), fftSize);    // [1]
         
         // then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform (fftData.data());  // [2]
+        backend->performMagnitudes (windowed.data(), fftData.data());       // [2]
         
         int numBins = (int)fftSize / 2;
         
@@ -47,63 +64,113 @@ struct FFTDataGenerator
             fftData[i] = v;
         }
         
-        //convert them to decibels
+        //convert them to decibels.  Power is only floored at the frame's own floor, because
+        //SpectrumSmoother averages it first and applies negativeInfinity per column
+        const auto floor = producesPower ? frameFloorDecibels : juce::jmax(frameFloorDecibels, negativeInfinity);
         for( int i = 0; i < numBins; ++i )
         {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            const auto steps = juce::roundToInt(juce::Decibels::gainToDecibels(fftData[i], floor) * frameStepsPerDecibel);
+            frame[i] = (int16_t)juce::jlimit(-32768, 32767, steps);
         }
         
-        fftDataFifo.push(fftData);
+        fftDataFifo.push(frame);
     }
     
     void changeOrder(FFTOrder newOrder)
     {
-        //when you change order, recreate the window, forwardFFT, fifo, fftData
+        //when you change order, recreate the backend, fifo, fftData and fetch the window
         //also reset the fifoIndex
-        //things that need recreating should be created on the heap via std::make_unique<>
+        //the window and the backend's plan are shared with every other generator of the same order
         
         order = newOrder;
         auto fftSize = getFFTSize();
         
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        backend = FFTBackend::create(backendType, order);
+        window = SharedTables::getBlackmanHarrisWindow(fftSize);
         
+        windowed.assign(fftSize, 0);
         fftData.clear();
-        fftData.resize(fftSize * 2, 0);
+        fftData.resize(backend->getNumBins(), 0);
+        frame.assign(fftSize / 2, 0);
+        pulledFrame.assign(fftSize / 2, 0);
 
-        fftDataFifo.prepare(fftData.size());
+        // only the newest spectrum is ever drawn
+        fftDataFifo.setOverflowPolicy(OverwriteOldest);
+        fftDataFifo.prepare(frame.size(), analyzerFifoCapacity);
+    }
+    
+    void changeBackend(FFTBackendType newType)
+    {
+        //same size and layout, so the window, fifo and fftData stay as they are
+        backendType = newType;
+        backend = FFTBackend::create(backendType, order);
     }
+    
+    // power instead of dB; set it before producing the blocks it applies to, and keep it until they are pulled
+    void setProducesPower(bool shouldProducePower) { producesPower = shouldProducePower; }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
+    FFTBackendType getBackendType() const { return backendType; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
-    bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    // fftSize / 2 values, dB or power
+    bool getFFTData(BlockType& data)
+    {
+        if( ! fftDataFifo.pull(pulledFrame) )
+            return false;
+
+        data.resize(pulledFrame.size());
+        for( size_t i = 0; i < pulledFrame.size(); ++i )
+        {
+            const auto decibels = (float)pulledFrame[i] / frameStepsPerDecibel;
+            data[i] = producesPower ? std::pow(10.f, 0.1f * decibels) : decibels;
+        }
+
+        return true;
+    }
+    int getNumOverwrittenFFTDataBlocks() const { return fftDataFifo.getNumOverwritten(); }
+
+    size_t getHeapSizeInBytes() const
+    {
+        return ::getHeapSizeInBytes(windowed) + ::getHeapSizeInBytes(fftData)
+             + ::getHeapSizeInBytes(frame) + ::getHeapSizeInBytes(pulledFrame)
+             + (backend != nullptr ? backend->getHeapSizeInBytes() : 0)
+             + fftDataFifo.getHeapSizeInBytes();
+    }
 private:
     FFTOrder order;
-    BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    FFTBackendType backendType = FFTBackend::defaultType;
+    bool producesPower = false;
+    BlockType windowed, fftData;
+    Frame frame, pulledFrame;
+    std::unique_ptr<FFTBackend> backend;
+    std::shared_ptr<const std::vector<float>> window;
     
-    Fifo<BlockType> fftDataFifo;
+    Fifo<Frame> fftDataFifo;
 };
 
 template<typename PathType>
 struct AnalyzerPathGenerator
 {
+    // only the newest path is ever drawn
+    AnalyzerPathGenerator()
+    {
+        pathFifo.setCapacity(analyzerFifoCapacity);
+        pathFifo.setOverflowPolicy(OverwriteOldest);
+    }
+
     /*
-     converts 'renderData[]' into a juce::Path
+     converts 'renderData[]' into a juce::Path, drawing each bin at the column 'binPixels' maps it to
      */
     void generatePath(const std::vector<float>& renderData,
                       juce::Rectangle<float> fftBounds,
-                      int fftSize,
-                      float binWidth,
+                      const SharedTables::BinPixelMap& binPixels,
                       float negativeInfinity)
     {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
 
-        int numBins = (int)fftSize / 2;
+        int numBins = (int)binPixels.x.size();
 
         PathType p;
         p.preallocateSpace(3 * (int)fftBounds.getWidth());
@@ -133,16 +200,47 @@ struct AnalyzerPathGenerator
 
             if( !std::isnan(y) && !std::isinf(y) )
             {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                p.lineTo(binPixels.x[(size_t)binNum], y);
             }
         }
 
         pathFifo.push(p);
     }
 
+    /*
+     converts one value per display column, evenly spaced across the width (SpectrumSmoother's
+     output), into a juce::Path
+     */
+    void generateColumnPath(const std::vector<float>& columnData,
+                            juce::Rectangle<float> fftBounds,
+                            float negativeInfinity)
+    {
+        auto top = fftBounds.getY();
+        auto bottom = fftBounds.getHeight();
+        auto width = fftBounds.getWidth();
+
+        const auto numColumns = (int)columnData.size();
+        if( numColumns < 2 )
+            return;
+
+        PathType p;
+        p.preallocateSpace(3 * numColumns);
+
+        auto map = [bottom, top, negativeInfinity](float v)
+        {
+            return juce::jmap(v,
+                              negativeInfinity, 0.f,
+                              float(bottom+10),   top);
+        };
+
+        p.startNewSubPath(0, map(columnData[0]));
+
+        for( int column = 1; column < numColumns; ++column )
+            p.lineTo(column * width / float(numColumns - 1), map(columnData[column]));
+
+        pathFifo.push(p);
+    }
+
     int getNumPathsAvailable() const
     {
         return pathFifo.getNumAvailableForReading();
@@ -152,13 +250,21 @@ struct AnalyzerPathGenerator
     {
         return pathFifo.pull(path);
     }
+
+    int getNumOverwrittenPaths() const { return pathFifo.getNumOverwritten(); }
+
+    // the slots; a path's own points are JUCE's business and aren't counted
+    size_t getHeapSizeInBytes() const { return pathFifo.getHeapSizeInBytes(); }
 private:
     Fifo<PathType> pathFifo;
 };
 
 
+struct LabeledRotarySlider;
+
 struct LookAndFeel : juce::LookAndFeel_V4
 {
+    // the face, then the pointer and readout; LabeledRotarySlider draws the two halves itself
     void drawRotarySlider (juce::Graphics&, 
                         int x, int y, int width, int height,
                         float sliderPosProportional, 
@@ -166,6 +272,12 @@ struct LookAndFeel : juce::LookAndFeel_V4
                         float rotaryEndAngle, 
                         juce::Slider&) override;
 
+    // the part of a knob that doesn't move with its value
+    void drawRotarySliderFace(juce::Graphics&, juce::Rectangle<float> bounds, bool enabled);
+
+    // the part that does: the pointer at 'angle' and the value readout
+    void drawRotarySliderPointer(juce::Graphics&, juce::Rectangle<float> bounds, float angle, LabeledRotarySlider&);
+
     void drawToggleButton (juce::Graphics &g,
                         juce::ToggleButton & toggleButton,
                         bool shouldDrawButtonAsHighlighted,
@@ -208,6 +320,15 @@ struct LabeledRotarySlider : juce::Slider
         juce::RangedAudioParameter* param;
         juce::String suffix;
 
+        // The face and the range labels only change with the size, the display's scale and
+        // whether the slider is enabled, so they are drawn once into a sprite at the physical
+        // resolution; a value change only redraws the pointer and the readout over it.
+        juce::Image faceSprite;
+        float faceScale = 0.f;
+        bool faceEnabled = false;
+
+        void renderFaceSprite(float scale, float startAngle, float endAngle);
+
 };
 
 struct PathProducer
@@ -218,8 +339,23 @@ struct PathProducer
         leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
         monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
     }
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
+    // true when a new path is ready for getPath()
+    bool process(juce::Rectangle<float> fftBounds, double sampleRate);
     juce::Path getPath() { return leftChannelFFTPath; }
+    void setFFTBackend(FFTBackendType type) { leftChannelFFTDataGenerator.changeBackend(type); }
+    void setSmoothing(AnalyzerSmoothing newSmoothing) { smoothing = newSmoothing; }
+    size_t getHeapSizeInBytes() const;
+
+    // empties the FIFO without analysing it, while the analyzer is off
+    void discard();
+
+    // where the last process() spent its time
+    struct Timings
+    {
+        double fifoDrainMilliseconds = 0.0, fftMilliseconds = 0.0, pathMilliseconds = 0.0;
+    };
+
+    const Timings& getTimings() const { return timings; }
     private:
     SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType> *leftChannelFifo;
 
@@ -229,7 +365,16 @@ struct PathProducer
 
     AnalyzerPathGenerator<juce::Path> pathProducer;
 
+    AnalyzerSmoothing smoothing = SmoothingOff;
+    SpectrumSmoother smoother;
+    std::vector<float> smoothedColumns;
+    std::vector<float> fftData;
+
+    std::shared_ptr<const SharedTables::BinPixelMap> binPixels;
+
     juce::Path leftChannelFFTPath;
+
+    Timings timings;
 };
 
 struct ResponseCurveComponent: juce::Component,
@@ -246,25 +391,110 @@ juce::Timer
 
     void resized() override;
 
+    // message thread cost of the most recent timerCallback() and paint()
+    double getTimerCallbackMilliseconds() const { return timerCallbackMilliseconds; }
+    double getPaintMilliseconds() const { return paintMilliseconds; }
+
+    // the analyzer's share of the most recent timerCallback(), both channels summed
+    PathProducer::Timings getAnalyzerTimings() const;
+
+    // the cached layers and both analyzers
+    void addToMemoryFootprint(MemoryFootprint& footprint) const;
+
     private:
         SimpleEQAudioProcessor& processorRef;
 
         // Because Listeners MUST be very fast and avoid blocking, we define an atomic flag for signalling
         juce::Atomic<bool> parametersChanged { false };
-        MonoChain monoChain;
+        StereoChainSnapshot chainSnapshot;     // channels[1] is drawn too unless linked
 
         void updateChain();
 
-        juce::Image background;
+        /*
+         paint() composites three cached layers, each redrawn only when what it shows changes:
+
+            background:  grid and labels, on resize
+            analyzer:    both spectra, when a new path arrives
+            curves:      the response curves, the measured response and the border, when the
+                         parameters or the measurement change
+
+         They are rendered at the display's scale, so compositing them is a plain blit, and the
+         timer only asks for a repaint when one of them is dirty.
+
+         While the editor is being resized the layers keep layerBounds, the last settled size, and
+         are stretched to the component; once no resize has come for resizeSettleSeconds, settleSize()
+         takes the new size, rebuilds the per-width tables and redraws the layers at full resolution.
+         */
+        juce::Image background, analyzerLayer, curveLayer;
+        juce::Rectangle<int> layerBounds;
+        float layerScale = 0.f;
+
+        static constexpr double resizeSettleSeconds = 0.15;
+        juce::int64 resizeSettleTicks = 0;      // when a pending size settles, 0 when none is pending
+
+        void settleSize();
+        bool backgroundDirty = true, analyzerLayerDirty = true, curveLayerDirty = true;
+
+        // follows "Analyzer Enabled"; while it's off the FIFOs are only emptied and the analyzer layer isn't drawn
+        bool analyzerEnabled = true;
+
+        void renderBackground();
+        void renderAnalyzer();
+        void renderCurves();
+
+        // the frequency drawn at each column of the analysis area, shared by every editor as wide
+        std::shared_ptr<const std::vector<double>> pixelFrequencies;
 
         juce::Rectangle<int> getRenderArea();
         juce::Rectangle<int> getAnalysisArea();
 
         PathProducer leftPathProducer, rightPathProducer;
+
+        // the latest measured response, drawn over the theoretical curve while measuring
+        TransferFunctionResponse measuredResponse;
+
+        double timerCallbackMilliseconds = 0.0, paintMilliseconds = 0.0;
+};
+
+/*
+ Shows what this instance costs: processBlock's share of the block budget (the last block and the
+ worst since the telemetry was reset), how full the analyzer FIFOs are, how many buffers they have
+ dropped or overwritten, and the response curve's own message thread cost.
+
+ Everything is polled from the processor's atomics while the overlay is visible; when it's hidden
+ its timer is stopped and it costs nothing.  Double-click to reset the peak.
+ */
+struct LoadOverlay : juce::Component, juce::Timer
+{
+    LoadOverlay(SimpleEQAudioProcessor&, const ResponseCurveComponent&);
+
+    void paint(juce::Graphics& g) override;
+    void timerCallback() override;
+    void visibilityChanged() override;
+    void mouseDoubleClick(const juce::MouseEvent&) override;
+
+    private:
+        SimpleEQAudioProcessor& processorRef;
+        const ResponseCurveComponent& responseCurve;
+
+        double currentLoad = 0.0, peakLoad = 0.0;
+        int leftFifoFill = 0, rightFifoFill = 0, fifoCapacity = 0, droppedBuffers = 0, overwrittenBuffers = 0;
+        double timerCallbackMilliseconds = 0.0, paintMilliseconds = 0.0;
 };
 
 //==============================================================================
 struct PowerButton : juce::ToggleButton { };
+struct LoadButton : juce::ToggleButton { };
+struct MeasureButton : juce::ToggleButton { };
+
+// lists the choices itself, so they exist before the ComboBoxAttachment selects one
+struct AnalyzerSmoothingBox : juce::ComboBox
+{
+    explicit AnalyzerSmoothingBox(juce::RangedAudioParameter& rap)
+    {
+        addItemList(rap.getAllValueStrings(), 1);
+    }
+};
 struct AnalyzerButton : juce::ToggleButton
 {
     void resized() override
@@ -297,6 +527,12 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // Message thread.  What this editor holds on top of its processor, by subsystem.
+    MemoryFootprint getMemoryFootprint() const;
+
+    // for EditorRenderBenchmark, which drives the curve's timer itself
+    ResponseCurveComponent& getResponseCurve() { return responseCurveComponent; }
+
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -311,6 +547,7 @@ private:
                         hiCutSlopeSlider;
 
     ResponseCurveComponent responseCurveComponent;
+    LoadOverlay loadOverlay;
 
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
@@ -325,6 +562,9 @@ private:
 
     PowerButton locutBypassButton, peakBypassButton, hicutBypassButton;
     AnalyzerButton analyzerEnabledButton;
+    AnalyzerSmoothingBox analyzerSmoothingBox;
+    LoadButton loadButton;
+    MeasureButton measureButton;
     
     using ButtonAttachment = APVTS::ButtonAttachment;
     ButtonAttachment locutBypassButtonAttachment,
@@ -332,6 +572,8 @@ private:
                      hicutBypassButtonAttachment,
                      analyzerEnabledButtonAttachment;
 
+    APVTS::ComboBoxAttachment analyzerSmoothingBoxAttachment;
+
     std::vector<juce::Component*> getComps();
 
     LookAndFeel laf;
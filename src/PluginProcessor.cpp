@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "SharedTables.h"
 
 #define JucePlugin_Name "SimpleEQ"
 
@@ -11,13 +12,31 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
 #endif
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+#endif
+#if !JucePlugin_IsMidiEffect && !JucePlugin_IsSynth
+                         .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
 #endif
       )
 {
+    for( auto* param : getParameters() )
+    {
+        param->addListener(this);
+
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(param);
+        jassert(ranged != nullptr);
+        stateParameters.push_back(ranged);
+        stateValues.push_back(apvts.getRawParameterValue(ranged->getParameterID()));
+    }
+
+    startTimerHz(100);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    stopTimer();
+
+    for( auto* param : getParameters() )
+        param->removeListener(this);
 }
 
 //==============================================================================
@@ -130,14 +149,58 @@ void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
     spec.numChannels = 1;
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    // the whole filter bank lives in one arena, (re)allocated here and never on the audio thread
+    auto prepareEngines = [&](auto& engines)
+    {
+        engines.biquads.prepare(getTotalNumOutputChannels(), samplesPerBlock);
+        engines.biquads.reset();
+        engines.svfs.prepare(sampleRate, getTotalNumOutputChannels());
+        engines.dynamicPeak.prepare(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
+    };
+
+    if( isUsingDoublePrecision() )
+        prepareEngines(doubleEngines);
+    else
+        prepareEngines(floatEngines);
+
+    // plugin wrappers do this before calling us, but tests and benchmarks drive prepareToPlay directly
+    setRateAndBufferSizeDetails(sampleRate, samplesPerBlock);
+
+    {
+        const juce::ScopedLock sl(publishLock);
+        linearPhase.prepare(sampleRate, getTotalNumOutputChannels(), LinearPhaseFilter::getFirOrderForSampleRate(sampleRate));
+    }
+
+    // the sample rate may have changed, so design now; nothing is processing while we're in here,
+    // which makes it safe to take the reader's side of the hand-off too
+    publishChainSnapshot();
+    chainSnapshots.acquireLatest();
+
+    if( isUsingDoublePrecision() )
+        adoptChainSnapshot(doubleEngines, chainSnapshots.getReadBuffer());
+    else
+        adoptChainSnapshot(floatEngines, chainSnapshots.getReadBuffer());
 
-    updateFilters();
+    setLatencySamples(latencyToReport.get());
+
+    // settle the SVF smoothers on the current parameters rather than gliding in from defaults
+    floatEngines.svfs.reset();
+    doubleEngines.svfs.reset();
     
 
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    // a fixed window of audio whatever the host's block size; when the GUI falls behind, the
+    // analyzer would rather lose the oldest audio than the newest
+    const auto analyzerCapacity = SingleChannelSampleFifo<BlockType>::getCapacityForWindow(analyzerWindowSeconds,
+                                                                                         sampleRate,
+                                                                                         samplesPerBlock);
+    for( auto* fifo : { &leftChannelFifo, &rightChannelFifo } )
+    {
+        fifo->setOverflowPolicy(OverwriteOldest);
+        fifo->prepare(samplesPerBlock, analyzerCapacity);
+    }
+
+    // the linear-phase engine delays the output, so the measured input has to wait as long
+    measurement.prepare(sampleRate, samplesPerBlock, linearPhase.getLatencySamples());
 
     osc.initialise([](float x) { return std::sin(x);});
     spec.numChannels = getTotalNumOutputChannels();
@@ -169,6 +232,16 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts)
 #if !JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // the dynamic peak's sidechain is optional, and a mono key is used for both channels
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+        if (! sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
 #endif
 
     return true;
@@ -179,7 +252,23 @@ void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                              juce::MidiBuffer &midiMessages)
 {
     juce::ignoreUnused(midiMessages);
+    processBlockImpl(buffer, floatEngines);
+}
+
+void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<double> &buffer,
+                                             juce::MidiBuffer &midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processBlockImpl(buffer, doubleEngines);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processBlockImpl(juce::AudioBuffer<SampleType> &buffer,
+                                              FilterEngines<SampleType>& engines)
+{
+    SIMPLEEQ_ZONE_NAMED("processBlock");
 
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -193,32 +282,82 @@ void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
+    // the host switched precision without calling prepareToPlay again
+    if( ! engines.isPrepared() )
+    {
+        jassertfalse;
+        return;
+    }
 
-    updateFilters();
+    // offline renders may not give the message thread a chance to run between blocks,
+    // and they have no deadline, so design inline there
+    if( isNonRealtime() && chainSettingsChanged.compareAndSetBool(false, true) )
+        publishChainSnapshot();
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    if( chainSnapshots.acquireLatest() )
+    {
+        adoptChainSnapshot(engines, chainSnapshots.getReadBuffer());
+        telemetry.recordSnapshotAdopted();
+    }
 
-    // buffer.clear();
-    // juce::dsp::ProcessContextReplacing<float> stereoContext(block);
-    // osc.process(stereoContext);
+    measurement.captureInput(buffer, engines.active == FilterEngine::LinearPhaseEngine ? linearPhase.getLatencySamples() : 0);
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-    
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    // the sidechain's channels follow the main bus's in the buffer; only the main bus is filtered
+    juce::dsp::AudioBlock<SampleType> block = juce::dsp::AudioBlock<SampleType>(buffer)
+                                                  .getSubsetChannelBlock(0, (size_t)totalNumOutputChannels);
+
+    if( engines.active == FilterEngine::LinearPhaseEngine )
+    {
+        const auto start = readCycleCounter();
+        linearPhase.process(block);
+        telemetry.recordStageCycles(ProcessorTelemetry::LinearPhaseStage, readCycleCounter() - start);
+    }
+    else if( engines.active == FilterEngine::SvfEngine )
+    {
+        const auto start = readCycleCounter();
+        engines.svfs.process(block);
+        telemetry.recordStageCycles(ProcessorTelemetry::SvfChainStage, readCycleCounter() - start);
+    }
+    else
+    {
+        using Bank = FilterBank<SampleType>;
+        typename Bank::StageCycles stageCycles {};
+        engines.biquads.process(block, &stageCycles);
+
+        telemetry.recordStageCycles(ProcessorTelemetry::LowCutStage, stageCycles[Bank::LowCutStage]);
+        telemetry.recordStageCycles(ProcessorTelemetry::PeakStage, stageCycles[Bank::PeakStage]);
+        telemetry.recordStageCycles(ProcessorTelemetry::BandsStage, stageCycles[Bank::BandsStage]);
+        telemetry.recordStageCycles(ProcessorTelemetry::HighCutStage, stageCycles[Bank::HiCutStage]);
+    }
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if( engines.dynamicPeak.isActive() )
+    {
+        const auto start = readCycleCounter();
+        const auto wantsSidechain = chainSnapshots.getReadBuffer().channels[0].settings.dynamicSource == DynamicSource::DetectSidechain;
+
+        if( wantsSidechain && getBusCount(true) > 1 && getChannelCountOfBus(true, 1) > 0 )
+        {
+            auto sidechainBus = getBusBuffer(buffer, true, 1);
+            const juce::dsp::AudioBlock<SampleType> sidechain(sidechainBus);
+            engines.dynamicPeak.process(block, &sidechain);
+        }
+        else
+        {
+            engines.dynamicPeak.process(block);
+        }
+
+        telemetry.recordStageCycles(ProcessorTelemetry::DynamicPeakStage, readCycleCounter() - start);
+    }
 
+    const auto tapStart = readCycleCounter();
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
+    measurement.captureOutput(buffer);
+    telemetry.recordStageCycles(ProcessorTelemetry::AnalyzerTapStage, readCycleCounter() - tapStart);
+
+    const auto elapsedTicks = juce::Time::getHighResolutionTicks() - blockStartTicks;
+    telemetry.recordBlock(juce::Time::highResolutionTicksToSeconds(elapsedTicks),
+                          buffer.getNumSamples() / getSampleRate());
 }
 
 //==============================================================================
@@ -236,69 +375,149 @@ juce::AudioProcessorEditor *SimpleEQAudioProcessor::createEditor()
 //==============================================================================
 void SimpleEQAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-
-    // Currently used to restore Parameter values between launches of this plugin
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    // hosts call this for every autosave and undo step, sometimes from several threads at once, so
+    // the values are copied straight into destData with nothing shared on the way
+    auto* values = BinaryState::writeHeader((int)stateValues.size(), destData);
+    for( size_t i = 0; i < stateValues.size(); ++i )
+        values[i] = stateValues[i]->load();
 }
 
 void SimpleEQAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // local, since a host may save from another thread while this restores
+    std::vector<float> values(stateParameters.size());
+    const auto numValues = BinaryState::read(data, (size_t)juce::jmax(0, sizeInBytes), values.data(), (int)values.size());
+    if( numValues >= 0 )
+    {
+        setParameterValues(values.data(), numValues);
+        return;
+    }
+
+    // sessions saved before the binary format: the ValueTree the APVTS wrote
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if( tree.isValid() )
     {
         apvts.replaceState(tree);
-        updateFilters();
+        chainSettingsChanged.set(false);
+        publishChainSnapshot();
+    }
+}
+
+void SimpleEQAudioProcessor::getParameterValues(std::vector<float>& values) const
+{
+    values.resize(stateValues.size());
+    for( size_t i = 0; i < stateValues.size(); ++i )
+        values[i] = stateValues[i]->load();
+}
+
+void SimpleEQAudioProcessor::setParameterValues(const float* values, int numValues)
+{
+    for( size_t i = 0; i < stateParameters.size(); ++i )
+    {
+        // states and banks come from files; a value that isn't a number leaves its parameter alone,
+        // and convertTo0to1() clamps anything out of range
+        if( (int)i < numValues && ! std::isfinite(values[i]) )
+            continue;
+
+        auto* param = stateParameters[i];
+        const auto normalised = (int)i < numValues ? param->convertTo0to1(values[i]) : param->getDefaultValue();
+
+        // most of a recalled state is usually what is already set, and every set notifies the host
+        if( normalised != param->getValue() )
+            param->setValueNotifyingHost(normalised);
     }
+
+    chainSettingsChanged.set(false);
+    publishChainSnapshot();
+}
+
+bool SimpleEQAudioProcessor::openPresetBank(const juce::File& file)
+{
+    return presetBank.open(file);
+}
+
+bool SimpleEQAudioProcessor::recallPreset(int index)
+{
+    const auto* values = presetBank.getValues(index);
+    if( values == nullptr )
+        return false;
+
+    setParameterValues(values, presetBank.getNumValues());
+    return true;
+}
+
+MemoryFootprint SimpleEQAudioProcessor::getMemoryFootprint() const
+{
+    MemoryFootprint footprint;
+    footprint.add("processor object", sizeof(*this));
+    footprint.add("filter engines", floatEngines.getHeapSizeInBytes() + doubleEngines.getHeapSizeInBytes());
+    footprint.add("linear phase", linearPhase.getHeapSizeInBytes());
+    footprint.add("analyzer FIFOs", leftChannelFifo.getHeapSizeInBytes() + rightChannelFifo.getHeapSizeInBytes());
+    footprint.add("measurement", measurement.getHeapSizeInBytes());
+    footprint.add("state", stateParameters.capacity() * sizeof(juce::RangedAudioParameter*)
+                           + stateValues.capacity() * sizeof(std::atomic<float>*));
+    footprint.add(MemoryFootprint::sharedTables, SharedTables::getLiveTableBytes());
+    return footprint;
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int channel)
 {
     ChainSettings settings;
     // can't do this now because apvts expects raw parameter values, not normalized values
     // apvts.getParameter("LowCut Freq")->getValue();
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LoCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HiCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LoCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HiCut Slope")->load());
-
-    settings.loCutBypassed = apvts.getRawParameterValue("LowCut Bypassed")->load() > 0.5f;
-    settings.peakBypassed = apvts.getRawParameterValue("Peak Bypassed")->load() > 0.5f;
-    settings.hiCutBypassed = apvts.getRawParameterValue("HighCut Bypassed")->load() > 0.5f;
+    const auto load = [&apvts, channel](const juce::String& id) { return apvts.getRawParameterValue(getChannelParameterID(channel, id))->load(); };
+
+    settings.lowCutFreq = load("LoCut Freq");
+    settings.highCutFreq = load("HiCut Freq");
+    settings.peakFreq = load("Peak Freq");
+    settings.peakGainInDecibels = load("Peak Gain");
+    settings.peakQuality = load("Peak Quality");
+    settings.lowCutSlope = static_cast<Slope>(load("LoCut Slope"));
+    settings.highCutSlope = static_cast<Slope>(load("HiCut Slope"));
+
+    settings.loCutBypassed = load("LowCut Bypassed") > 0.5f;
+    settings.peakBypassed = load("Peak Bypassed") > 0.5f;
+    settings.hiCutBypassed = load("HighCut Bypassed") > 0.5f;
+
+    settings.engine = static_cast<FilterEngine>(apvts.getRawParameterValue("Filter Engine")->load());
+
+    // the dynamic peak's detector and gain are shared by both channels, so it only runs linked
+    settings.peakDynamic = apvts.getRawParameterValue("Peak Dynamic")->load() > 0.5f && getChannelMode(apvts) == LinkedStereo;
+    settings.dynamicThreshold = apvts.getRawParameterValue("Dynamic Threshold")->load();
+    settings.dynamicRatio = apvts.getRawParameterValue("Dynamic Ratio")->load();
+    settings.dynamicAttackMs = apvts.getRawParameterValue("Dynamic Attack")->load();
+    settings.dynamicReleaseMs = apvts.getRawParameterValue("Dynamic Release")->load();
+    settings.dynamicSource = static_cast<DynamicSource>(apvts.getRawParameterValue("Dynamic Source")->load());
+
+    auto& bands = settings.bands;
+    bands.numBands = (int)load("Band Count");
+    for( int band = 0; band < BandTable::maxBands; ++band )
+    {
+        const auto b = (size_t)band;
+        bands.type[b] = static_cast<BandType>(apvts.getRawParameterValue(getBandParameterID(band, "Type", channel))->load());
+        bands.freq[b] = apvts.getRawParameterValue(getBandParameterID(band, "Freq", channel))->load();
+        bands.gainInDecibels[b] = apvts.getRawParameterValue(getBandParameterID(band, "Gain", channel))->load();
+        bands.quality[b] = apvts.getRawParameterValue(getBandParameterID(band, "Quality", channel))->load();
+        bands.bypassed[b] = apvts.getRawParameterValue(getBandParameterID(band, "Bypassed", channel))->load() > 0.5f;
+    }
 
     return settings;
 }
 
-Coefficients makePeakFilter( const ChainSettings& chainSettings, double sampleRate)
+ChannelMode getChannelMode(juce::AudioProcessorValueTreeState& apvts)
 {
-    // reference-counted wrapper around an array on the heap
-    // we want to copy its value here so we must de-reference it
-    // referencing the heap in an Audio program is bad design but here we are
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.peakFreq,
-                                                               chainSettings.peakQuality,
-                                                               juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
-
+    return static_cast<ChannelMode>(apvts.getRawParameterValue("Channel Mode")->load());
 }
 
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings)
+juce::String getChannelParameterID(int channel, const juce::String& id)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
-
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+    return channel == 0 ? id : "Ch2 " + id;
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+juce::String getBandParameterID(int band, const char* name, int channel)
+{
+    return getChannelParameterID(channel, "Band " + juce::String(band + 1) + " " + name);
 }
 
 void updateCoefficients(Coefficients &old, const Coefficients &replacements)
@@ -306,67 +525,103 @@ void updateCoefficients(Coefficients &old, const Coefficients &replacements)
     *old = *replacements;
 }
 
-void SimpleEQAudioProcessor::updateLoCutFilters(const ChainSettings& chainSettings)
+template<typename SampleType>
+void SimpleEQAudioProcessor::adoptChainSnapshot(FilterEngines<SampleType>& engines, const StereoChainSnapshot& snapshot)
 {
-    auto cutCoefficients = makeLoCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    SIMPLEEQ_ZONE;
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.loCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.loCutBypassed);
-    
-    updateCutFilter(rightLowCut,cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(leftLowCut,cutCoefficients,chainSettings.lowCutSlope);
+    if( ! engines.isPrepared() )
+        return;
+
+    if( engines.adopt(snapshot) )
+        linearPhase.reset();
+}
+
+void SimpleEQAudioProcessor::publishChainSnapshot()
+{
+    SIMPLEEQ_ZONE;
+
+    const juce::ScopedLock sl(publishLock);
+
+    // nothing sensible to design until the host has told us the sample rate
+    if( getSampleRate() <= 0.0 )
+        return;
+
+    auto& snapshot = chainSnapshots.getWriteBuffer();
+    const auto mode = getChannelMode(apvts);
+    snapshot = designStereoChainSnapshot(mode, { getChainSettings(apvts, 0), getChainSettings(apvts, 1) },
+                                         getSampleRate(), &latestChainSnapshot);
+    snapshot.version = nextSnapshotVersion++;
+
+    // analyzer toggles and a linked Ch2 republish without designing anything
+    if( snapshot.designedChannelMask != 0 )
+        telemetry.recordRedesign();
+
+    // queued before the snapshot that selects it, so the audio thread never runs without a kernel
+    const auto linearPhaseActive = snapshot.channels[0].settings.engine == FilterEngine::LinearPhaseEngine && linearPhase.isPrepared();
+    if( linearPhaseActive )
+        linearPhase.designKernel(snapshot);
+
+    latencyToReport.set(linearPhaseActive ? linearPhase.getLatencySamples() : 0);
+
+    latestChainSnapshot = snapshot;
+    chainSnapshots.publish();
 }
 
-void SimpleEQAudioProcessor::updateHiCutFilters(const ChainSettings& chainSettings)
+StereoChainSnapshot SimpleEQAudioProcessor::getLatestStereoChainSnapshot()
 {
-    auto hiCutCoefficients = makeHiCutFilter(chainSettings, getSampleRate());
-    auto& leftHiCut = leftChain.get<ChainPositions::HiCut>();
-    auto& rightHiCut = rightChain.get<ChainPositions::HiCut>();
+    if( chainSettingsChanged.compareAndSetBool(false, true) )
+        publishChainSnapshot();
 
-    leftChain.setBypassed<ChainPositions::HiCut>(chainSettings.hiCutBypassed);
-    rightChain.setBypassed<ChainPositions::HiCut>(chainSettings.hiCutBypassed);
+    const juce::ScopedLock sl(publishLock);
+    return latestChainSnapshot;
+}
 
-    updateCutFilter(leftHiCut, hiCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHiCut, hiCutCoefficients, chainSettings.highCutSlope);
+void SimpleEQAudioProcessor::parameterValueChanged(int parameterIndex, float newValue)
+{
+    juce::ignoreUnused(parameterIndex, newValue);
+    chainSettingsChanged.set(true);
 }
 
-void SimpleEQAudioProcessor::updateFilters(void)
+void SimpleEQAudioProcessor::timerCallback()
 {
-    auto chainSettings = getChainSettings(apvts);
-    updateLoCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHiCutFilters(chainSettings);
+    if( chainSettingsChanged.compareAndSetBool(false, true) )
+        publishChainSnapshot();
+
+    // hosts expect latency changes from the message thread, not from offline renders' designs
+    if( latencyToReport.get() != getLatencySamples() )
+        setLatencySamples(latencyToReport.get());
 }
 
-juce::AudioProcessorValueTreeState::ParameterLayout
-    SimpleEQAudioProcessor::createParameterLayout()
+namespace
 {
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+// the cut and peak parameters one channel's chain is drawn from
+void addFilterParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, int channel)
+{
+    const auto id = [channel](const char* name) { return getChannelParameterID(channel, name); };
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LoCut Freq",
-                                                           "LoCut Freq",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(id("LoCut Freq"),
+                                                           id("LoCut Freq"),
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
                                                            20.f));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HiCut Freq",
-                                                           "HiCut Freq",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(id("HiCut Freq"),
+                                                           id("HiCut Freq"),
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
                                                            20000.f));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq",
-                                                           "Peak Freq",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Freq"),
+                                                           id("Peak Freq"),
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
                                                            750.f));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain",
-                                                           "Peak Gain",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Gain"),
+                                                           id("Peak Gain"),
                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
                                                            0.0f));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality",
-                                                           "Peak Quality",
+    layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Quality"),
+                                                           id("Peak Quality"),
                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
                                                            1.f));
                                                            
@@ -379,13 +634,110 @@ juce::AudioProcessorValueTreeState::ParameterLayout
         stringArray.add(str);
     }
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LoCut Slope", "LoCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HiCut Slope", "HiCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(id("LoCut Slope"), id("LoCut Slope"), stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(id("HiCut Slope"), id("HiCut Slope"), stringArray, 0));
     
-    layout.add(std::make_unique<juce::AudioParameterBool>("LowCut Bypassed", "LowCut Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Bypassed", "Peak Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(id("LowCut Bypassed"), id("LowCut Bypassed"), false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(id("Peak Bypassed"), id("Peak Bypassed"), false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(id("HighCut Bypassed"), id("HighCut Bypassed"), false));
+}
+
+void addBandParameters(juce::AudioProcessorValueTreeState::ParameterLayout& layout, int channel)
+{
+    // every band exists as parameters so hosts see a fixed set; Band Count decides how many are used
+    const auto countID = getChannelParameterID(channel, "Band Count");
+    layout.add(std::make_unique<juce::AudioParameterInt>(countID, countID, 0, BandTable::maxBands, 0));
+
+    for( int band = 0; band < BandTable::maxBands; ++band )
+    {
+        // log-spaced from 50 Hz to 20 kHz, so a newly added band doesn't land on top of the last
+        const auto defaultFreq = 50.f * std::pow(10.f, 2.6f * float(band) / float(BandTable::maxBands - 1));
+
+        const auto freqID = getBandParameterID(band, "Freq", channel);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(freqID,
+                                                               freqID,
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                               std::round(defaultFreq)));
+
+        const auto gainID = getBandParameterID(band, "Gain", channel);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(gainID,
+                                                               gainID,
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                               0.f));
+
+        const auto qualityID = getBandParameterID(band, "Quality", channel);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(qualityID,
+                                                               qualityID,
+                                                               juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                               1.f));
+
+        const auto typeID = getBandParameterID(band, "Type", channel);
+        layout.add(std::make_unique<juce::AudioParameterChoice>(typeID,
+                                                                typeID,
+                                                                juce::StringArray { "Bell", "Low Shelf", "High Shelf", "Notch" },
+                                                                0));
+
+        const auto bypassedID = getBandParameterID(band, "Bypassed", channel);
+        layout.add(std::make_unique<juce::AudioParameterBool>(bypassedID, bypassedID, false));
+    }
+}
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout
+    SimpleEQAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    addFilterParameters(layout, 0);
+
     layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyzer Smoothing",
+                                                            "Analyzer Smoothing",
+                                                            juce::StringArray { "Off", "1/3 Oct", "1/6 Oct", "1/12 Oct", "1/24 Oct" },
+                                                            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Engine",
+                                                            "Filter Engine",
+                                                            juce::StringArray { "Biquad", "SVF", "Linear Phase" },
+                                                            0));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Dynamic", "Peak Dynamic", false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Threshold",
+                                                           "Dynamic Threshold",
+                                                           juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+                                                           -24.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Ratio",
+                                                           "Dynamic Ratio",
+                                                           juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f),
+                                                           4.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Attack",
+                                                           "Dynamic Attack",
+                                                           juce::NormalisableRange<float>(0.1f, 100.f, 0.1f, 0.4f),
+                                                           5.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Release",
+                                                           "Dynamic Release",
+                                                           juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.4f),
+                                                           100.f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Dynamic Source",
+                                                            "Dynamic Source",
+                                                            juce::StringArray { "Input", "Sidechain" },
+                                                            0));
+
+    addBandParameters(layout, 0);
+
+    // the second channel's chain goes last, so existing sessions keep their parameter order
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Channel Mode",
+                                                            "Channel Mode",
+                                                            juce::StringArray { "Stereo", "Dual Mono", "Mid/Side" },
+                                                            0));
+
+    addFilterParameters(layout, 1);
+    addBandParameters(layout, 1);
 
     return layout;
 }
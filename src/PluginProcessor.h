@@ -3,74 +3,30 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "ChainSettings.h"
+#include "ChainSnapshot.h"
+#include "CycleCounter.h"
+#include "DynamicPeak.h"
+#include "Fifo.h"
+#include "FilterBank.h"
+#include "FilterEngines.h"
+#include "Instrumentation.h"
+#include "LinearPhaseFilter.h"
+#include "MemoryFootprint.h"
+#include "PresetState.h"
+#include "ProcessorTelemetry.h"
+#include "SvfBank.h"
+#include "TransferFunctionMeasurement.h"
+#include "TripleBuffer.h"
+
 #include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 int Factorial(int n);
 bool IsPrime(int n);
 
-template<typename T>
-struct Fifo
-{
-    void prepare(int numChannels, int numSamples)
-    {
-        static_assert( std::is_same_v<T, juce::AudioBuffer<float>>,
-                      "prepare(numChannels, numSamples) should only be used when the Fifo is holding juce::AudioBuffer<float>");
-        for( auto& buffer : buffers)
-        {
-            buffer.setSize(numChannels,
-                           numSamples,
-                           false,   //clear everything?
-                           true,    //including the extra space?
-                           true);   //avoid reallocating if you can?
-            buffer.clear();
-        }
-    }
-    
-    void prepare(size_t numElements)
-    {
-        static_assert( std::is_same_v<T, std::vector<float>>,
-                      "prepare(numElements) should only be used when the Fifo is holding std::vector<float>");
-        for( auto& buffer : buffers )
-        {
-            buffer.clear();
-            buffer.resize(numElements, 0);
-        }
-    }
-    
-    bool push(const T& t)
-    {
-        auto write = fifo.write(1);
-        if( write.blockSize1 > 0 )
-        {
-            buffers[write.startIndex1] = t;
-            return true;
-        }
-        
-        return false;
-    }
-    
-    bool pull(T& t)
-    {
-        auto read = fifo.read(1);
-        if( read.blockSize1 > 0 )
-        {
-            t = buffers[read.startIndex1];
-            return true;
-        }
-        
-        return false;
-    }
-    
-    int getNumAvailableForReading() const
-    {
-        return fifo.getNumReady();
-    }
-private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
-};
-
 enum Channel
 {
     Right, //effectively 0
@@ -85,19 +41,37 @@ struct SingleChannelSampleFifo
         prepared.set(false);
     }
     
-    void update(const BlockType& buffer)
+    // accepts the double-precision buffers too; the analyzer itself always runs in float
+    template<typename SourceBlockType>
+    void update(const SourceBlockType& buffer)
     {
+        SIMPLEEQ_ZONE_NAMED("SingleChannelSampleFifo::update");
+
         jassert(prepared.get());
         jassert(buffer.getNumChannels() > channelToUse );
         auto* channelPtr = buffer.getReadPointer(channelToUse);
         
         for( int i = 0; i < buffer.getNumSamples(); ++i )
         {
-            pushNextSampleIntoFifo(channelPtr[i]);
+            pushNextSampleIntoFifo(static_cast<float>(channelPtr[i]));
         }
+
+        SIMPLEEQ_PLOT(channelToUse == Channel::Left ? "Analyzer FIFO depth L" : "Analyzer FIFO depth R",
+                      int64_t(getNumCompleteBuffersAvailable()));
+        SIMPLEEQ_PLOT(channelToUse == Channel::Left ? "Analyzer lost buffers L" : "Analyzer lost buffers R",
+                      int64_t(getNumDroppedBuffers() + getNumOverwrittenBuffers()));
     }
 
-    void prepare(int bufferSize)
+    // enough buffers of bufferSize samples to hold windowSeconds of audio
+    static int getCapacityForWindow(double windowSeconds, double sampleRate, int bufferSize)
+    {
+        const auto buffersNeeded = std::ceil(windowSeconds * sampleRate / juce::jmax(1, bufferSize));
+        return juce::jlimit(4, 4096, (int)buffersNeeded);
+    }
+
+    void setOverflowPolicy(FifoOverflowPolicy newPolicy) { audioBufferFifo.setOverflowPolicy(newPolicy); }
+
+    void prepare(int bufferSize, int capacity = Fifo<BlockType>::defaultCapacity)
     {
         prepared.set(false);
         size.set(bufferSize);
@@ -107,14 +81,19 @@ struct SingleChannelSampleFifo
                              false,         //keepExistingContent
                              true,          //clear extra space
                              true);         //avoid reallocating
-        audioBufferFifo.prepare(1, bufferSize);
+        audioBufferFifo.prepare(1, bufferSize, capacity);
         fifoIndex = 0;
         prepared.set(true);
     }
     //==============================================================================
     int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
+    int getCapacity() const { return audioBufferFifo.getCapacity(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
+    // buffers the GUI didn't pull in time: refused when full, or replaced unread by newer audio
+    int getNumDroppedBuffers() const { return audioBufferFifo.getNumDropped(); }
+    int getNumOverwrittenBuffers() const { return audioBufferFifo.getNumOverwritten(); }
+    size_t getHeapSizeInBytes() const { return audioBufferFifo.getHeapSizeInBytes() + ::getHeapSizeInBytes(bufferToFill); }
     //==============================================================================
     bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
 private:
@@ -129,9 +108,7 @@ private:
     {
         if (fifoIndex == bufferToFill.getNumSamples())
         {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
+            audioBufferFifo.push(bufferToFill);
             
             fifoIndex = 0;
         }
@@ -141,24 +118,15 @@ private:
     }
 };
 
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-struct ChainSettings
-{
-    float peakFreq { 0 }, peakGainInDecibels{ 0 }, peakQuality { 1.f };
-    float lowCutFreq { 0 }, highCutFreq { 0 };
-    Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
+// channel 0 is the left (or mid) chain, and the only one used when linked; channel 1 the right (or side)
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int channel = 0);
+ChannelMode getChannelMode(juce::AudioProcessorValueTreeState& apvts);
 
-    bool loCutBypassed { false }, peakBypassed { false }, hiCutBypassed { false };
-};
+// channel 0 keeps the original IDs; channel 1's are the same with a "Ch2 " prefix
+juce::String getChannelParameterID(int channel, const juce::String& id);
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+// "Band 3 Freq" and so on; band is zero-based, the IDs count from 1
+juce::String getBandParameterID(int band, const char* name, int channel = 0);
 
 using Filter = juce::dsp::IIR::Filter<float>;
 using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
@@ -174,8 +142,6 @@ enum ChainPositions
 using Coefficients = Filter::CoefficientsPtr;
 void updateCoefficients(Coefficients& old, const Coefficients& replacements);
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
 template<int Index, typename ChainType, typename CoefficientType>
 void update(ChainType& chain, const CoefficientType& coefficients)
 {
@@ -214,22 +180,28 @@ void updateCutFilter(ChainType& cutFilterChain,
     }
 }
 
-inline auto makeLoCutFilter(const ChainSettings& chainSettings, double sampleRate)
+// writes a cut filter's Butterworth sections into the bank, enabling only the stages the slope needs
+template<typename SampleType, typename CoefficientType>
+void updateCutSections(FilterBank<SampleType>& bank,
+                       int firstSection,
+                       const CoefficientType& cutCoefficients,
+                       const Slope& cutSlope,
+                       bool bypassed)
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                        sampleRate,
-                                                                                        2 * (chainSettings.lowCutSlope + 1));
-}
+    for( int stage = 0; stage < FilterBank<SampleType>::numCutStages; ++stage )
+    {
+        const bool active = ! bypassed && stage <= (int)cutSlope;
+        if( active )
+            bank.setSection(firstSection + stage, cutCoefficients[stage]->getRawCoefficients());
 
-inline auto makeHiCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                                        sampleRate,
-                                                                                        2 * (chainSettings.highCutSlope + 1));
+        bank.setSectionEnabled(firstSection + stage, active);
+    }
 }
 
 //==============================================================================
-class SimpleEQAudioProcessor final : public juce::AudioProcessor
+class SimpleEQAudioProcessor final : public juce::AudioProcessor,
+                                     private juce::AudioProcessorParameter::Listener,
+                                     private juce::Timer
 {
 public:
     //==============================================================================
@@ -243,8 +215,13 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
     using AudioProcessor::processBlock;
 
+    // Low cuts near 20 Hz at high sample rates put poles very close to the unit circle,
+    // where float coefficients and state add audible noise; hosts may run us in double instead.
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -271,19 +248,79 @@ public:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters",createParameterLayout()};
 
+    // every parameter's denormalised value in parameter order: the layout of BinaryState and PresetBank
+    void getParameterValues(std::vector<float>& values) const;
+
+    // Message thread.  Maps a bank written by PresetBank::write(); recalling a preset sets the
+    // parameters straight from the mapping and publishes the new chain without going through a ValueTree.
+    bool openPresetBank(const juce::File& file);
+    const PresetBank& getPresetBank() const { return presetBank; }
+    bool recallPreset(int index);
+
+    // Message thread only.  Publishes any pending parameter change first, so the response curve
+    // and the audio thread always agree on what is being drawn.
+    StereoChainSnapshot getLatestStereoChainSnapshot();
+    ChainSnapshot getLatestChainSnapshot() { return getLatestStereoChainSnapshot().channels[0]; }
+
+    // block load, per-stage cycles and redesign counts; written lock-free by the audio thread
+    ProcessorTelemetry& getTelemetry() { return telemetry; }
+    const ProcessorTelemetry& getTelemetry() const { return telemetry; }
+
+    // measured input-to-output response, for checking the drawn curve against the real audio path
+    TransferFunctionMeasurement& getMeasurement() { return measurement; }
+
+    // audio thread state, so only meaningful between blocks; true while a new linear phase kernel fades in
+    bool isLinearPhaseCrossfading() const { return linearPhase.isCrossfading(); }
+
+    // Message thread.  What this instance holds, by subsystem; see MemoryFootprint.
+    MemoryFootprint getMemoryFootprint() const;
+
     // Public so the GUI can access these members
+    static constexpr double analyzerWindowSeconds = 0.1;
     using BlockType = juce::AudioBuffer<float>;
     SingleChannelSampleFifo<BlockType> leftChannelFifo { Channel::Left };
     SingleChannelSampleFifo<BlockType> rightChannelFifo { Channel::Right };
 
 private:
     
-    MonoChain leftChain, rightChain;
+    // only the engines matching the host's processing precision are prepared
+    FilterEngines<float> floatEngines;
+    FilterEngines<double> doubleEngines;
+
+    template<typename SampleType>
+    void processBlockImpl(juce::AudioBuffer<SampleType>& buffer, FilterEngines<SampleType>& engines);
+
+    template<typename SampleType>
+    void adoptChainSnapshot(FilterEngines<SampleType>& engines, const StereoChainSnapshot& snapshot);
+
+    // Parameter reads and coefficient design happen here, off the audio thread.  The audio thread
+    // only picks up the newest snapshot at the start of each block.
+    void publishChainSnapshot();
+
+    // sets only the parameters whose value changed, then publishes; parameters beyond numValues go back to their defaults
+    void setParameterValues(const float* values, int numValues);
+
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int, bool) override { }
+    void timerCallback() override;
+
+    TripleBuffer<StereoChainSnapshot> chainSnapshots;
+    StereoChainSnapshot latestChainSnapshot;    // message thread copy of the last one published
+    juce::CriticalSection publishLock;          // writer side only: message thread vs. offline renders
+    juce::Atomic<bool> chainSettingsChanged { true };
+    uint32_t nextSnapshotVersion = 1;
+
+    // precision independent: it convolves in float for both
+    LinearPhaseFilter linearPhase;
+    juce::Atomic<int> latencyToReport { 0 };    // applied on the message thread by timerCallback()
+
+    ProcessorTelemetry telemetry;
+    TransferFunctionMeasurement measurement;
 
-    void updatePeakFilter(const ChainSettings &chainSettings);
-    void updateLoCutFilters(const ChainSettings& chainSettings);
-    void updateHiCutFilters(const ChainSettings& chainSettings);
-    void updateFilters();
+    // cached once, so saving and restoring state never looks a parameter up by ID
+    std::vector<juce::RangedAudioParameter*> stateParameters;
+    std::vector<std::atomic<float>*> stateValues;
+    PresetBank presetBank;
 
     juce::dsp::Oscillator<float> osc;
     //==============================================================================
@@ -0,0 +1,125 @@
+#include "PresetState.h"
+
+#include <cstring>
+#include <limits>
+
+bool BinaryState::isBinaryState(const void* data, size_t sizeInBytes)
+{
+    if( data == nullptr || sizeInBytes < sizeof(Header) )
+        return false;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    return header.magic == magic
+        && header.version == version
+        && header.numValues <= maxValues
+        && (sizeInBytes - sizeof(Header)) / sizeof(float) >= header.numValues;
+}
+
+void BinaryState::write(const float* values, int numValues, juce::MemoryBlock& destData)
+{
+    std::memcpy(writeHeader(numValues, destData), values, (size_t)numValues * sizeof(float));
+}
+
+float* BinaryState::writeHeader(int numValues, juce::MemoryBlock& destData)
+{
+    const Header header { magic, version, (uint32_t)numValues, 0 };
+
+    destData.setSize(sizeof(Header) + (size_t)numValues * sizeof(float));
+    auto* bytes = static_cast<char*>(destData.getData());
+    std::memcpy(bytes, &header, sizeof(Header));
+
+    // the header is four words and the block's data comes from the heap, so this is float aligned
+    return reinterpret_cast<float*>(bytes + sizeof(Header));
+}
+
+int BinaryState::read(const void* data, size_t sizeInBytes, float* values, int maxValues)
+{
+    if( ! isBinaryState(data, sizeInBytes) )
+        return -1;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    const auto numValues = juce::jmin((int)header.numValues, maxValues);
+    std::memcpy(values, static_cast<const char*>(data) + sizeof(Header), (size_t)numValues * sizeof(float));
+    return numValues;
+}
+
+//==============================================================================
+bool PresetBank::write(const juce::File& file, const std::vector<Preset>& presets, int numValues)
+{
+    const Header header { magic, version, (uint32_t)presets.size(), (uint32_t)numValues };
+    const auto stride = getPresetStride(numValues);
+
+    juce::MemoryBlock data(sizeof(Header) + presets.size() * stride, true);
+    auto* bytes = static_cast<char*>(data.getData());
+    std::memcpy(bytes, &header, sizeof(Header));
+
+    for( size_t p = 0; p < presets.size(); ++p )
+    {
+        auto* preset = bytes + sizeof(Header) + p * stride;
+
+        // always leaves room for the terminator, so a name can be read straight out of the mapping
+        presets[p].name.copyToUTF8(preset, nameLength);
+
+        const auto numToCopy = juce::jmin(numValues, (int)presets[p].values.size());
+        std::memcpy(preset + nameLength, presets[p].values.data(), (size_t)numToCopy * sizeof(float));
+    }
+
+    return file.replaceWithData(data.getData(), data.getSize());
+}
+
+bool PresetBank::open(const juce::File& file)
+{
+    close();
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapping->getData());
+    const auto size = mapping->getSize();
+
+    if( data == nullptr || size < sizeof(Header) )
+        return false;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    if( header.magic != magic || header.version != version || header.numValues > BinaryState::maxValues )
+        return false;
+
+    // divided rather than multiplied, so a crafted count can't wrap around
+    const auto maxPresets = (size - sizeof(Header)) / getPresetStride((int)header.numValues);
+    if( header.numPresets > maxPresets || header.numPresets > (uint32_t)std::numeric_limits<int>::max() )
+        return false;
+
+    mappedFile = std::move(mapping);
+    firstPreset = data + sizeof(Header);
+    numPresets = (int)header.numPresets;
+    numValues = (int)header.numValues;
+    return true;
+}
+
+void PresetBank::close()
+{
+    mappedFile.reset();
+    firstPreset = nullptr;
+    numPresets = numValues = 0;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    if( ! juce::isPositiveAndBelow(index, numPresets) )
+        return {};
+
+    const auto* name = firstPreset + (size_t)index * getPresetStride(numValues);
+    return juce::String::fromUTF8(name, (int)strnlen(name, (size_t)nameLength));
+}
+
+const float* PresetBank::getValues(int index) const
+{
+    if( ! juce::isPositiveAndBelow(index, numPresets) )
+        return nullptr;
+
+    // the header and the names are multiples of four bytes, so the values are float aligned
+    return reinterpret_cast<const float*>(firstPreset + (size_t)index * getPresetStride(numValues) + nameLength);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ The plugin's state as a fixed-layout binary blob: a header, then every parameter's denormalised
+ value as a float, in the processor's parameter order.  Writing it is a copy of the values and
+ reading it is a bounds check and a copy back, with no XML or ValueTree in between.
+
+ Parameters are only ever appended to the layout, so a blob with fewer values than the processor
+ has comes from an older version: the values it has are used and the rest keep their defaults.
+ Extra values from a newer version are ignored.  A change that breaks that rule bumps version;
+ PresetState.ParameterOrderIsPinned fails on any other change to the order.
+ Floats are stored in host byte order, which is little-endian on every platform we build for.
+ */
+struct BinaryState
+{
+    static constexpr uint32_t magic = 0x42514553;       // "SEQB"
+    static constexpr uint32_t version = 1;
+
+    // far more than any layout will have; anything above it is a corrupt or hostile blob or bank
+    static constexpr uint32_t maxValues = 1 << 16;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numValues;
+        uint32_t reserved;
+    };
+
+    static bool isBinaryState(const void* data, size_t sizeInBytes);
+
+    static void write(const float* values, int numValues, juce::MemoryBlock& destData);
+
+    // sizes destData for numValues values and writes the header; returns where the values go
+    static float* writeHeader(int numValues, juce::MemoryBlock& destData);
+
+    // copies up to maxValues values; returns how many were stored, or -1 if data isn't a valid blob
+    static int read(const void* data, size_t sizeInBytes, float* values, int maxValues);
+};
+
+/*
+ A bank of presets in one file, memory-mapped read-only, so recalling one is an index into the
+ mapping: no parsing, no allocation, and the values can be applied straight from the page cache.
+
+    header:     magic, version, number of presets, values per preset
+    presets:    each a nameLength-byte, zero-padded UTF-8 name followed by the values, in the same
+                layout as BinaryState
+
+ Every preset in a bank has the same number of values; a bank written by an older version is read
+ the same way as an older BinaryState.  Banks are files from anywhere, so open() checks the header's
+ counts against the file's size before anything is indexed.
+ */
+class PresetBank
+{
+public:
+    static constexpr uint32_t magic = 0x50514553;       // "SEQP"
+    static constexpr uint32_t version = 1;
+    static constexpr int nameLength = 32;
+
+    struct Preset
+    {
+        juce::String name;
+        std::vector<float> values;
+    };
+
+    // values beyond numValues are dropped and missing ones written as 0; allocates, message thread only
+    static bool write(const juce::File& file, const std::vector<Preset>& presets, int numValues);
+
+    // maps the file, keeping it mapped until close() or the next open(); false if it isn't a valid bank
+    bool open(const juce::File& file);
+    void close();
+    bool isOpen() const { return mappedFile != nullptr; }
+
+    int getNumPresets() const { return numPresets; }
+    int getNumValues() const { return numValues; }
+
+    juce::String getName(int index) const;
+
+    // numValues floats inside the mapping, valid while the bank stays open
+    const float* getValues(int index) const;
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numPresets;
+        uint32_t numValues;
+    };
+
+    static size_t getPresetStride(int numValues) { return (size_t)nameLength + (size_t)numValues * sizeof(float); }
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const char* firstPreset = nullptr;
+    int numPresets = 0, numValues = 0;
+};
@@ -0,0 +1,177 @@
+#include "ProcessorTelemetry.h"
+
+namespace
+{
+void storeMax(std::atomic<uint64_t>& target, uint64_t value) noexcept
+{
+    auto current = target.load(std::memory_order_relaxed);
+    while( value > current && ! target.compare_exchange_weak(current, value, std::memory_order_relaxed) ) {}
+}
+}
+
+//==============================================================================
+int LoadHistogram::getBucketIndex(uint32_t value) noexcept
+{
+    if( value < (uint32_t)numLinearBuckets )
+        return (int)value;
+
+    const auto shift = juce::findHighestSetBit(value) - subBucketBits;
+    const auto index = numLinearBuckets + (shift - 1) * numSubBuckets + int(value >> shift) - numSubBuckets;
+    return juce::jmin(index, numBuckets - 1);
+}
+
+uint32_t LoadHistogram::getBucketUpperBound(int index) noexcept
+{
+    if( index < numLinearBuckets )
+        return (uint32_t)index;
+
+    const auto shift = (index - numLinearBuckets) / numSubBuckets + 1;
+    const auto subBucket = uint32_t((index - numLinearBuckets) % numSubBuckets + numSubBuckets);
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LoadHistogram::record(double load) noexcept
+{
+    const auto maxValue32 = (uint32_t(1) << maxValueBits) - 1;
+    const auto value = (uint32_t)juce::jlimit(0.0, double(maxValue32), load * unitsPerBudget + 0.5);
+
+    counts[(size_t)getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    lastValue.store(value, std::memory_order_relaxed);
+
+    // single writer, so a plain compare is enough
+    if( value > maxValue.load(std::memory_order_relaxed) )
+        maxValue.store(value, std::memory_order_relaxed);
+}
+
+void LoadHistogram::reset() noexcept
+{
+    for( auto& count : counts )
+        count.store(0, std::memory_order_relaxed);
+
+    maxValue.store(0, std::memory_order_relaxed);
+    lastValue.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LoadHistogram::getNumRecorded() const noexcept
+{
+    uint64_t total = 0;
+    for( auto& count : counts )
+        total += count.load(std::memory_order_relaxed);
+
+    return total;
+}
+
+double LoadHistogram::getPercentile(double percentile) const noexcept
+{
+    const auto total = getNumRecorded();
+    if( total == 0 )
+        return 0.0;
+
+    const auto rank = juce::jmax(uint64_t(1), (uint64_t)std::ceil(juce::jlimit(0.0, 100.0, percentile) / 100.0 * double(total)));
+    const auto max = maxValue.load(std::memory_order_relaxed);
+
+    uint64_t seen = 0;
+    for( int i = 0; i < numBuckets; ++i )
+    {
+        seen += counts[(size_t)i].load(std::memory_order_relaxed);
+
+        if( seen >= rank )
+            return double(juce::jmin(getBucketUpperBound(i), max)) / unitsPerBudget;
+    }
+
+    return double(max) / unitsPerBudget;
+}
+
+double LoadHistogram::getMax() const noexcept { return double(maxValue.load(std::memory_order_relaxed)) / unitsPerBudget; }
+double LoadHistogram::getLast() const noexcept { return double(lastValue.load(std::memory_order_relaxed)) / unitsPerBudget; }
+
+//==============================================================================
+const char* ProcessorTelemetry::getStageName(Stage stage)
+{
+    switch( stage )
+    {
+        case LowCutStage:       return "lowCut";
+        case PeakStage:         return "peak";
+        case BandsStage:        return "bands";
+        case HighCutStage:      return "highCut";
+        case SvfChainStage:     return "svfChain";
+        case DynamicPeakStage:  return "dynamicPeak";
+        case LinearPhaseStage:  return "linearPhase";
+        case AnalyzerTapStage:  return "analyzerTap";
+        case NumStages:         break;
+    }
+
+    jassertfalse;
+    return "";
+}
+
+void ProcessorTelemetry::recordBlock(double elapsedSeconds, double budgetSeconds) noexcept
+{
+    if( budgetSeconds > 0.0 )
+        loadHistogram.record(elapsedSeconds / budgetSeconds);
+}
+
+void ProcessorTelemetry::recordStageCycles(Stage stage, uint64_t cycles) noexcept
+{
+    auto& counters = stages[(size_t)stage];
+    counters.numBlocks.fetch_add(1, std::memory_order_relaxed);
+    counters.totalCycles.fetch_add(cycles, std::memory_order_relaxed);
+    storeMax(counters.maxCycles, cycles);
+}
+
+void ProcessorTelemetry::reset() noexcept
+{
+    // anything the audio thread records while this runs may survive the reset; that's fine for statistics
+    loadHistogram.reset();
+
+    for( auto& counters : stages )
+    {
+        counters.numBlocks.store(0, std::memory_order_relaxed);
+        counters.totalCycles.store(0, std::memory_order_relaxed);
+        counters.maxCycles.store(0, std::memory_order_relaxed);
+    }
+
+    redesigns.store(0, std::memory_order_relaxed);
+    adoptions.store(0, std::memory_order_relaxed);
+}
+
+ProcessorTelemetry::StageStats ProcessorTelemetry::getStageStats(Stage stage) const noexcept
+{
+    const auto& counters = stages[(size_t)stage];
+
+    StageStats stats;
+    stats.numBlocks = counters.numBlocks.load(std::memory_order_relaxed);
+    stats.totalCycles = counters.totalCycles.load(std::memory_order_relaxed);
+    stats.maxCycles = counters.maxCycles.load(std::memory_order_relaxed);
+    return stats;
+}
+
+juce::String ProcessorTelemetry::toJSON() const
+{
+    auto* load = new juce::DynamicObject();
+    load->setProperty("blocks", (juce::int64)loadHistogram.getNumRecorded());
+    load->setProperty("p50", loadHistogram.getPercentile(50.0));
+    load->setProperty("p99", loadHistogram.getPercentile(99.0));
+    load->setProperty("p99.9", loadHistogram.getPercentile(99.9));
+    load->setProperty("max", loadHistogram.getMax());
+
+    auto* stageObject = new juce::DynamicObject();
+    for( int s = 0; s < NumStages; ++s )
+    {
+        const auto stats = getStageStats(Stage(s));
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("blocks", (juce::int64)stats.numBlocks);
+        entry->setProperty("meanCycles", stats.getMeanCycles());
+        entry->setProperty("maxCycles", (juce::int64)stats.maxCycles);
+        stageObject->setProperty(getStageName(Stage(s)), juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("load", juce::var(load));
+    root->setProperty("stages", juce::var(stageObject));
+    root->setProperty("redesigns", (juce::int64)getNumRedesigns());
+    root->setProperty("snapshotsAdopted", (juce::int64)getNumSnapshotsAdopted());
+
+    return juce::JSON::toString(juce::var(root));
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+ Fixed-size, lock-free histogram of how much of its real-time budget each block used.
+
+ Loads are stored in units of 0.01% of the budget and bucketed HDR-style: values below 64 get a
+ bucket each, above that every power of two is split into 32 linear sub-buckets, so any recorded
+ value is known to within ~3%.  Loads above ~1600x the budget land in the last bucket; the exact
+ maximum is tracked separately.
+
+ One writer (the audio thread) and any number of readers; nothing allocates or blocks.
+ */
+class LoadHistogram
+{
+public:
+    static constexpr int subBucketBits = 5;
+    static constexpr int numSubBuckets = 1 << subBucketBits;
+    static constexpr int numLinearBuckets = 2 * numSubBuckets;
+    static constexpr int maxValueBits = 24;
+    static constexpr int numBuckets = numLinearBuckets + (maxValueBits - subBucketBits - 1) * numSubBuckets;
+    static constexpr double unitsPerBudget = 10000.0;
+
+    // load is the fraction of the budget used, 1.0 meaning the whole block period
+    void record(double load) noexcept;
+    void reset() noexcept;
+
+    uint64_t getNumRecorded() const noexcept;
+    // percentile in [0, 100]; returns a load as a fraction of the budget, 0 if nothing was recorded
+    double getPercentile(double percentile) const noexcept;
+    double getMax() const noexcept;
+    double getLast() const noexcept;
+
+    static int getBucketIndex(uint32_t value) noexcept;
+    static uint32_t getBucketUpperBound(int index) noexcept;
+
+private:
+    std::array<std::atomic<uint32_t>, numBuckets> counts {};
+    std::atomic<uint32_t> maxValue { 0 }, lastValue { 0 };
+};
+
+/*
+ What the processor knows about its own cost, written by the audio thread without locks and read
+ from the message thread:
+
+    - the per-block load histogram above
+    - cycles spent per stage (see readCycleCounter()), as totals and per-block maxima
+    - how often coefficients were redesigned, and how often the audio thread picked up a new design
+
+ The SVF engine updates its coefficients every few samples across all bands, so it is measured as
+ a single stage rather than split into cuts, peak and bands.
+ */
+class ProcessorTelemetry
+{
+public:
+    enum Stage
+    {
+        LowCutStage,
+        PeakStage,
+        BandsStage,
+        HighCutStage,
+        SvfChainStage,
+        DynamicPeakStage,
+        LinearPhaseStage,
+        AnalyzerTapStage,
+        NumStages
+    };
+
+    static const char* getStageName(Stage stage);
+
+    struct StageStats
+    {
+        uint64_t numBlocks = 0;
+        uint64_t totalCycles = 0;
+        uint64_t maxCycles = 0;
+
+        double getMeanCycles() const { return numBlocks > 0 ? double(totalCycles) / double(numBlocks) : 0.0; }
+    };
+
+    //==============================================================================
+    // audio thread
+    void recordBlock(double elapsedSeconds, double budgetSeconds) noexcept;
+    void recordStageCycles(Stage stage, uint64_t cycles) noexcept;
+    void recordSnapshotAdopted() noexcept { adoptions.fetch_add(1, std::memory_order_relaxed); }
+
+    // whichever thread designed the coefficients
+    void recordRedesign() noexcept { redesigns.fetch_add(1, std::memory_order_relaxed); }
+
+    //==============================================================================
+    // message thread
+    void reset() noexcept;
+
+    const LoadHistogram& getLoadHistogram() const { return loadHistogram; }
+    StageStats getStageStats(Stage stage) const noexcept;
+    uint64_t getNumRedesigns() const noexcept { return redesigns.load(std::memory_order_relaxed); }
+    uint64_t getNumSnapshotsAdopted() const noexcept { return adoptions.load(std::memory_order_relaxed); }
+
+    // p50/p99/p99.9/max load, per-stage cycles and the redesign counters
+    juce::String toJSON() const;
+
+private:
+    struct StageCounters
+    {
+        std::atomic<uint64_t> numBlocks { 0 }, totalCycles { 0 }, maxCycles { 0 };
+    };
+
+    LoadHistogram loadHistogram;
+    std::array<StageCounters, NumStages> stages;
+    std::atomic<uint64_t> redesigns { 0 }, adoptions { 0 };
+};
@@ -0,0 +1,219 @@
+#include "RealFFT.h"
+#include "MemoryFootprint.h"
+#include "SharedTables.h"
+
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+RealFFT::Tables::Tables(int order)
+{
+    const auto size = 1 << order;
+    const auto half = size / 2;
+    const auto twoPi = 2.0 * 3.14159265358979323846;
+
+    twiddleReal.resize((size_t)half / 2);
+    twiddleImag.resize((size_t)half / 2);
+    for( int k = 0; k < half / 2; ++k )
+    {
+        twiddleReal[(size_t)k] = (float)std::cos(twoPi * k / half);
+        twiddleImag[(size_t)k] = (float)-std::sin(twoPi * k / half);
+    }
+
+    splitReal.resize((size_t)half + 1);
+    splitImag.resize((size_t)half + 1);
+    for( int k = 0; k <= half; ++k )
+    {
+        splitReal[(size_t)k] = (float)std::cos(twoPi * k / size);
+        splitImag[(size_t)k] = (float)-std::sin(twoPi * k / size);
+    }
+}
+
+RealFFT::RealFFT(int order) :
+size(1 << order),
+half(size / 2)
+{
+    assert(order >= 2);
+
+    tables = SharedTables::getFFTTables(order);
+
+    for( auto* v : { &workReal, &workImag, &scratchReal, &scratchImag } )
+        v->resize((size_t)half);
+
+    magnitudeImag.resize((size_t)half + 1);
+}
+
+namespace
+{
+// the first stages have runs of only 1 or 2 contiguous butterflies, too short for the inner loop
+// below; walk each run along p instead, with the stride known at compile time
+template<int stride>
+void runEarlyStage(const float* __restrict xr, const float* __restrict xi, float* __restrict yr, float* __restrict yi,
+                   const float* twiddleReal, const float* twiddleImag, int m) noexcept
+{
+    for( int q = 0; q < stride; ++q )
+    {
+        for( int p = 0; p < m; ++p )
+        {
+            // e^(-2 pi i p / n) == e^(-2 pi i p s / half)
+            const auto wr = twiddleReal[p * stride];
+            const auto wi = twiddleImag[p * stride];
+
+            const auto a = stride * p + q, b = stride * (p + m) + q;
+            const auto dr = xr[a] - xr[b];
+            const auto di = xi[a] - xi[b];
+            yr[stride * 2 * p + q] = xr[a] + xr[b];
+            yi[stride * 2 * p + q] = xi[a] + xi[b];
+            yr[stride * (2 * p + 1) + q] = dr * wr - di * wi;
+            yi[stride * (2 * p + 1) + q] = dr * wi + di * wr;
+        }
+    }
+}
+}
+
+void RealFFT::performComplex(float*& real, float*& imag) noexcept
+{
+    float* xr = workReal.data();
+    float* xi = workImag.data();
+    float* yr = scratchReal.data();
+    float* yi = scratchImag.data();
+    const auto* twiddleReal = tables->twiddleReal.data();
+    const auto* twiddleImag = tables->twiddleImag.data();
+
+    // Stockham autosort: n is the length of the sub-transforms still to do, s their stride
+    for( int n = half, s = 1; n > 1; n /= 2, s *= 2 )
+    {
+        const int m = n / 2;
+
+        if( s == 1 )
+            runEarlyStage<1>(xr, xi, yr, yi, twiddleReal, twiddleImag, m);
+        else if( s == 2 )
+            runEarlyStage<2>(xr, xi, yr, yi, twiddleReal, twiddleImag, m);
+        else
+        {
+            for( int p = 0; p < m; ++p )
+            {
+                // e^(-2 pi i p / n) == e^(-2 pi i p s / half)
+                const auto wr = twiddleReal[size_t(p * s)];
+                const auto wi = twiddleImag[size_t(p * s)];
+
+                const float* __restrict ar = xr + s * p;
+                const float* __restrict ai = xi + s * p;
+                const float* __restrict br = xr + s * (p + m);
+                const float* __restrict bi = xi + s * (p + m);
+                float* __restrict sumReal = yr + s * (2 * p);
+                float* __restrict sumImag = yi + s * (2 * p);
+                float* __restrict diffReal = yr + s * (2 * p + 1);
+                float* __restrict diffImag = yi + s * (2 * p + 1);
+
+                for( int q = 0; q < s; ++q )
+                {
+                    const auto dr = ar[q] - br[q];
+                    const auto di = ai[q] - bi[q];
+                    sumReal[q] = ar[q] + br[q];
+                    sumImag[q] = ai[q] + bi[q];
+                    diffReal[q] = dr * wr - di * wi;
+                    diffImag[q] = dr * wi + di * wr;
+                }
+            }
+        }
+
+        std::swap(xr, yr);
+        std::swap(xi, yi);
+    }
+
+    real = xr;
+    imag = xi;
+}
+
+void RealFFT::performForward(const float* input, float* real, float* imag) noexcept
+{
+    // z[n] = x[2n] + i x[2n + 1]
+    for( int n = 0; n < half; ++n )
+    {
+        workReal[(size_t)n] = input[2 * n];
+        workImag[(size_t)n] = input[2 * n + 1];
+    }
+
+    float* zr;
+    float* zi;
+    performComplex(zr, zi);
+
+    const auto* splitReal = tables->splitReal.data();
+    const auto* splitImag = tables->splitImag.data();
+
+    // X[k] = E[k] + e^(-2 pi i k / N) O[k], with E and O the spectra of the even and odd samples:
+    // E[k] = (Z[k] + conj(Z[half - k])) / 2,  O[k] = (Z[k] - conj(Z[half - k])) / 2i
+    real[0] = zr[0] + zi[0];
+    imag[0] = 0.f;
+    real[half] = zr[0] - zi[0];
+    imag[half] = 0.f;
+
+    for( int k = 1; k < half; ++k )
+    {
+        const auto ar = zr[k], ai = zi[k];
+        const auto br = zr[half - k], bi = -zi[half - k];    // conj(Z[half - k])
+
+        const auto er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        const auto or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+
+        const auto wr = splitReal[k], wi = splitImag[k];
+        real[k] = er + (or_ * wr - oi * wi);
+        imag[k] = ei + (or_ * wi + oi * wr);
+    }
+}
+
+void RealFFT::performInverse(const float* real, const float* imag, float* output) noexcept
+{
+    // rebuild Z[k] = E[k] + i O[k] and run the forward transform on its conjugate:
+    // ifft(Z) = conj(fft(conj(Z))) / half
+    const auto* splitReal = tables->splitReal.data();
+    const auto* splitImag = tables->splitImag.data();
+
+    for( int k = 0; k < half; ++k )
+    {
+        const auto ar = real[k], ai = imag[k];
+        const auto br = real[half - k], bi = -imag[half - k];   // conj(X[half - k])
+
+        const auto er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        const auto dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+
+        // O[k] = (X[k] - conj(X[half - k])) / 2 * e^(2 pi i k / N)
+        const auto wr = splitReal[k], wi = -splitImag[k];
+        const auto or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+
+        // Z = E + i O, conjugated
+        workReal[(size_t)k] = er - oi;
+        workImag[(size_t)k] = -(ei + or_);
+    }
+
+    float* zr;
+    float* zi;
+    performComplex(zr, zi);
+
+    // 1/half for the inverse of the half-size transform; E and O already carry their own halves
+    const auto scale = 1.f / (float)half;
+    for( int n = 0; n < half; ++n )
+    {
+        output[2 * n] = zr[n] * scale;
+        output[2 * n + 1] = -zi[n] * scale;
+    }
+}
+
+void RealFFT::performMagnitudes(const float* input, float* magnitudes) noexcept
+{
+    // real parts go straight into the output, then get replaced by the magnitudes
+    performForward(input, magnitudes, magnitudeImag.data());
+
+    for( int k = 0; k <= half; ++k )
+        magnitudes[k] = std::sqrt(magnitudes[k] * magnitudes[k] + magnitudeImag[(size_t)k] * magnitudeImag[(size_t)k]);
+}
+
+size_t RealFFT::getHeapSizeInBytes() const
+{
+    size_t bytes = 0;
+    for( const auto* v : { &workReal, &workImag, &scratchReal, &scratchImag, &magnitudeImag } )
+        bytes += ::getHeapSizeInBytes(*v);
+
+    return bytes;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+/*
+ Real-input FFT, bundled so the analyzer doesn't depend on which engine juce::dsp::FFT finds at
+ runtime (on Linux without FFTW or IPP that is JUCE's generic fallback).
+
+ A size-N real transform runs as a size-N/2 complex transform on the even/odd samples packed as
+ real/imaginary parts, followed by one O(N) pass that separates the two spectra.  The complex
+ transform is a radix-2 Stockham FFT over split (separate real and imaginary) arrays: no bit
+ reversal, and the inner loops of all but the first stages are unit-stride over plain float
+ arrays, so the compiler vectorises them.
+
+ Spectra are in split format too: getNumBins() = N/2 + 1 real parts and as many imaginary parts,
+ unnormalised, like juce::dsp::FFT.  Everything is allocated in the constructor; the transforms
+ themselves never allocate.  The twiddle tables are immutable and come from SharedTables, so every
+ RealFFT of the same order in the process uses one copy; only the work buffers are per instance.
+ */
+class RealFFT
+{
+public:
+    // the read-only part of a transform, built once per order and shared
+    struct Tables
+    {
+        explicit Tables(int order);
+
+        std::vector<float> twiddleReal, twiddleImag;    // e^(-2 pi i k / half), k < half / 2
+        std::vector<float> splitReal, splitImag;        // e^(-2 pi i k / size), k <= half
+    };
+
+    explicit RealFFT(int order);
+
+    int getSize() const { return size; }
+    int getNumBins() const { return size / 2 + 1; }
+
+    // the work buffers; the tables are shared and counted by SharedTables
+    size_t getHeapSizeInBytes() const;
+
+    void performForward(const float* input, float* real, float* imag) noexcept;
+
+    // inverse of performForward, scaled by 1/N so a round trip returns the input
+    void performInverse(const float* real, const float* imag, float* output) noexcept;
+
+    // |X[k]| for the getNumBins() non-negative frequency bins
+    void performMagnitudes(const float* input, float* magnitudes) noexcept;
+
+private:
+    int size, half;
+
+    std::shared_ptr<const Tables> tables;
+    std::vector<float> workReal, workImag, scratchReal, scratchImag;
+    std::vector<float> magnitudeImag;
+
+    // forward complex FFT of workReal/workImag (length half); returns the arrays holding the result
+    void performComplex(float*& real, float*& imag) noexcept;
+};
@@ -0,0 +1,200 @@
+#include "SharedTables.h"
+#include "MemoryFootprint.h"
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace
+{
+size_t getTableBytes(const RealFFT::Tables& tables)
+{
+    return getHeapSizeInBytes(tables.twiddleReal) + getHeapSizeInBytes(tables.twiddleImag)
+         + getHeapSizeInBytes(tables.splitReal) + getHeapSizeInBytes(tables.splitImag);
+}
+
+size_t getTableBytes(const SharedTables::BinPixelMap& map) { return getHeapSizeInBytes(map.x); }
+size_t getTableBytes(const SpectrumSmoother::Windows& windows) { return getHeapSizeInBytes(windows.start) + getHeapSizeInBytes(windows.end); }
+
+template<typename Table>
+size_t getTableBytes(const Table& table) { return getHeapSizeInBytes(table); }
+
+/*
+ Weak references to the tables of one kind, by key.  Expired entries are swept whenever a new table
+ is added, so the map never grows past the number of distinct keys alive at once plus the ones
+ that expired since the last miss.
+ */
+template<typename Key, typename Table>
+class Cache
+{
+public:
+    template<typename Create>
+    std::shared_ptr<const Table> get(const Key& key, Create&& create)
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        auto found = tables.find(key);
+        if( found != tables.end() )
+            if( auto table = found->second.lock() )
+                return table;
+
+        for( auto it = tables.begin(); it != tables.end(); )
+            it = it->second.expired() ? tables.erase(it) : std::next(it);
+
+        std::shared_ptr<const Table> table = create();
+        tables[key] = table;
+        return table;
+    }
+
+    int getNumLive()
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        int numLive = 0;
+        for( const auto& entry : tables )
+            numLive += entry.second.expired() ? 0 : 1;
+
+        return numLive;
+    }
+
+    size_t getLiveBytes()
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+
+        size_t bytes = 0;
+        for( const auto& entry : tables )
+            if( auto table = entry.second.lock() )
+                bytes += sizeof(Table) + getTableBytes(*table);
+
+        return bytes;
+    }
+
+private:
+    std::mutex mutex;
+    std::map<Key, std::weak_ptr<const Table>> tables;
+};
+
+// function statics, so the caches exist before any instance asks for a table at static-init time
+Cache<int, RealFFT::Tables>& getFFTTablesCache()
+{
+    static Cache<int, RealFFT::Tables> cache;
+    return cache;
+}
+
+Cache<int, juce::dsp::FFT>& getJuceFFTCache()
+{
+    static Cache<int, juce::dsp::FFT> cache;
+    return cache;
+}
+
+Cache<int, std::vector<float>>& getWindowCache()
+{
+    static Cache<int, std::vector<float>> cache;
+    return cache;
+}
+
+Cache<std::tuple<int, double, double>, std::vector<double>>& getPixelFrequenciesCache()
+{
+    static Cache<std::tuple<int, double, double>, std::vector<double>> cache;
+    return cache;
+}
+
+Cache<std::tuple<int, double, int>, SharedTables::BinPixelMap>& getBinPixelMapCache()
+{
+    static Cache<std::tuple<int, double, int>, SharedTables::BinPixelMap> cache;
+    return cache;
+}
+
+using SmoothingKey = std::tuple<int, double, int, int, float, float>;
+
+Cache<SmoothingKey, SpectrumSmoother::Windows>& getSmoothingWindowsCache()
+{
+    static Cache<SmoothingKey, SpectrumSmoother::Windows> cache;
+    return cache;
+}
+}
+
+std::shared_ptr<const RealFFT::Tables> SharedTables::getFFTTables(int order)
+{
+    return getFFTTablesCache().get(order, [order] { return std::make_shared<RealFFT::Tables>(order); });
+}
+
+std::shared_ptr<const juce::dsp::FFT> SharedTables::getJuceFFT(int order)
+{
+    return getJuceFFTCache().get(order, [order] { return std::make_shared<juce::dsp::FFT>(order); });
+}
+
+std::shared_ptr<const std::vector<float>> SharedTables::getBlackmanHarrisWindow(int size)
+{
+    return getWindowCache().get(size, [size]
+    {
+        auto window = std::make_shared<std::vector<float>>((size_t)size);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window->data(), (size_t)size,
+                                                                juce::dsp::WindowingFunction<float>::blackmanHarris,
+                                                                true);
+        return window;
+    });
+}
+
+std::shared_ptr<const std::vector<double>> SharedTables::getPixelFrequencies(int numPixels, double minFrequency, double maxFrequency)
+{
+    return getPixelFrequenciesCache().get({ numPixels, minFrequency, maxFrequency }, [=]
+    {
+        auto frequencies = std::make_shared<std::vector<double>>((size_t)juce::jmax(0, numPixels));
+        for( int i = 0; i < numPixels; ++i )
+            (*frequencies)[(size_t)i] = juce::mapToLog10(double(i) / double(numPixels), minFrequency, maxFrequency);
+
+        return frequencies;
+    });
+}
+
+std::shared_ptr<const SharedTables::BinPixelMap> SharedTables::getBinPixelMap(int fftSize, double sampleRate, int width)
+{
+    return getBinPixelMapCache().get({ fftSize, sampleRate, width }, [=]
+    {
+        auto map = std::make_shared<BinPixelMap>();
+        map->fftSize = fftSize;
+        map->sampleRate = sampleRate;
+        map->width = width;
+
+        // DC starts the path at the left edge; other bins below 20 Hz land left of the area, as they always have
+        const auto binWidth = float(sampleRate / (double)fftSize);
+        map->x.assign((size_t)fftSize / 2, 0.f);
+        for( int bin = 1; bin < fftSize / 2; ++bin )
+            map->x[(size_t)bin] = std::floor(juce::mapFromLog10(float(bin) * binWidth, 20.f, 20000.f) * (float)width);
+
+        return map;
+    });
+}
+
+std::shared_ptr<const SpectrumSmoother::Windows> SharedTables::getSmoothingWindows(int fftSize, double sampleRate, AnalyzerSmoothing smoothing,
+                                                                                   int numColumns, float minFrequency, float maxFrequency)
+{
+    const SmoothingKey key { fftSize, sampleRate, (int)smoothing, numColumns, minFrequency, maxFrequency };
+
+    return getSmoothingWindowsCache().get(key, [=]
+    {
+        return std::make_shared<SpectrumSmoother::Windows>(fftSize, sampleRate, smoothing,
+                                                           numColumns, minFrequency, maxFrequency);
+    });
+}
+
+int SharedTables::getNumLiveTables()
+{
+    return getFFTTablesCache().getNumLive()
+         + getJuceFFTCache().getNumLive()
+         + getWindowCache().getNumLive()
+         + getPixelFrequenciesCache().getNumLive()
+         + getBinPixelMapCache().getNumLive()
+         + getSmoothingWindowsCache().getNumLive();
+}
+
+size_t SharedTables::getLiveTableBytes()
+{
+    return getFFTTablesCache().getLiveBytes()
+         + getJuceFFTCache().getLiveBytes()
+         + getWindowCache().getLiveBytes()
+         + getPixelFrequenciesCache().getLiveBytes()
+         + getBinPixelMapCache().getLiveBytes()
+         + getSmoothingWindowsCache().getLiveBytes();
+}
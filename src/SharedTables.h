@@ -0,0 +1,59 @@
+#pragma once
+
+#include "RealFFT.h"
+#include "SpectrumSmoother.h"
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+#include <vector>
+
+/*
+ Process-wide cache of the read-only tables every instance would otherwise build for itself: FFT
+ plans, the analyzer's window and the log-frequency maps the editor draws with.  A host running
+ dozens of instances, each opening and closing editors, ends up with one copy of each table per
+ distinct key instead of one per instance, so opening the tenth editor allocates almost nothing new.
+
+ Every getter returns the table another instance is already using if there is one, or builds it.
+ The cache only keeps weak references, so a table is freed when the last user lets go of it.
+ Tables are never modified after they are built and can be read from any thread; the getters take a
+ lock and may allocate, so call them from prepare() or the message thread, never the audio thread.
+ */
+struct SharedTables
+{
+    // RealFFT's twiddles for a transform of 2^order points
+    static std::shared_ptr<const RealFFT::Tables> getFFTTables(int order);
+
+    // juce::dsp::FFT's transforms are const, so one engine per order serves every caller
+    static std::shared_ptr<const juce::dsp::FFT> getJuceFFT(int order);
+
+    // juce::dsp::WindowingFunction's normalised Blackman-Harris table, size points
+    static std::shared_ptr<const std::vector<float>> getBlackmanHarrisWindow(int size);
+
+    // the frequency at each of numPixels columns, log-spaced from minFrequency to maxFrequency
+    static std::shared_ptr<const std::vector<double>> getPixelFrequencies(int numPixels, double minFrequency, double maxFrequency);
+
+    struct BinPixelMap
+    {
+        int fftSize;
+        double sampleRate;
+        int width;
+        std::vector<float> x;       // the column each of the fftSize / 2 bins is drawn at, from 20 Hz to 20 kHz
+
+        bool matches(int otherFftSize, double otherSampleRate, int otherWidth) const
+        {
+            return fftSize == otherFftSize && sampleRate == otherSampleRate && width == otherWidth;
+        }
+    };
+
+    static std::shared_ptr<const BinPixelMap> getBinPixelMap(int fftSize, double sampleRate, int width);
+
+    static std::shared_ptr<const SpectrumSmoother::Windows> getSmoothingWindows(int fftSize, double sampleRate, AnalyzerSmoothing smoothing,
+                                                                                int numColumns, float minFrequency, float maxFrequency);
+
+    // tables currently alive across every kind, for tests and the benchmarks
+    static int getNumLiveTables();
+
+    // what they hold, for MemoryFootprint; engines whose storage JUCE keeps to itself count as their object size
+    static size_t getLiveTableBytes();
+};
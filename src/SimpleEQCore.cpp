@@ -0,0 +1,240 @@
+#include "SimpleEQCore.h"
+#include "EqEngine.h"
+
+#include <cmath>
+#include <cstring>
+#include <new>
+
+struct simpleeq_engine
+{
+    EqEngine engine;
+};
+
+namespace
+{
+// the ranges of the plugin's parameters; anything else is clamped into them
+bool toFrequency(float value, float& frequency)
+{
+    frequency = juce::jlimit(20.f, 20000.f, value);
+    return std::isfinite(value);
+}
+
+bool toGain(float value, float& gainInDecibels)
+{
+    gainInDecibels = juce::jlimit(-24.f, 24.f, value);
+    return std::isfinite(value);
+}
+
+bool toQuality(float value, float& quality)
+{
+    quality = juce::jlimit(0.1f, 10.f, value);
+    return std::isfinite(value);
+}
+
+template<typename Enum>
+bool toEnum(int32_t value, int32_t numValues, Enum& result)
+{
+    result = static_cast<Enum>(value);
+    return value >= 0 && value < numValues;
+}
+
+bool toChainSettings(const simpleeq_channel_params& params, ChainSettings& settings)
+{
+    bool valid = toFrequency(params.low_cut_freq, settings.lowCutFreq)
+              && toEnum(params.low_cut_slope, 4, settings.lowCutSlope)
+              && toFrequency(params.peak_freq, settings.peakFreq)
+              && toGain(params.peak_gain_db, settings.peakGainInDecibels)
+              && toQuality(params.peak_quality, settings.peakQuality)
+              && toFrequency(params.high_cut_freq, settings.highCutFreq)
+              && toEnum(params.high_cut_slope, 4, settings.highCutSlope)
+              && params.num_bands >= 0 && params.num_bands <= SIMPLEEQ_MAX_BANDS;
+
+    settings.loCutBypassed = params.low_cut_bypassed != 0;
+    settings.peakBypassed = params.peak_bypassed != 0;
+    settings.hiCutBypassed = params.high_cut_bypassed != 0;
+
+    auto& bands = settings.bands;
+    bands.numBands = params.num_bands;
+
+    static_assert(SIMPLEEQ_MAX_BANDS == BandTable::maxBands, "the C API's bands are the band table's");
+    for( size_t b = 0; b < (size_t)SIMPLEEQ_MAX_BANDS; ++b )
+    {
+        const auto& band = params.bands[b];
+        valid = valid
+             && toEnum(band.type, 4, bands.type[b])
+             && toFrequency(band.freq, bands.freq[b])
+             && toGain(band.gain_db, bands.gainInDecibels[b])
+             && toQuality(band.quality, bands.quality[b]);
+
+        bands.bypassed[b] = band.bypassed != 0;
+    }
+
+    return valid;
+}
+
+void toChannelParams(const ChainSettings& settings, simpleeq_channel_params& params)
+{
+    params.low_cut_freq = settings.lowCutFreq;
+    params.low_cut_slope = settings.lowCutSlope;
+    params.low_cut_bypassed = settings.loCutBypassed;
+    params.peak_freq = settings.peakFreq;
+    params.peak_gain_db = settings.peakGainInDecibels;
+    params.peak_quality = settings.peakQuality;
+    params.peak_bypassed = settings.peakBypassed;
+    params.high_cut_freq = settings.highCutFreq;
+    params.high_cut_slope = settings.highCutSlope;
+    params.high_cut_bypassed = settings.hiCutBypassed;
+
+    const auto& bands = settings.bands;
+    params.num_bands = bands.numBands;
+    for( size_t b = 0; b < (size_t)SIMPLEEQ_MAX_BANDS; ++b )
+        params.bands[b] = { bands.type[b], bands.freq[b], bands.gainInDecibels[b], bands.quality[b], bands.bypassed[b] };
+}
+}
+
+extern "C" {
+
+void simpleeq_params_init(simpleeq_params* params)
+{
+    if( params == nullptr )
+        return;
+
+    const auto defaults = EqEngine::getDefaultSettings();
+    const auto& first = defaults.channels[0];
+
+    *params = {};
+    params->struct_size = sizeof(simpleeq_params);
+    params->engine = first.engine;
+    params->channel_mode = defaults.mode;
+    params->peak_dynamic = first.peakDynamic;
+    params->dynamic_threshold_db = first.dynamicThreshold;
+    params->dynamic_ratio = first.dynamicRatio;
+    params->dynamic_attack_ms = first.dynamicAttackMs;
+    params->dynamic_release_ms = first.dynamicReleaseMs;
+
+    for( size_t ch = 0; ch < 2; ++ch )
+        toChannelParams(defaults.channels[ch], params->channels[ch]);
+}
+
+simpleeq_engine* simpleeq_create(void)
+{
+    try
+    {
+        return new simpleeq_engine();
+    }
+    catch( ... )
+    {
+        return nullptr;
+    }
+}
+
+void simpleeq_destroy(simpleeq_engine* engine)
+{
+    delete engine;
+}
+
+simpleeq_result simpleeq_prepare(simpleeq_engine* engine, double sample_rate, int32_t num_channels, int32_t max_block_size)
+{
+    if( engine == nullptr || ! (sample_rate > 0.0) || num_channels < 1 || max_block_size < 1 )
+        return SIMPLEEQ_INVALID_ARGUMENT;
+
+    try
+    {
+        engine->engine.prepare(sample_rate, num_channels, max_block_size);
+    }
+    catch( const std::bad_alloc& )
+    {
+        return SIMPLEEQ_OUT_OF_MEMORY;
+    }
+
+    return SIMPLEEQ_OK;
+}
+
+simpleeq_result simpleeq_set_params(simpleeq_engine* engine, const simpleeq_params* caller)
+{
+    if( engine == nullptr || caller == nullptr
+        || caller->struct_size < sizeof(uint32_t) || caller->struct_size % sizeof(uint32_t) != 0 )
+        return SIMPLEEQ_INVALID_ARGUMENT;
+
+    // an older caller's struct is a prefix of ours, the rest defaults; a newer one's extra fields are ignored
+    simpleeq_params full;
+    simpleeq_params_init(&full);
+    std::memcpy(&full, caller, juce::jmin((size_t)caller->struct_size, sizeof(simpleeq_params)));
+    const auto* params = &full;
+
+    EqEngine::Settings settings;
+    FilterEngine filterEngine;
+    bool valid = toEnum(params->engine, 3, filterEngine)
+              && toEnum(params->channel_mode, 3, settings.mode);
+
+    for( size_t ch = 0; ch < 2; ++ch )
+    {
+        auto& chain = settings.channels[ch];
+        valid = valid && toChainSettings(params->channels[ch], chain);
+
+        chain.engine = filterEngine;
+        chain.peakDynamic = params->peak_dynamic != 0;
+        chain.dynamicThreshold = juce::jlimit(-60.f, 0.f, params->dynamic_threshold_db);
+        chain.dynamicRatio = juce::jlimit(1.f, 20.f, params->dynamic_ratio);
+        chain.dynamicAttackMs = juce::jlimit(0.1f, 100.f, params->dynamic_attack_ms);
+        chain.dynamicReleaseMs = juce::jlimit(5.f, 2000.f, params->dynamic_release_ms);
+    }
+
+    valid = valid
+         && std::isfinite(params->dynamic_threshold_db) && std::isfinite(params->dynamic_ratio)
+         && std::isfinite(params->dynamic_attack_ms) && std::isfinite(params->dynamic_release_ms);
+
+    if( ! valid )
+        return SIMPLEEQ_INVALID_ARGUMENT;
+
+    engine->engine.setSettings(settings);
+    return SIMPLEEQ_OK;
+}
+
+simpleeq_result simpleeq_update(simpleeq_engine* engine)
+{
+    if( engine == nullptr )
+        return SIMPLEEQ_INVALID_ARGUMENT;
+
+    try
+    {
+        engine->engine.update();
+    }
+    catch( const std::bad_alloc& )
+    {
+        return SIMPLEEQ_OUT_OF_MEMORY;
+    }
+
+    return SIMPLEEQ_OK;
+}
+
+int32_t simpleeq_get_latency_samples(const simpleeq_engine* engine)
+{
+    return engine != nullptr ? engine->engine.getLatencySamples() : 0;
+}
+
+simpleeq_result simpleeq_process_planar(simpleeq_engine* engine, float* const* channels, int32_t num_channels, int32_t num_samples)
+{
+    if( engine == nullptr || channels == nullptr || num_channels < 0 || num_samples < 0 )
+        return SIMPLEEQ_INVALID_ARGUMENT;
+
+    if( ! engine->engine.isPrepared() )
+        return SIMPLEEQ_NOT_PREPARED;
+
+    engine->engine.process(channels, num_channels, num_samples);
+    return SIMPLEEQ_OK;
+}
+
+simpleeq_result simpleeq_process_interleaved(simpleeq_engine* engine, float* samples, int32_t num_channels, int32_t num_frames)
+{
+    if( engine == nullptr || samples == nullptr || num_channels < 1 || num_frames < 0 )
+        return SIMPLEEQ_INVALID_ARGUMENT;
+
+    if( ! engine->engine.isPrepared() )
+        return SIMPLEEQ_NOT_PREPARED;
+
+    engine->engine.processInterleaved(samples, num_channels, num_frames);
+    return SIMPLEEQ_OK;
+}
+
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+/*
+ C interface to the EQ's DSP, for embedding it outside a plugin host.  Link against the
+ SimpleEQCore static library; nothing here needs JUCE's headers, and the library pulls in no GUI,
+ audio-device or plugin-format code.
+
+ Threads (the library starts none of its own):
+    simpleeq_set_params()       any thread, lock-free and wait-free; only stores the parameters
+    simpleeq_update()           any thread that may lock and allocate, never the audio thread;
+                                designs the stored parameters, which the next simpleeq_process_*()
+                                picks up.  Call it after simpleeq_set_params(), or from a timer
+    simpleeq_process_*()        the audio thread; never allocates, locks or waits
+    everything else             not while simpleeq_process_*() is running on the same engine
+
+ Buffers are the caller's and are filtered in place.  Up to two channels are processed; further
+ channels are left untouched.  Calls never throw; those that can fail return a simpleeq_result.
+
+ simpleeq_params only grows at the end.  struct_size tells the library how much of it the caller
+ knows about: fields beyond a smaller struct_size keep simpleeq_params_init()'s defaults, and those
+ beyond the library's own size are ignored.  Fill it with simpleeq_params_init() before changing
+ what you need.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIMPLEEQ_MAX_BANDS 16
+
+typedef enum simpleeq_result
+{
+    SIMPLEEQ_OK = 0,
+    SIMPLEEQ_INVALID_ARGUMENT = 1,
+    SIMPLEEQ_OUT_OF_MEMORY = 2,
+    SIMPLEEQ_NOT_PREPARED = 3
+} simpleeq_result;
+
+/* values of simpleeq_params.engine */
+#define SIMPLEEQ_ENGINE_BIQUAD          0   /* biquads, redesigned once per parameter change */
+#define SIMPLEEQ_ENGINE_SVF             1   /* state-variable filters with smoothed parameters */
+#define SIMPLEEQ_ENGINE_LINEAR_PHASE    2   /* an FIR with no phase shift; see simpleeq_get_latency_samples() */
+
+/* values of simpleeq_params.channel_mode */
+#define SIMPLEEQ_LINKED_STEREO          0   /* channels[0] on both channels */
+#define SIMPLEEQ_DUAL_MONO              1   /* channels[0] on the left, channels[1] on the right */
+#define SIMPLEEQ_MID_SIDE               2   /* channels[0] on the mid, channels[1] on the side */
+
+/* values of the cut slopes: 12, 24, 36 or 48 dB per octave */
+#define SIMPLEEQ_SLOPE_12               0
+#define SIMPLEEQ_SLOPE_24               1
+#define SIMPLEEQ_SLOPE_36               2
+#define SIMPLEEQ_SLOPE_48               3
+
+/* values of simpleeq_band.type */
+#define SIMPLEEQ_BAND_BELL              0
+#define SIMPLEEQ_BAND_LOW_SHELF         1
+#define SIMPLEEQ_BAND_HIGH_SHELF        2
+#define SIMPLEEQ_BAND_NOTCH             3
+
+/* every field is 32 bits wide; flags are 0 or 1 */
+typedef struct simpleeq_band
+{
+    int32_t type;
+    float freq;                 /* Hz */
+    float gain_db;              /* ignored by notches */
+    float quality;
+    int32_t bypassed;
+} simpleeq_band;
+
+typedef struct simpleeq_channel_params
+{
+    float low_cut_freq;         /* Hz */
+    int32_t low_cut_slope;
+    int32_t low_cut_bypassed;
+
+    float peak_freq;            /* Hz */
+    float peak_gain_db;
+    float peak_quality;
+    int32_t peak_bypassed;
+
+    float high_cut_freq;        /* Hz */
+    int32_t high_cut_slope;
+    int32_t high_cut_bypassed;
+
+    int32_t num_bands;          /* how many of bands[] are used, 0 to SIMPLEEQ_MAX_BANDS */
+    simpleeq_band bands[SIMPLEEQ_MAX_BANDS];
+} simpleeq_channel_params;
+
+typedef struct simpleeq_params
+{
+    uint32_t struct_size;       /* sizeof(simpleeq_params) as the caller knows it, a multiple of 4;
+                                   set by simpleeq_params_init() */
+
+    int32_t engine;
+    int32_t channel_mode;
+
+    /* the Peak band as a dynamic EQ, moving from 0 dB towards peak_gain_db above the threshold;
+       linked stereo only, since the detector is shared by both channels */
+    int32_t peak_dynamic;
+    float dynamic_threshold_db;
+    float dynamic_ratio;
+    float dynamic_attack_ms;
+    float dynamic_release_ms;
+
+    simpleeq_channel_params channels[2];
+} simpleeq_params;
+
+typedef struct simpleeq_engine simpleeq_engine;
+
+/* the plugin's defaults: biquads, linked stereo, both cuts open, a flat Peak band, no bands */
+void simpleeq_params_init(simpleeq_params* params);
+
+/* NULL if out of memory */
+simpleeq_engine* simpleeq_create(void);
+void simpleeq_destroy(simpleeq_engine* engine);
+
+/* allocates everything processing will need; call again whenever any of these change */
+simpleeq_result simpleeq_prepare(simpleeq_engine* engine, double sample_rate, int32_t num_channels, int32_t max_block_size);
+
+simpleeq_result simpleeq_set_params(simpleeq_engine* engine, const simpleeq_params* params);
+
+/* designs the parameters stored since the last call, if any; a no-op until simpleeq_prepare(),
+   which designs whatever was stored before it */
+simpleeq_result simpleeq_update(simpleeq_engine* engine);
+
+/* the delay the linear-phase engine adds, in samples; 0 with the other engines */
+int32_t simpleeq_get_latency_samples(const simpleeq_engine* engine);
+
+/* channels[c][i], num_channels pointers to num_samples floats each */
+simpleeq_result simpleeq_process_planar(simpleeq_engine* engine, float* const* channels, int32_t num_channels, int32_t num_samples);
+
+/* samples[i * num_channels + c], num_frames frames */
+simpleeq_result simpleeq_process_interleaved(simpleeq_engine* engine, float* samples, int32_t num_channels, int32_t num_frames);
+
+#ifdef __cplusplus
+}
+#endif
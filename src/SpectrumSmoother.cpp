@@ -0,0 +1,89 @@
+#include "SpectrumSmoother.h"
+#include "SharedTables.h"
+
+#include <juce_core/juce_core.h>
+
+#include <cmath>
+
+float SpectrumSmoother::getOctaveFraction(AnalyzerSmoothing smoothing)
+{
+    switch( smoothing )
+    {
+        case SmoothingOff:          return 0.f;
+        case ThirdOctave:           return 1.f / 3.f;
+        case SixthOctave:           return 1.f / 6.f;
+        case TwelfthOctave:         return 1.f / 12.f;
+        case TwentyFourthOctave:    return 1.f / 24.f;
+    }
+
+    jassertfalse;
+    return 0.f;
+}
+
+SpectrumSmoother::Windows::Windows(int fftSize, double sampleRate, AnalyzerSmoothing smoothing,
+                                   int numColumns, float minFrequency, float maxFrequency)
+{
+    const auto numBins = fftSize / 2;
+    const auto binWidth = sampleRate / (double)fftSize;
+
+    // the window spans fraction/2 octaves either side of the centre
+    const auto halfWidth = std::exp2(0.5 * (double)getOctaveFraction(smoothing));
+
+    start.resize((size_t)numColumns);
+    end.resize((size_t)numColumns);
+
+    for( int c = 0; c < numColumns; ++c )
+    {
+        const auto proportion = numColumns > 1 ? double(c) / double(numColumns - 1) : 0.0;
+        const auto centre = juce::mapToLog10(proportion, (double)minFrequency, (double)maxFrequency) / binWidth;
+
+        // bins whose centres fall inside the band; always at least the nearest bin
+        auto first = (int)std::ceil(centre / halfWidth);
+        auto last = (int)std::floor(centre * halfWidth) + 1;
+
+        if( last <= first )
+        {
+            first = (int)std::lround(centre);
+            last = first + 1;
+        }
+
+        start[(size_t)c] = juce::jlimit(0, numBins - 1, first);
+        end[(size_t)c] = juce::jlimit(start[(size_t)c] + 1, numBins, last);
+    }
+}
+
+void SpectrumSmoother::prepare(int newFftSize, double newSampleRate, AnalyzerSmoothing newSmoothing,
+                               int newNumColumns, float newMinFrequency, float newMaxFrequency)
+{
+    if( windows != nullptr && newFftSize == fftSize && newSampleRate == sampleRate && newSmoothing == smoothing
+        && newNumColumns == numColumns && newMinFrequency == minFrequency && newMaxFrequency == maxFrequency )
+        return;
+
+    fftSize = newFftSize;
+    sampleRate = newSampleRate;
+    smoothing = newSmoothing;
+    numColumns = juce::jmax(0, newNumColumns);
+    minFrequency = newMinFrequency;
+    maxFrequency = newMaxFrequency;
+
+    windows = SharedTables::getSmoothingWindows(fftSize, sampleRate, smoothing, numColumns, minFrequency, maxFrequency);
+    powerPrefixSum.resize((size_t)fftSize / 2 + 1);
+}
+
+void SpectrumSmoother::process(const float* binPower, float* columnDecibels, float negativeInfinity)
+{
+    const auto numBins = fftSize / 2;
+
+    powerPrefixSum[0] = 0.0;
+    for( int k = 0; k < numBins; ++k )
+        powerPrefixSum[(size_t)k + 1] = powerPrefixSum[(size_t)k] + (double)binPower[k];
+
+    for( int c = 0; c < numColumns; ++c )
+    {
+        const auto start = windows->start[(size_t)c], end = windows->end[(size_t)c];
+        const auto meanPower = (powerPrefixSum[(size_t)end] - powerPrefixSum[(size_t)start]) / double(end - start);
+
+        columnDecibels[c] = meanPower > 0.0 ? juce::jmax(negativeInfinity, float(10.0 * std::log10(meanPower)))
+                                            : negativeInfinity;
+    }
+}
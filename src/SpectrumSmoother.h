@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+enum AnalyzerSmoothing
+{
+    SmoothingOff,
+    ThirdOctave,
+    SixthOctave,
+    TwelfthOctave,
+    TwentyFourthOctave
+};
+
+/*
+ Fractional-octave smoothing of an analyzer frame, evaluated straight at the display columns.
+
+ Each column's window is the band 1/N octave wide centred on the column's frequency.  Its bin
+ range depends only on the FFT size, sample rate, smoothing and column layout, so prepare()
+ fetches the windows for that layout from SharedTables, where every editor showing the same
+ layout finds the same copy; process() then builds a prefix sum over power and each column's mean power is
+ one subtraction.  A frame is O(bins + columns) whatever the smoothing width.
+
+ Averaging is done on power, not dB, so a narrow peak spreads out instead of being pulled down,
+ and the floor is applied after averaging rather than to every bin.
+ */
+class SpectrumSmoother
+{
+public:
+    static float getOctaveFraction(AnalyzerSmoothing smoothing);
+
+    // bins [start, end) per column; immutable once built
+    struct Windows
+    {
+        Windows(int fftSize, double sampleRate, AnalyzerSmoothing smoothing,
+                int numColumns, float minFrequency, float maxFrequency);
+
+        std::vector<int> start, end;
+    };
+
+    // recomputes the column windows if anything they depend on changed
+    void prepare(int fftSize, double sampleRate, AnalyzerSmoothing smoothing,
+                 int numColumns, float minFrequency, float maxFrequency);
+
+    int getNumColumns() const { return numColumns; }
+
+    // the prefix sum; the windows are shared and counted by SharedTables
+    size_t getHeapSizeInBytes() const { return powerPrefixSum.capacity() * sizeof(double); }
+
+    /**
+     reads fftSize/2 bins of normalised power (FFTDataGenerator with setProducesPower(true)) and
+     writes one dB value per column, floored at negativeInfinity.  Doesn't allocate once prepared.
+     */
+    void process(const float* binPower, float* columnDecibels, float negativeInfinity);
+
+private:
+    int fftSize = 0, numColumns = 0;
+    double sampleRate = 0.0;
+    AnalyzerSmoothing smoothing = SmoothingOff;
+    float minFrequency = 0.f, maxFrequency = 0.f;
+
+    std::shared_ptr<const Windows> windows;
+    std::vector<double> powerPrefixSum;          // numBins + 1
+};
@@ -0,0 +1,343 @@
+#include "SvfBank.h"
+#include "Instrumentation.h"
+#include "MemoryFootprint.h"
+
+namespace
+{
+constexpr double smoothingTimeSeconds = 0.02;
+}
+
+template<typename SampleType>
+size_t SvfBank<SampleType>::getHeapSizeInBytes() const
+{
+    return ::getHeapSizeInBytes(ic1eq) + ::getHeapSizeInBytes(ic2eq);
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::prepare(double newSampleRate, int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = juce::jmax(1, newNumChannels);
+
+    ic1eq.assign(size_t(numSections * numChannels), SampleType(0));
+    ic2eq.assign(size_t(numSections * numChannels), SampleType(0));
+
+    // same stage Qs as FilterDesign::design*HighOrderButterworthMethod for order 2 * (slope + 1)
+    for( int slope = 0; slope < numCutStages; ++slope )
+    {
+        const auto order = 2 * (slope + 1);
+        for( int stage = 0; stage <= slope; ++stage )
+            butterworthK[(size_t)slope][(size_t)stage] =
+                SampleType(2.0 * std::cos((2.0 * stage + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+    }
+
+    for( auto& lane : lanes )
+    {
+        for( auto* smoother : { &lane.lowCutFreq, &lane.highCutFreq, &lane.peakFreq, &lane.peakQuality } )
+            smoother->reset(sampleRate, smoothingTimeSeconds);
+        lane.peakGain.reset(sampleRate, smoothingTimeSeconds);
+
+        lane.lowCutFreq.setCurrentAndTargetValue(SampleType(20));
+        lane.highCutFreq.setCurrentAndTargetValue(SampleType(20000));
+        lane.peakFreq.setCurrentAndTargetValue(SampleType(750));
+        lane.peakQuality.setCurrentAndTargetValue(SampleType(1));
+        lane.peakGain.setCurrentAndTargetValue(SampleType(0));
+
+        for( size_t b = 0; b < (size_t)numBands; ++b )
+        {
+            lane.bandFreq[b].reset(sampleRate, smoothingTimeSeconds);
+            lane.bandQuality[b].reset(sampleRate, smoothingTimeSeconds);
+            lane.bandGain[b].reset(sampleRate, smoothingTimeSeconds);
+
+            lane.bandFreq[b].setCurrentAndTargetValue(SampleType(1000));
+            lane.bandQuality[b].setCurrentAndTargetValue(SampleType(1));
+            lane.bandGain[b].setCurrentAndTargetValue(SampleType(0));
+        }
+
+        lane.enabledMask = 0;
+        lane.numActiveSections = lane.numActiveBands = 0;
+        updateCoefficients(lane, 0);
+    }
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::reset()
+{
+    std::fill(ic1eq.begin(), ic1eq.end(), SampleType(0));
+    std::fill(ic2eq.begin(), ic2eq.end(), SampleType(0));
+
+    // jump straight to the targets so a reset doesn't glide in from stale values
+    for( auto& lane : lanes )
+    {
+        for( auto* smoother : { &lane.lowCutFreq, &lane.highCutFreq, &lane.peakFreq, &lane.peakQuality } )
+            smoother->setCurrentAndTargetValue(smoother->getTargetValue());
+        lane.peakGain.setCurrentAndTargetValue(lane.peakGain.getTargetValue());
+
+        for( size_t b = 0; b < (size_t)numBands; ++b )
+        {
+            lane.bandFreq[b].setCurrentAndTargetValue(lane.bandFreq[b].getTargetValue());
+            lane.bandQuality[b].setCurrentAndTargetValue(lane.bandQuality[b].getTargetValue());
+            lane.bandGain[b].setCurrentAndTargetValue(lane.bandGain[b].getTargetValue());
+        }
+
+        updateCoefficients(lane, 0);
+    }
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::setChannelMode(ChannelMode newMode)
+{
+    if( newMode == mode )
+        return;
+
+    // the state was built up by other settings, or in the other domain
+    mode = newMode;
+    std::fill(ic1eq.begin(), ic1eq.end(), SampleType(0));
+    std::fill(ic2eq.begin(), ic2eq.end(), SampleType(0));
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::setTargets(const ChainSettings& chainSettings, int laneIndex)
+{
+    jassert(juce::isPositiveAndBelow(laneIndex, numLanes));
+    auto& lane = lanes[(size_t)laneIndex];
+
+    lane.lowCutFreq.setTargetValue(SampleType(chainSettings.lowCutFreq));
+    lane.highCutFreq.setTargetValue(SampleType(chainSettings.highCutFreq));
+    lane.peakFreq.setTargetValue(SampleType(chainSettings.peakFreq));
+    lane.peakQuality.setTargetValue(SampleType(chainSettings.peakQuality));
+    lane.peakGain.setTargetValue(SampleType(chainSettings.peakGainInDecibels));
+
+    lane.lowCutSlope = chainSettings.lowCutSlope;
+    lane.highCutSlope = chainSettings.highCutSlope;
+
+    for( int stage = 0; stage < numCutStages; ++stage )
+    {
+        setSectionEnabled(laneIndex, lowCutStart + stage, ! chainSettings.loCutBypassed && stage <= (int)lane.lowCutSlope);
+        setSectionEnabled(laneIndex, hiCutStart + stage, ! chainSettings.hiCutBypassed && stage <= (int)lane.highCutSlope);
+    }
+    setSectionEnabled(laneIndex, peakIndex, ! chainSettings.peakBypassed && ! chainSettings.peakDynamic);
+
+    const auto& bands = chainSettings.bands;
+    lane.numActiveBands = 0;
+
+    for( int band = 0; band < numBands; ++band )
+    {
+        const auto b = (size_t)band;
+        const auto active = bands.isActive(band);
+
+        // a band coming in starts at its settings rather than gliding from wherever it was left
+        if( active && ! lane.isSectionEnabled(bandStart + band) )
+        {
+            lane.bandFreq[b].setCurrentAndTargetValue(SampleType(bands.freq[b]));
+            lane.bandQuality[b].setCurrentAndTargetValue(SampleType(bands.quality[b]));
+            lane.bandGain[b].setCurrentAndTargetValue(SampleType(bands.gainInDecibels[b]));
+        }
+        else
+        {
+            lane.bandFreq[b].setTargetValue(SampleType(bands.freq[b]));
+            lane.bandQuality[b].setTargetValue(SampleType(bands.quality[b]));
+            lane.bandGain[b].setTargetValue(SampleType(bands.gainInDecibels[b]));
+        }
+
+        lane.bandType[b] = bands.type[b];
+        setSectionEnabled(laneIndex, bandStart + band, active);
+
+        if( active )
+            lane.activeBands[(size_t)lane.numActiveBands++] = (uint8_t)band;
+    }
+
+    lane.numActiveSections = 0;
+    for( int section = 0; section < numSections; ++section )
+        if( lane.isSectionEnabled(section) )
+            lane.activeSections[(size_t)lane.numActiveSections++] = (uint8_t)section;
+}
+
+template<typename SampleType>
+SampleType SvfBank<SampleType>::prewarp(SampleType frequency) const
+{
+    // keep clear of Nyquist, where tan() blows up
+    const auto f = juce::jmin(double(frequency), 0.49 * sampleRate);
+    return SampleType(std::tan(juce::MathConstants<double>::pi * f / sampleRate));
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::setSection(Lane& lane, int index, SampleType g, SampleType k,
+                                     SampleType mix0, SampleType mix1, SampleType mix2)
+{
+    const auto i = (size_t)index;
+    lane.a1[i] = SampleType(1) / (SampleType(1) + g * (g + k));
+    lane.a2[i] = g * lane.a1[i];
+    lane.a3[i] = g * lane.a2[i];
+    lane.m0[i] = mix0;
+    lane.m1[i] = mix1;
+    lane.m2[i] = mix2;
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::setBandSection(Lane& lane, int index, BandType type, SampleType frequency,
+                                         SampleType quality, SampleType gainInDecibels) const
+{
+    const auto A = std::pow(SampleType(10), gainInDecibels / SampleType(40));
+    const auto g = prewarp(frequency);
+    const auto k = SampleType(1) / quality;
+
+    switch( type )
+    {
+        // y = v0 + k (A - 1) v1 + (A^2 - 1) v2, with the cutoff moved down by sqrt(A)
+        case LowShelfBand:
+            setSection(lane, index, g / std::sqrt(A), k, SampleType(1), k * (A - SampleType(1)), A * A - SampleType(1));
+            break;
+
+        // y = A^2 v0 + k (1 - A) A v1 + (1 - A^2) v2, with the cutoff moved up by sqrt(A)
+        case HighShelfBand:
+            setSection(lane, index, g * std::sqrt(A), k, A * A, k * (SampleType(1) - A) * A, SampleType(1) - A * A);
+            break;
+
+        // y = v0 - k v1
+        case NotchBand:
+            setSection(lane, index, g, k, SampleType(1), -k, SampleType(0));
+            break;
+
+        // bell: k = 1 / (Q A), y = v0 + k (A^2 - 1) v1
+        case BellBand:
+        {
+            const auto kBell = k / A;
+            setSection(lane, index, g, kBell, SampleType(1), kBell * (A * A - SampleType(1)), SampleType(0));
+            break;
+        }
+    }
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::setSectionEnabled(int laneIndex, int index, bool shouldBeEnabled)
+{
+    auto& lane = lanes[(size_t)laneIndex];
+    const auto bit = 1u << index;
+
+    // a stage coming back in starts from silence rather than whatever it held when it was dropped
+    if( shouldBeEnabled && (lane.enabledMask & bit) == 0 )
+    {
+        for( int ch = 0; ch < numChannels; ++ch )
+        {
+            if( getLaneForChannel(ch) != laneIndex )
+                continue;
+
+            ic1eq[size_t(index * numChannels + ch)] = SampleType(0);
+            ic2eq[size_t(index * numChannels + ch)] = SampleType(0);
+        }
+    }
+
+    lane.enabledMask = shouldBeEnabled ? (lane.enabledMask | bit) : (lane.enabledMask & ~bit);
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::updateCoefficients(Lane& lane, int numSamplesToSkip)
+{
+    // high-pass: y = v0 - k v1 - v2
+    const auto gLow = prewarp(lane.lowCutFreq.skip(numSamplesToSkip));
+    for( int stage = 0; stage < numCutStages; ++stage )
+    {
+        const auto k = butterworthK[(size_t)lane.lowCutSlope][(size_t)stage];
+        setSection(lane, lowCutStart + stage, gLow, k, SampleType(1), -k, SampleType(-1));
+    }
+
+    setBandSection(lane, peakIndex, BellBand,
+                   lane.peakFreq.skip(numSamplesToSkip), lane.peakQuality.skip(numSamplesToSkip), lane.peakGain.skip(numSamplesToSkip));
+
+    for( int a = 0; a < lane.numActiveBands; ++a )
+    {
+        const auto b = lane.activeBands[(size_t)a];
+        setBandSection(lane, bandStart + b, lane.bandType[b],
+                       lane.bandFreq[b].skip(numSamplesToSkip), lane.bandQuality[b].skip(numSamplesToSkip), lane.bandGain[b].skip(numSamplesToSkip));
+    }
+
+    // low-pass: y = v2
+    const auto gHigh = prewarp(lane.highCutFreq.skip(numSamplesToSkip));
+    for( int stage = 0; stage < numCutStages; ++stage )
+    {
+        const auto k = butterworthK[(size_t)lane.highCutSlope][(size_t)stage];
+        setSection(lane, hiCutStart + stage, gHigh, k, SampleType(0), SampleType(0), SampleType(1));
+    }
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::process(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    SIMPLEEQ_ZONE_NAMED("SvfBank::process");
+
+    jassert(isPrepared());
+
+    const auto channelsToProcess = juce::jmin((int)block.getNumChannels(), numChannels);
+    const auto numSamples = (int)block.getNumSamples();
+    const auto midSide = mode == MidSide && channelsToProcess >= 2;
+
+    for( int start = 0; start < numSamples; start += updateInterval )
+    {
+        const auto n = juce::jmin(updateInterval, numSamples - start);
+
+        for( int lane = 0; lane < getNumLanesInUse(); ++lane )
+            updateCoefficients(lanes[(size_t)lane], n);
+
+        if( midSide )
+        {
+            // encoded and decoded a sub-block at a time, while it is still in cache
+            auto* left = block.getChannelPointer(0) + start;
+            auto* right = block.getChannelPointer(1) + start;
+            std::array<SampleType, updateInterval> mid, side;
+
+            for( int i = 0; i < n; ++i )
+            {
+                mid[(size_t)i] = SampleType(0.5) * (left[i] + right[i]);
+                side[(size_t)i] = SampleType(0.5) * (left[i] - right[i]);
+            }
+
+            processRun(lanes[0], 0, mid.data(), n);
+            processRun(lanes[1], 1, side.data(), n);
+
+            for( int i = 0; i < n; ++i )
+            {
+                left[i] = mid[(size_t)i] + side[(size_t)i];
+                right[i] = mid[(size_t)i] - side[(size_t)i];
+            }
+            continue;
+        }
+
+        for( int ch = 0; ch < channelsToProcess; ++ch )
+            processRun(lanes[(size_t)getLaneForChannel(ch)], ch, block.getChannelPointer((size_t)ch) + start, n);
+    }
+}
+
+template<typename SampleType>
+void SvfBank<SampleType>::processRun(const Lane& lane, int ch, SampleType* samples, int n)
+{
+    for( int a = 0; a < lane.numActiveSections; ++a )
+    {
+        const auto s = (size_t)lane.activeSections[(size_t)a];
+        const auto sa1 = lane.a1[s], sa2 = lane.a2[s], sa3 = lane.a3[s];
+        const auto sm0 = lane.m0[s], sm1 = lane.m1[s], sm2 = lane.m2[s];
+        auto& ic1Ref = ic1eq[s * (size_t)numChannels + (size_t)ch];
+        auto& ic2Ref = ic2eq[s * (size_t)numChannels + (size_t)ch];
+        auto ic1 = ic1Ref;
+        auto ic2 = ic2Ref;
+
+        for( int i = 0; i < n; ++i )
+        {
+            const auto v0 = samples[i];
+            const auto v3 = v0 - ic2;
+            const auto v1 = sa1 * ic1 + sa2 * v3;
+            const auto v2 = ic2 + sa2 * ic1 + sa3 * v3;
+            ic1 = SampleType(2) * v1 - ic1;
+            ic2 = SampleType(2) * v2 - ic2;
+            samples[i] = sm0 * v0 + sm1 * v1 + sm2 * v2;
+        }
+
+        JUCE_SNAP_TO_ZERO(ic1);
+        JUCE_SNAP_TO_ZERO(ic2);
+        ic1Ref = ic1;
+        ic2Ref = ic2;
+    }
+}
+
+template class SvfBank<float>;
+template class SvfBank<double>;
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChainSettings.h"
+#include "FilterBank.h"
+
+#include <array>
+#include <vector>
+
+/*
+ Topology-preserving (zero-delay feedback) state-variable filters for the same sections as
+ FilterBank: four Butterworth high-pass stages, the bell, the parametric bands, four Butterworth
+ low-pass stages.
+
+ A coefficient update is one tan() per band plus a handful of multiplies, and the TPT structure
+ stays stable while its coefficients move at audio rate, so parameters are smoothed and the
+ coefficients recomputed every updateInterval samples instead of once per block.
+
+ The bilinear transform with the same prewarping as juce::dsp::FilterDesign and the RBJ cookbook
+ means the magnitude response matches the biquad engine exactly once the smoothers have settled.
+ Only the bands in use are smoothed, updated and processed, from lists rebuilt by setTargets().
+ */
+template<typename SampleType>
+class SvfBank
+{
+public:
+    static constexpr int updateInterval = 8;
+    static constexpr int numLanes = FilterBank<SampleType>::numLanes;
+    static constexpr int numCutStages = FilterBank<SampleType>::numCutStages;
+    static constexpr int lowCutStart = FilterBank<SampleType>::lowCutStart;
+    static constexpr int peakIndex = FilterBank<SampleType>::peakIndex;
+    static constexpr int bandStart = FilterBank<SampleType>::bandStart;
+    static constexpr int numBands = FilterBank<SampleType>::numBands;
+    static constexpr int hiCutStart = FilterBank<SampleType>::hiCutStart;
+    static constexpr int numSections = FilterBank<SampleType>::numSections;
+
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+    bool isPrepared() const { return numChannels > 0; }
+    size_t getHeapSizeInBytes() const;
+
+    // Linked stereo runs lane 0 on every channel and never touches lane 1; dual-mono runs lane 0 on
+    // the left and lane 1 on the right, mid/side on the mid and side, encoded and decoded a
+    // sub-block at a time around the filters.  Changing mode clears the filter state.
+    void setChannelMode(ChannelMode newMode);
+
+    // the smoothers glide towards these; slopes and bypasses take effect immediately
+    void setTargets(const ChainSettings& chainSettings, int lane = 0);
+
+    void process(const juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+    using Smoother = juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative>;
+    using LinearSmoother = juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Linear>;
+
+    // everything one set of settings drives
+    struct Lane
+    {
+        // per section: a1..a3 drive the integrators, m0..m2 mix input, band and low outputs
+        std::array<SampleType, numSections> a1 {}, a2 {}, a3 {}, m0 {}, m1 {}, m2 {};
+
+        Smoother lowCutFreq, highCutFreq, peakFreq, peakQuality;
+        LinearSmoother peakGain;
+        Slope lowCutSlope { Slope_12 }, highCutSlope { Slope_12 };
+
+        std::array<Smoother, numBands> bandFreq, bandQuality;
+        std::array<LinearSmoother, numBands> bandGain;
+        std::array<BandType, numBands> bandType {};
+
+        uint32_t enabledMask = 0;
+        std::array<uint8_t, numSections> activeSections {};
+        std::array<uint8_t, numBands> activeBands {};
+        int numActiveSections = 0, numActiveBands = 0;
+
+        bool isSectionEnabled(int index) const { return (enabledMask & (1u << index)) != 0; }
+    };
+
+    std::array<Lane, numLanes> lanes;
+    std::vector<SampleType> ic1eq, ic2eq;   // [section * numChannels + channel], channel being mid/side in that mode
+
+    // k = 1 / Q of each Butterworth stage, per slope
+    std::array<std::array<SampleType, numCutStages>, numCutStages> butterworthK {};
+
+    ChannelMode mode { LinkedStereo };
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+
+    int getNumLanesInUse() const { return mode == LinkedStereo ? 1 : numLanes; }
+    int getLaneForChannel(int channel) const { return mode == LinkedStereo ? 0 : juce::jmin(channel, numLanes - 1); }
+
+    SampleType prewarp(SampleType frequency) const;
+    static void setSection(Lane& lane, int index, SampleType g, SampleType k, SampleType mix0, SampleType mix1, SampleType mix2);
+    void setBandSection(Lane& lane, int index, BandType type, SampleType frequency, SampleType quality, SampleType gainInDecibels) const;
+    void setSectionEnabled(int laneIndex, int index, bool shouldBeEnabled);
+    void updateCoefficients(Lane& lane, int numSamplesToSkip);
+    void processRun(const Lane& lane, int channel, SampleType* samples, int numSamples);
+};
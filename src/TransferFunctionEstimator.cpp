@@ -0,0 +1,138 @@
+#include "TransferFunctionEstimator.h"
+#include "MemoryFootprint.h"
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <cmath>
+
+void TransferFunctionEstimator::prepare(int order, int newNumAverages)
+{
+    fftSize = 1 << order;
+    numAverages = juce::jmax(1, newNumAverages);
+    fft = std::make_unique<RealFFT>(order);
+
+    // periodic Hann, which sums to a constant at 50% overlap
+    window.resize((size_t)fftSize);
+    for( int n = 0; n < fftSize; ++n )
+        window[(size_t)n] = 0.5f - 0.5f * (float)std::cos(juce::MathConstants<double>::twoPi * n / fftSize);
+
+    for( auto* v : { &inputHistory, &outputHistory, &windowedInput, &windowedOutput } )
+        v->assign((size_t)fftSize, 0.f);
+
+    for( auto* v : { &inputReal, &inputImag, &outputReal, &outputImag,
+                     &inputPower, &outputPower, &crossReal, &crossImag } )
+        v->assign((size_t)getNumBins(), 0.f);
+
+    reset();
+}
+
+size_t TransferFunctionEstimator::getHeapSizeInBytes() const
+{
+    size_t bytes = fft != nullptr ? fft->getHeapSizeInBytes() : 0;
+    for( const auto* v : { &inputHistory, &outputHistory, &window, &windowedInput, &windowedOutput,
+                           &inputReal, &inputImag, &outputReal, &outputImag,
+                           &inputPower, &outputPower, &crossReal, &crossImag } )
+        bytes += ::getHeapSizeInBytes(*v);
+
+    return bytes;
+}
+
+void TransferFunctionEstimator::reset()
+{
+    std::fill(inputHistory.begin(), inputHistory.end(), 0.f);
+    std::fill(outputHistory.begin(), outputHistory.end(), 0.f);
+
+    for( auto* v : { &inputPower, &outputPower, &crossReal, &crossImag } )
+        std::fill(v->begin(), v->end(), 0.f);
+
+    writePosition = 0;
+    numSegments = 0;
+
+    // the first segment needs a full fftSize of audio, later ones a hop
+    samplesUntilSegment = fftSize;
+}
+
+int TransferFunctionEstimator::addSamples(const float* input, const float* output, int n)
+{
+    int segments = 0;
+
+    while( n > 0 )
+    {
+        // copy runs that stop at the end of the ring or at the next segment boundary
+        const auto run = juce::jmin(n, fftSize - writePosition, samplesUntilSegment);
+
+        std::copy(input, input + run, inputHistory.begin() + writePosition);
+        std::copy(output, output + run, outputHistory.begin() + writePosition);
+
+        input += run;
+        output += run;
+        n -= run;
+
+        writePosition = (writePosition + run) % fftSize;
+        samplesUntilSegment -= run;
+
+        if( samplesUntilSegment == 0 )
+        {
+            processSegment();
+            samplesUntilSegment = getHopSize();
+            ++segments;
+        }
+    }
+
+    return segments;
+}
+
+void TransferFunctionEstimator::processSegment()
+{
+    // oldest sample first: the ring starts at the write position
+    for( int n = 0; n < fftSize; ++n )
+    {
+        const auto i = size_t((writePosition + n) % fftSize);
+        windowedInput[(size_t)n] = inputHistory[i] * window[(size_t)n];
+        windowedOutput[(size_t)n] = outputHistory[i] * window[(size_t)n];
+    }
+
+    fft->performForward(windowedInput.data(), inputReal.data(), inputImag.data());
+    fft->performForward(windowedOutput.data(), outputReal.data(), outputImag.data());
+
+    ++numSegments;
+    const auto weight = 1.f / (float)juce::jmin(numSegments, numAverages);
+
+    for( size_t k = 0; k < inputPower.size(); ++k )
+    {
+        const auto xr = inputReal[k], xi = inputImag[k];
+        const auto yr = outputReal[k], yi = outputImag[k];
+
+        // conj(X) Y
+        const auto sxyReal = xr * yr + xi * yi;
+        const auto sxyImag = xr * yi - xi * yr;
+
+        inputPower[k] += weight * (xr * xr + xi * xi - inputPower[k]);
+        outputPower[k] += weight * (yr * yr + yi * yi - outputPower[k]);
+        crossReal[k] += weight * (sxyReal - crossReal[k]);
+        crossImag[k] += weight * (sxyImag - crossImag[k]);
+    }
+}
+
+void TransferFunctionEstimator::getResponse(float* magnitudeDecibels, float* coherence, float floorDecibels) const
+{
+    for( size_t k = 0; k < inputPower.size(); ++k )
+    {
+        const auto sxx = (double)inputPower[k], syy = (double)outputPower[k];
+        const auto crossSquared = (double)crossReal[k] * crossReal[k] + (double)crossImag[k] * crossImag[k];
+
+        if( sxx <= 1e-20 )
+        {
+            magnitudeDecibels[k] = floorDecibels;
+            coherence[k] = 0.f;
+            continue;
+        }
+
+        // |Sxy / Sxx| in dB is 10 log10(|Sxy|^2) - 20 log10(Sxx)
+        const auto decibels = crossSquared > 0.0 ? 10.0 * std::log10(crossSquared) - 20.0 * std::log10(sxx)
+                                                 : (double)floorDecibels;
+        magnitudeDecibels[k] = juce::jmax(floorDecibels, (float)decibels);
+        coherence[k] = syy > 0.0 ? (float)juce::jlimit(0.0, 1.0, crossSquared / (sxx * syy)) : 0.f;
+    }
+}
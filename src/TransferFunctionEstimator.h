@@ -0,0 +1,57 @@
+#pragma once
+
+#include "RealFFT.h"
+
+#include <memory>
+#include <vector>
+
+/*
+ H1 transfer-function estimate from an input and output signal, Welch-averaged.
+
+ Segments are fftSize long, Hann-windowed and overlap by half.  Each segment's auto- and
+ cross-spectra are folded into running averages: a plain mean over the first numAverages segments,
+ then an exponential average with the same time constant, so the estimate keeps following changes.
+
+     H1[k]   = Sxy[k] / Sxx[k]
+     coh[k]  = |Sxy[k]|^2 / (Sxx[k] Syy[k])
+
+ addSamples() runs at most one segment per hop of new audio, so the cost follows the audio evenly
+ instead of arriving in bursts.  Nothing allocates after prepare().
+ */
+class TransferFunctionEstimator
+{
+public:
+    void prepare(int order, int numAverages);
+    void reset();
+
+    int getFFTSize() const { return fftSize; }
+    int getNumBins() const { return fftSize / 2 + 1; }
+    int getHopSize() const { return fftSize / 2; }
+    int getNumSegments() const { return numSegments; }
+    size_t getHeapSizeInBytes() const;
+
+    // input and output are the same n samples before and after the system; returns segments completed
+    int addSamples(const float* input, const float* output, int n);
+
+    /**
+     |H1| in dB (floored at floorDecibels) and coherence in [0, 1] for the getNumBins() bins.
+     Bins with no input energy get the floor and zero coherence.
+     */
+    void getResponse(float* magnitudeDecibels, float* coherence, float floorDecibels) const;
+
+private:
+    int fftSize = 0, numAverages = 1;
+    int numSegments = 0;
+
+    // the last fftSize samples of each signal, as rings
+    std::vector<float> inputHistory, outputHistory;
+    int writePosition = 0, samplesUntilSegment = 0;
+
+    std::vector<float> window, windowedInput, windowedOutput;
+    std::vector<float> inputReal, inputImag, outputReal, outputImag;
+    std::vector<float> inputPower, outputPower, crossReal, crossImag;
+
+    std::unique_ptr<RealFFT> fft;
+
+    void processSegment();
+};
@@ -0,0 +1,124 @@
+#include "TransferFunctionMeasurement.h"
+
+#include "Instrumentation.h"
+
+#include <cmath>
+
+float TransferFunctionResponse::interpolate(const std::vector<float>& bins, double frequency) const
+{
+    if( bins.empty() || sampleRate <= 0.0 )
+        return 0.f;
+
+    const auto position = juce::jlimit(0.0, double(bins.size() - 1), frequency * fftSize / sampleRate);
+    const auto index = juce::jmin((size_t)position, bins.size() - 2);
+    const auto fraction = float(position - (double)index);
+
+    return bins[index] + fraction * (bins[index + 1] - bins[index]);
+}
+
+//==============================================================================
+TransferFunctionMeasurement::TransferFunctionMeasurement() : juce::Thread("Transfer function measurement")
+{
+}
+
+TransferFunctionMeasurement::~TransferFunctionMeasurement()
+{
+    stopThread(1000);
+}
+
+void TransferFunctionMeasurement::prepare(double newSampleRate, int maximumBlockSize, int maximumInputDelay)
+{
+    const auto wasRunning = isThreadRunning();
+    stopThread(1000);
+
+    prepared.set(false);
+    sampleRate = newSampleRate;
+
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+    inputHistory.assign(size_t(maxBlockSize + juce::jmax(0, maximumInputDelay)), 0.f);
+    historyWritePosition = 0;
+    historyLength = 0;
+    inputDelay = 0;
+    capturedSamples = 0;
+    chunkToFill.setSize(2, chunkSize);
+    chunkToFill.clear();
+    chunkIndex = 0;
+    pulledChunk.setSize(2, chunkSize);
+
+    const auto capacity = juce::jmax(4, (int)std::ceil(bufferSeconds * sampleRate / chunkSize));
+    chunks.setOverflowPolicy(DropNewest);
+    chunks.prepare(2, chunkSize, capacity);
+
+    estimator.prepare(fftOrder, numAverages);
+    prepared.set(true);
+
+    if( wasRunning )
+        startThread();
+}
+
+size_t TransferFunctionMeasurement::getHeapSizeInBytes() const
+{
+    // three responses in the triple buffer, all the size of the one the GUI reads
+    const auto& response = responses.getReadBuffer();
+    const auto responseBytes = ::getHeapSizeInBytes(response.magnitudeDecibels) + ::getHeapSizeInBytes(response.coherence);
+
+    return ::getHeapSizeInBytes(inputHistory) + ::getHeapSizeInBytes(chunkToFill) + chunks.getHeapSizeInBytes()
+         + estimator.getHeapSizeInBytes() + ::getHeapSizeInBytes(pulledChunk) + 3 * responseBytes;
+}
+
+void TransferFunctionMeasurement::setEnabled(bool shouldBeEnabled)
+{
+    if( shouldBeEnabled == enabled.get() )
+        return;
+
+    if( shouldBeEnabled )
+    {
+        // the worker isn't running, so its estimator is ours to reset
+        estimator.reset();
+        startThread();
+        enabled.set(true);
+    }
+    else
+    {
+        enabled.set(false);
+        stopThread(1000);
+    }
+}
+
+void TransferFunctionMeasurement::run()
+{
+    while( ! threadShouldExit() )
+    {
+        int segments = 0;
+
+        {
+            SIMPLEEQ_ZONE_NAMED("TransferFunctionMeasurement::run");
+
+            while( chunks.pull(pulledChunk) )
+                segments += estimator.addSamples(pulledChunk.getReadPointer(0),
+                                                 pulledChunk.getReadPointer(1),
+                                                 pulledChunk.getNumSamples());
+        }
+
+        if( segments > 0 )
+            publishResponse();
+
+        // a hop is 2048 samples, still over 10 ms at 192 kHz, so this keeps up comfortably
+        wait(10);
+    }
+}
+
+void TransferFunctionMeasurement::publishResponse()
+{
+    auto& response = responses.getWriteBuffer();
+    response.sampleRate = sampleRate;
+    response.fftSize = estimator.getFFTSize();
+    response.numSegments = estimator.getNumSegments();
+
+    // only allocates on the first few publishes or after a size change, and this is the worker
+    response.magnitudeDecibels.resize((size_t)estimator.getNumBins());
+    response.coherence.resize((size_t)estimator.getNumBins());
+    estimator.getResponse(response.magnitudeDecibels.data(), response.coherence.data(), floorDecibels);
+
+    responses.publish();
+}
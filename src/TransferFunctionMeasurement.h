@@ -0,0 +1,170 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "Fifo.h"
+#include "TransferFunctionEstimator.h"
+#include "TripleBuffer.h"
+
+#include <vector>
+
+// the newest estimate, as handed to the GUI
+struct TransferFunctionResponse
+{
+    double sampleRate = 0.0;
+    int fftSize = 0;
+    int numSegments = 0;
+    std::vector<float> magnitudeDecibels, coherence;
+
+    bool isValid() const { return numSegments > 0 && ! magnitudeDecibels.empty(); }
+
+    // interpolated between bins
+    float getMagnitudeDecibelsForFrequency(double frequency) const { return interpolate(magnitudeDecibels, frequency); }
+    float getCoherenceForFrequency(double frequency) const { return interpolate(coherence, frequency); }
+
+private:
+    float interpolate(const std::vector<float>& bins, double frequency) const;
+};
+
+/*
+ Measures what the audio path actually does to the signal, so it can be checked against the
+ curve the editor draws.
+
+ The audio thread copies channel 0 before and after the filters, a block at a time, into
+ fixed-size chunks that go through a lock-free Fifo.  The input goes through a delay line first,
+ delayed by whatever latency the filters add, so each chunk pairs an output sample with the input
+ that produced it; until the delay line holds that much input, output samples are left out.  A
+ worker thread, running only while the measurement is enabled, feeds them to a
+ TransferFunctionEstimator and publishes each new estimate through a TripleBuffer.  If the worker
+ falls behind, new chunks are dropped rather than old ones overwritten, so the audio the
+ estimator sees stays in order.
+ */
+class TransferFunctionMeasurement : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 12;          // 4096 points: ~12 Hz resolution at 48 kHz
+    static constexpr int numAverages = 32;
+    static constexpr int chunkSize = 512;
+    static constexpr double bufferSeconds = 0.5;
+    static constexpr float floorDecibels = -60.f;
+
+    TransferFunctionMeasurement();
+    ~TransferFunctionMeasurement() override;
+
+    // message thread, with the audio thread stopped; maximumInputDelay sizes the delay line
+    void prepare(double sampleRate, int maximumBlockSize, int maximumInputDelay);
+
+    // message thread; starts or stops the worker
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled.get(); }
+
+    // audio thread: captureInput() before the block is filtered, with the latency the filters
+    // will add to it, and captureOutput() after
+    template<typename SampleType>
+    void captureInput(const juce::AudioBuffer<SampleType>& buffer, int latencySamples)
+    {
+        capturing = enabled.get() && prepared.get() && buffer.getNumChannels() > 0;
+
+        // a host breaking its block size promise breaks the delay line's continuity too
+        if( capturing && buffer.getNumSamples() > maxBlockSize )
+            capturing = false;
+
+        if( ! capturing )
+        {
+            historyLength = 0;
+            return;
+        }
+
+        const auto historySize = (int)inputHistory.size();
+        capturedSamples = buffer.getNumSamples();
+        inputDelay = juce::jlimit(0, historySize - maxBlockSize, latencySamples);
+
+        auto* source = buffer.getReadPointer(0);
+        for( int i = 0; i < capturedSamples; ++i )
+        {
+            inputHistory[(size_t)historyWritePosition] = static_cast<float>(source[i]);
+            if( ++historyWritePosition == historySize )
+                historyWritePosition = 0;
+        }
+
+        historyLength = juce::jmin(historyLength + capturedSamples, historySize);
+    }
+
+    template<typename SampleType>
+    void captureOutput(const juce::AudioBuffer<SampleType>& buffer)
+    {
+        if( ! capturing )
+            return;
+
+        // output sample i came from the input inputDelay samples before it; skip the ones whose
+        // input arrived before capturing started
+        const auto historySize = (int)inputHistory.size();
+        const auto first = juce::jmax(0, capturedSamples + inputDelay - historyLength);
+        auto readPosition = (historyWritePosition - capturedSamples - inputDelay + first + historySize) % historySize;
+
+        auto* output = buffer.getReadPointer(0) + first;
+
+        for( int remaining = capturedSamples - first; remaining > 0; )
+        {
+            const auto run = juce::jmin(remaining, chunkSize - chunkIndex, historySize - readPosition);
+            const auto* input = inputHistory.data() + readPosition;
+            auto* chunkInput = chunkToFill.getWritePointer(0, chunkIndex);
+            auto* chunkOutput = chunkToFill.getWritePointer(1, chunkIndex);
+
+            for( int i = 0; i < run; ++i )
+            {
+                chunkInput[i] = input[i];
+                chunkOutput[i] = static_cast<float>(output[i]);
+            }
+
+            readPosition += run;
+            if( readPosition == historySize )
+                readPosition = 0;
+
+            output += run;
+            remaining -= run;
+            chunkIndex += run;
+
+            if( chunkIndex == chunkSize )
+            {
+                chunks.push(chunkToFill);
+                chunkIndex = 0;
+            }
+        }
+    }
+
+    // GUI side, one reader: true when a newer estimate than the one in getResponse() arrived
+    bool acquireLatestResponse() { return responses.acquireLatest(); }
+    const TransferFunctionResponse& getResponse() const { return responses.getReadBuffer(); }
+
+    // chunks the worker didn't pull in time since prepare()
+    int getNumDroppedChunks() const { return chunks.getNumDropped(); }
+
+    // message thread
+    size_t getHeapSizeInBytes() const;
+
+private:
+    juce::Atomic<bool> enabled { false }, prepared { false };
+    double sampleRate = 0.0;
+
+    // audio thread
+    bool capturing = false;
+    int maxBlockSize = 0;
+    std::vector<float> inputHistory;        // maxBlockSize + the largest delay, a ring
+    int historyWritePosition = 0;
+    int historyLength = 0;                  // how much of the ring has been written since capturing started
+    int inputDelay = 0;
+    int capturedSamples = 0;
+    juce::AudioBuffer<float> chunkToFill;   // channel 0 in, channel 1 out
+    int chunkIndex = 0;
+
+    Fifo<juce::AudioBuffer<float>> chunks;
+
+    // worker thread
+    TransferFunctionEstimator estimator;
+    juce::AudioBuffer<float> pulledChunk;
+    TripleBuffer<TransferFunctionResponse> responses;
+
+    void run() override;
+    void publishResponse();
+};
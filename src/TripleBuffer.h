@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+/*
+ Wait-free single-producer / single-consumer hand-off of a complete value.
+
+ The writer fills getWriteBuffer() and publish()es it; the reader calls acquireLatest() and, when it
+ returns true, reads getReadBuffer() until the next acquire.  Neither side ever blocks or allocates,
+ and the reader always sees the newest complete value - intermediate ones are simply skipped.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    //==============================================================================
+    // writer side
+    T& getWriteBuffer() { return buffers[(size_t)writeIndex]; }
+
+    void publish()
+    {
+        auto previous = middle.exchange(writeIndex | dirtyBit, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    //==============================================================================
+    // reader side
+    bool acquireLatest()
+    {
+        if( (middle.load(std::memory_order_relaxed) & dirtyBit) == 0 )
+            return false;
+
+        auto previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const { return buffers[(size_t)readIndex]; }
+
+private:
+    static constexpr int dirtyBit = 4;
+    static constexpr int indexMask = 3;
+
+    std::array<T, 3> buffers {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+};
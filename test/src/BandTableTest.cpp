@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "ChainSnapshot.h"
+#include "SvfBank.h"
+
+#include <vector>
+
+namespace BandTableTesting {
+    constexpr double sampleRate = 48000.0;
+
+    // one band of each type, plus a 0 dB bell that should cost nothing
+    ChainSettings makeSettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 20.f;
+        settings.highCutFreq = 20000.f;
+        settings.loCutBypassed = true;
+        settings.hiCutBypassed = true;
+        settings.peakBypassed = true;
+
+        auto& bands = settings.bands;
+        bands.numBands = 5;
+
+        const BandType types[] { BellBand, LowShelfBand, HighShelfBand, NotchBand, BellBand };
+        const float freqs[] { 1000.f, 120.f, 8000.f, 3000.f, 500.f };
+        const float gains[] { 6.f, -4.f, 3.f, 0.f, 0.f };
+
+        for( size_t b = 0; b < 5; ++b )
+        {
+            bands.type[b] = types[b];
+            bands.freq[b] = freqs[b];
+            bands.gainInDecibels[b] = gains[b];
+            bands.quality[b] = 0.8f;
+        }
+
+        return settings;
+    }
+
+    TEST(BandTable, OnlyBandsInUseWithAResponseAreActive) {
+        auto settings = makeSettings();
+        auto& bands = settings.bands;
+
+        EXPECT_EQ(0b01111u, bands.getActiveMask());
+
+        bands.bypassed[1] = true;
+        bands.numBands = 3;
+        EXPECT_EQ(0b00101u, bands.getActiveMask());
+
+        const auto snapshot = designChainSnapshot(settings, sampleRate);
+        for( int band = 0; band < BandTable::maxBands; ++band )
+            EXPECT_EQ(bands.isActive(band), snapshot.isSectionEnabled(FilterBank<double>::bandStart + band));
+    }
+
+    TEST(BandTable, SnapshotMatchesEachBandsDesign) {
+        const auto settings = makeSettings();
+        const auto snapshot = designChainSnapshot(settings, sampleRate);
+
+        for( double frequency : { 50.0, 120.0, 1000.0, 3000.0, 8000.0, 15000.0 } )
+        {
+            double expected = 1.0;
+            for( int band = 0; band < settings.bands.numBands; ++band )
+                if( settings.bands.isActive(band) )
+                    expected *= makeBandFilter<double>(settings.bands, band, sampleRate)->getMagnitudeForFrequency(frequency, sampleRate);
+
+            EXPECT_NEAR(expected, snapshot.getMagnitudeForFrequency(frequency), 1e-9) << frequency << " Hz";
+        }
+
+        EXPECT_NEAR(6.0, juce::Decibels::gainToDecibels(makeBandFilter<double>(settings.bands, 0, sampleRate)
+                                                            ->getMagnitudeForFrequency(1000.0, sampleRate)), 0.01);
+        EXPECT_LT(snapshot.getMagnitudeForFrequency(3000.0), 0.01);
+    }
+
+    TEST(BandTable, OnlyChangedBandsAreRedesigned) {
+        auto settings = makeSettings();
+        const auto first = designChainSnapshot(settings, sampleRate);
+        EXPECT_EQ(0b01111u, first.designedBandMask);
+
+        settings.bands.freq[2] = 6000.f;
+        const auto second = designChainSnapshot(settings, sampleRate, &first);
+        EXPECT_EQ(0b00100u, second.designedBandMask);
+
+        // carried-over coefficients are exactly what a full design gives
+        const auto full = designChainSnapshot(settings, sampleRate);
+        EXPECT_EQ(full.enabledMask, second.enabledMask);
+        EXPECT_EQ(full.coefficients, second.coefficients);
+
+        // a new sample rate invalidates everything
+        const auto resampled = designChainSnapshot(settings, 96000.0, &second);
+        EXPECT_EQ(0b01111u, resampled.designedBandMask);
+    }
+
+    // once the smoothers have settled, both engines are the same transfer function
+    TEST(BandTable, SvfBandsMatchBiquadBands) {
+        constexpr int numSamples = 4096;
+        const auto settings = makeSettings();
+
+        FilterBank<double> biquads;
+        biquads.prepare(2, numSamples);
+        designChainSnapshot(settings, sampleRate).applyTo(biquads);
+
+        SvfBank<double> svfs;
+        svfs.prepare(sampleRate, 2);
+        svfs.setTargets(settings);
+        svfs.reset();
+
+        std::vector<double> biquadLeft((size_t)numSamples, 0.0), biquadRight((size_t)numSamples, 0.0);
+        std::vector<double> svfLeft((size_t)numSamples, 0.0), svfRight((size_t)numSamples, 0.0);
+        biquadLeft[0] = biquadRight[0] = svfLeft[0] = svfRight[0] = 1.0;
+
+        double* biquadChannels[] { biquadLeft.data(), biquadRight.data() };
+        double* svfChannels[] { svfLeft.data(), svfRight.data() };
+
+        biquads.process(juce::dsp::AudioBlock<double>(biquadChannels, 2, (size_t)numSamples));
+        svfs.process(juce::dsp::AudioBlock<double>(svfChannels, 2, (size_t)numSamples));
+
+        // the SVF snaps tiny state to zero every update, which shows up in the impulse's tail
+        for( size_t i = 0; i < (size_t)numSamples; ++i )
+        {
+            ASSERT_NEAR(biquadLeft[i], svfLeft[i], 1e-6) << "sample " << i;
+            ASSERT_NEAR(biquadRight[i], svfRight[i], 1e-6) << "sample " << i;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "ChainSnapshot.h"
+#include "TripleBuffer.h"
+
+namespace ChainSnapshotTesting {
+    TEST(ChainSnapshot, PeakGainAtCentreFrequency) {
+        ChainSettings settings;
+        settings.lowCutFreq = 20.f;
+        settings.highCutFreq = 20000.f;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = 6.f;
+        settings.peakQuality = 1.f;
+
+        auto snapshot = designChainSnapshot(settings, 48000.0);
+
+        EXPECT_NEAR(6.0, juce::Decibels::gainToDecibels(snapshot.getMagnitudeForFrequency(1000.0)), 0.01);
+    }
+
+    TEST(ChainSnapshot, BypassedBandsAreNotEnabled) {
+        ChainSettings settings;
+        settings.lowCutFreq = 100.f;
+        settings.highCutFreq = 5000.f;
+        settings.peakFreq = 1000.f;
+        settings.lowCutSlope = Slope_48;
+        settings.loCutBypassed = true;
+        settings.peakBypassed = true;
+
+        auto snapshot = designChainSnapshot(settings, 48000.0);
+
+        for( int s = 0; s < FilterBank<double>::hiCutStart; ++s )
+            EXPECT_FALSE(snapshot.isSectionEnabled(s));
+        EXPECT_TRUE(snapshot.isSectionEnabled(FilterBank<double>::hiCutStart));
+    }
+
+    TEST(TripleBuffer, ReaderSeesOnlyTheNewestValue) {
+        TripleBuffer<int> buffer;
+        EXPECT_FALSE(buffer.acquireLatest());
+
+        buffer.getWriteBuffer() = 1;
+        buffer.publish();
+        buffer.getWriteBuffer() = 2;
+        buffer.publish();
+
+        ASSERT_TRUE(buffer.acquireLatest());
+        EXPECT_EQ(2, buffer.getReadBuffer());
+        EXPECT_FALSE(buffer.acquireLatest());
+        EXPECT_EQ(2, buffer.getReadBuffer());
+    }
+}
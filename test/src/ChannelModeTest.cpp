@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include "ChainSnapshot.h"
+#include "LinearPhaseFilter.h"
+#include "SvfBank.h"
+
+#include <random>
+#include <vector>
+
+namespace ChannelModeTesting {
+    constexpr double sampleRate = 48000.0;
+    constexpr int numSamples = 2048;
+
+    ChainSettings makeSettings(float peakGain, float lowCutFreq)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = lowCutFreq;
+        settings.highCutFreq = 12000.f;
+        settings.lowCutSlope = Slope_24;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = peakGain;
+        settings.peakQuality = 0.7f;
+
+        settings.bands.numBands = 1;
+        settings.bands.type[0] = HighShelfBand;
+        settings.bands.freq[0] = 6000.f;
+        settings.bands.gainInDecibels[0] = -peakGain / 2.f;
+        settings.bands.quality[0] = 0.7f;
+        return settings;
+    }
+
+    std::vector<double> makeNoise(unsigned seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+        std::vector<double> noise((size_t)numSamples);
+        for( auto& sample : noise )
+            sample = distribution(generator);
+        return noise;
+    }
+
+    struct StereoSignal
+    {
+        std::vector<double> left = makeNoise(1), right = makeNoise(2);
+
+        juce::dsp::AudioBlock<double> getBlock()
+        {
+            channels[0] = left.data();
+            channels[1] = right.data();
+            return juce::dsp::AudioBlock<double>(channels, 2, (size_t)numSamples);
+        }
+
+        double* channels[2] {};
+    };
+
+    template<typename Snapshot>
+    StereoSignal processBiquads(const Snapshot& snapshot)
+    {
+        FilterBank<double> bank;
+        bank.prepare(2, numSamples);
+        snapshot.applyTo(bank);
+
+        StereoSignal signal;
+        bank.process(signal.getBlock());
+        return signal;
+    }
+
+    std::vector<double> processMono(const ChainSettings& settings, std::vector<double> samples)
+    {
+        FilterBank<double> bank;
+        bank.prepare(1, numSamples);
+        designChainSnapshot(settings, sampleRate).applyTo(bank);
+
+        auto* data = samples.data();
+        bank.process(juce::dsp::AudioBlock<double>(&data, 1, samples.size()));
+        return samples;
+    }
+
+    TEST(ChannelMode, LinkedMatchesASingleChain) {
+        const auto settings = makeSettings(6.f, 80.f);
+        const auto stereo = designStereoChainSnapshot(LinkedStereo, { settings, makeSettings(-3.f, 200.f) }, sampleRate);
+        EXPECT_EQ(0b01u, stereo.designedChannelMask);
+
+        const auto linked = processBiquads(stereo);
+        const auto single = processBiquads(designChainSnapshot(settings, sampleRate));
+
+        EXPECT_EQ(single.left, linked.left);
+        EXPECT_EQ(single.right, linked.right);
+    }
+
+    TEST(ChannelMode, DualMonoRunsEachChannelsOwnChain) {
+        const auto leftSettings = makeSettings(6.f, 80.f);
+        auto rightSettings = makeSettings(-9.f, 300.f);
+        rightSettings.peakBypassed = true;      // a section the right lane passes straight through
+        rightSettings.bands.numBands = 0;
+
+        const auto dual = processBiquads(designStereoChainSnapshot(DualMono, { leftSettings, rightSettings }, sampleRate));
+        const auto left = processMono(leftSettings, makeNoise(1));
+        const auto right = processMono(rightSettings, makeNoise(2));
+
+        for( size_t i = 0; i < (size_t)numSamples; ++i )
+        {
+            ASSERT_NEAR(left[i], dual.left[i], 1e-12) << "sample " << i;
+            ASSERT_NEAR(right[i], dual.right[i], 1e-12) << "sample " << i;
+        }
+    }
+
+    TEST(ChannelMode, MidSideDecodesBackToTheChannelsFilteredAlike) {
+        const auto settings = makeSettings(6.f, 80.f);
+        const auto midSide = processBiquads(designStereoChainSnapshot(MidSide, { settings, settings }, sampleRate));
+        const auto linked = processBiquads(designChainSnapshot(settings, sampleRate));
+
+        for( size_t i = 0; i < (size_t)numSamples; ++i )
+        {
+            ASSERT_NEAR(linked.left[i], midSide.left[i], 1e-12) << "sample " << i;
+            ASSERT_NEAR(linked.right[i], midSide.right[i], 1e-12) << "sample " << i;
+        }
+    }
+
+    TEST(ChannelMode, MidSideFiltersTheSide) {
+        // cutting everything from the side leaves both channels with the mid
+        auto sideSettings = makeSettings(0.f, 20.f);
+        sideSettings.highCutFreq = 20.f;
+        sideSettings.highCutSlope = Slope_48;
+
+        const auto midSide = processBiquads(designStereoChainSnapshot(MidSide, { makeSettings(6.f, 80.f), sideSettings }, sampleRate));
+
+        const StereoSignal input;
+        double sideIn = 0.0, sideOut = 0.0;
+        for( size_t i = (size_t)numSamples / 2; i < (size_t)numSamples; ++i )
+        {
+            sideIn += std::pow(input.left[i] - input.right[i], 2.0);
+            sideOut += std::pow(midSide.left[i] - midSide.right[i], 2.0);
+        }
+
+        EXPECT_LT(juce::Decibels::gainToDecibels(std::sqrt(sideOut / sideIn)), -40.0);
+    }
+
+    TEST(ChannelMode, OnlyTheChangedChannelIsRedesigned) {
+        auto leftSettings = makeSettings(6.f, 80.f);
+        auto rightSettings = makeSettings(-3.f, 200.f);
+
+        const auto first = designStereoChainSnapshot(DualMono, { leftSettings, rightSettings }, sampleRate);
+        EXPECT_EQ(0b11u, first.designedChannelMask);
+
+        rightSettings.peakGainInDecibels = 2.f;
+        const auto second = designStereoChainSnapshot(DualMono, { leftSettings, rightSettings }, sampleRate, &first);
+        EXPECT_EQ(0b10u, second.designedChannelMask);
+        EXPECT_EQ(first.channels[0].coefficients, second.channels[0].coefficients);
+        EXPECT_EQ(designChainSnapshot(rightSettings, sampleRate).coefficients, second.channels[1].coefficients);
+
+        // linked designs the first channel alone, and going back to dual-mono with the same settings is free
+        const auto linked = designStereoChainSnapshot(LinkedStereo, { leftSettings, rightSettings }, sampleRate, &second);
+        EXPECT_EQ(0u, linked.designedChannelMask);
+
+        const auto back = designStereoChainSnapshot(MidSide, { leftSettings, rightSettings }, sampleRate, &linked);
+        EXPECT_EQ(0u, back.designedChannelMask);
+    }
+
+    // once the smoothers have settled, both engines are the same transfer function in every mode
+    TEST(ChannelMode, SvfMatchesBiquadsInEveryMode) {
+        const auto leftSettings = makeSettings(6.f, 80.f);
+        const auto rightSettings = makeSettings(-9.f, 300.f);
+
+        for( auto mode : { LinkedStereo, DualMono, MidSide } )
+        {
+            const auto snapshot = designStereoChainSnapshot(mode, { leftSettings, rightSettings }, sampleRate);
+            const auto biquads = processBiquads(snapshot);
+
+            SvfBank<double> svfs;
+            svfs.prepare(sampleRate, 2);
+            svfs.setChannelMode(mode);
+            svfs.setTargets(leftSettings, 0);
+            svfs.setTargets(rightSettings, 1);
+            svfs.reset();
+
+            StereoSignal signal;
+            svfs.process(signal.getBlock());
+
+            // the SVF snaps tiny state to zero every update
+            for( size_t i = 0; i < (size_t)numSamples; ++i )
+            {
+                ASSERT_NEAR(biquads.left[i], signal.left[i], 1e-6) << "mode " << mode << ", sample " << i;
+                ASSERT_NEAR(biquads.right[i], signal.right[i], 1e-6) << "mode " << mode << ", sample " << i;
+            }
+        }
+    }
+
+    TEST(ChannelMode, LinearPhaseRunsEachChannelsOwnKernel) {
+        constexpr int firOrder = 12;
+        constexpr int blockSize = 300;
+        const auto leftSettings = makeSettings(6.f, 80.f);
+        auto rightSettings = makeSettings(-9.f, 300.f);
+
+        auto run = [&](LinearPhaseFilter& filter, int numChannels, std::vector<float>& left, std::vector<float>& right)
+        {
+            for( size_t start = 0; start < left.size(); start += blockSize )
+            {
+                float* channels[] { left.data() + start, right.data() + start };
+                filter.process(juce::dsp::AudioBlock<float>(channels, (size_t)numChannels,
+                                                            juce::jmin((size_t)blockSize, left.size() - start)));
+            }
+        };
+
+        auto expectMatchesMono = [&](LinearPhaseFilter& stereo)
+        {
+            LinearPhaseFilter leftOnly, rightOnly;
+            leftOnly.prepare(sampleRate, 1, firOrder);
+            rightOnly.prepare(sampleRate, 1, firOrder);
+            leftOnly.designKernel(designChainSnapshot(leftSettings, sampleRate));
+            rightOnly.designKernel(designChainSnapshot(rightSettings, sampleRate));
+
+            const auto length = size_t(stereo.getLatencySamples() + stereo.getFirLength());
+            std::vector<float> left(length, 0.f), right(length, 0.f), monoLeft(length, 0.f), monoRight(length, 0.f), unused(length);
+            left[0] = monoLeft[0] = 1.f;
+            right[1] = monoRight[1] = 1.f;
+
+            run(stereo, 2, left, right);
+            run(leftOnly, 1, monoLeft, unused);
+            run(rightOnly, 1, monoRight, unused);
+
+            for( size_t i = 0; i < length; ++i )
+            {
+                ASSERT_NEAR(monoLeft[i], left[i], 1e-6f) << "sample " << i;
+                ASSERT_NEAR(monoRight[i], right[i], 1e-6f) << "sample " << i;
+            }
+        };
+
+        LinearPhaseFilter filter;
+        filter.prepare(sampleRate, 2, firOrder);
+        filter.designKernel(designStereoChainSnapshot(DualMono, { leftSettings, rightSettings }, sampleRate));
+        expectMatchesMono(filter);
+
+        // the left lane is carried over from the last kernel rather than redesigned
+        rightSettings.peakGainInDecibels = 3.f;
+        filter.designKernel(designStereoChainSnapshot(DualMono, { leftSettings, rightSettings }, sampleRate));
+        filter.reset();
+        expectMatchesMono(filter);
+    }
+
+    TEST(ChannelMode, LinearPhaseMidSideWithIdenticalLanesMatchesLinked) {
+        constexpr int firOrder = 12;
+        const auto settings = makeSettings(6.f, 80.f);
+
+        LinearPhaseFilter linked, midSide;
+        for( auto* filter : { &linked, &midSide } )
+            filter->prepare(sampleRate, 2, firOrder);
+
+        linked.designKernel(designStereoChainSnapshot(LinkedStereo, { settings, settings }, sampleRate));
+        midSide.designKernel(designStereoChainSnapshot(MidSide, { settings, settings }, sampleRate));
+
+        const auto length = size_t(linked.getLatencySamples() + linked.getFirLength());
+        std::vector<std::vector<float>> outputs;
+
+        for( auto* filter : { &linked, &midSide } )
+        {
+            std::vector<float> left(length, 0.f), right(length, 0.f);
+            left[0] = 1.f;
+            right[5] = -0.5f;
+
+            float* channels[] { left.data(), right.data() };
+            filter->process(juce::dsp::AudioBlock<float>(channels, 2, length));
+
+            outputs.push_back(left);
+            outputs.push_back(right);
+        }
+
+        for( size_t i = 0; i < length; ++i )
+        {
+            ASSERT_NEAR(outputs[0][i], outputs[2][i], 1e-6f) << "sample " << i;
+            ASSERT_NEAR(outputs[1][i], outputs[3][i], 1e-6f) << "sample " << i;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "ChainSnapshot.h"
+#include "DynamicPeak.h"
+
+namespace DynamicPeakTesting {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    ChainSettings makeSettings(float peakGain)
+    {
+        ChainSettings settings;
+        settings.peakFreq = 1000.f;
+        settings.peakQuality = 1.f;
+        settings.peakGainInDecibels = peakGain;
+        settings.peakDynamic = true;
+        settings.dynamicThreshold = -24.f;
+        settings.dynamicRatio = 4.f;
+        settings.dynamicAttackMs = 1.f;
+        settings.dynamicReleaseMs = 50.f;
+        return settings;
+    }
+
+    // runs a 1 kHz sine through the band, keyed by a constant sidechain; returns the output's last-block peak
+    float processSine(DynamicPeak<float>& peak, float amplitude, float sidechainLevel, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer(2, blockSize), key(2, blockSize);
+        float outputPeak = 0.f;
+        int n = 0;
+
+        for( int b = 0; b < numBlocks; ++b )
+        {
+            outputPeak = 0.f;
+            for( int i = 0; i < blockSize; ++i, ++n )
+            {
+                const auto x = amplitude * (float)std::sin(juce::MathConstants<double>::twoPi * 1000.0 * n / sampleRate);
+                for( int ch = 0; ch < 2; ++ch )
+                {
+                    buffer.setSample(ch, i, x);
+                    key.setSample(ch, i, sidechainLevel);
+                }
+            }
+
+            juce::dsp::AudioBlock<float> block(buffer), sidechain(key);
+            peak.process(block, sidechainLevel > 0.f ? &sidechain : nullptr);
+
+            for( int i = 0; i < blockSize; ++i )
+                outputPeak = juce::jmax(outputPeak, std::abs(buffer.getSample(0, i)));
+        }
+
+        return outputPeak;
+    }
+
+    TEST(DynamicPeak, IsTransparentBelowTheThreshold) {
+        DynamicPeak<float> peak;
+        peak.prepare(sampleRate, 2, blockSize);
+        peak.setSettings(makeSettings(-12.f));
+        ASSERT_TRUE(peak.isActive());
+
+        // -46 dBFS mean square
+        const auto outputPeak = processSine(peak, 0.007f, 0.f, 40);
+
+        EXPECT_NEAR(0.0, peak.getCurrentGainDecibels(), 1e-4);
+        EXPECT_NEAR(0.007, outputPeak, 1e-4);
+    }
+
+    TEST(DynamicPeak, SidechainSetsTheGainFromThresholdAndRatio) {
+        DynamicPeak<float> peak;
+        peak.prepare(sampleRate, 2, blockSize);
+        peak.setSettings(makeSettings(-24.f));
+
+        // a constant 0.5 key is -6.02 dB mean square: 17.98 dB over, times (1 - 1/4)
+        const auto keyDecibels = 10.f * std::log10(0.25f);
+        const auto expectedGain = -0.75f * (keyDecibels + 24.f);
+        const auto outputPeak = processSine(peak, 0.1f, 0.5f, 40);
+
+        EXPECT_NEAR(expectedGain, peak.getCurrentGainDecibels(), 0.01);
+        EXPECT_NEAR(juce::Decibels::gainToDecibels(outputPeak / 0.1f), expectedGain, 0.1);
+    }
+
+    TEST(DynamicPeak, GainStopsAtPeakGain) {
+        DynamicPeak<float> peak;
+        peak.prepare(sampleRate, 2, blockSize);
+
+        peak.setSettings(makeSettings(-6.f));
+        processSine(peak, 0.1f, 0.5f, 40);
+        EXPECT_NEAR(-6.0, peak.getCurrentGainDecibels(), 0.01);
+
+        peak.setSettings(makeSettings(6.f));
+        processSine(peak, 0.1f, 0.5f, 40);
+        EXPECT_NEAR(6.0, peak.getCurrentGainDecibels(), 0.01);
+    }
+
+    TEST(DynamicPeak, AttackSlowerThanReleaseIsKept) {
+        DynamicPeak<float> peak;
+        peak.prepare(sampleRate, 2, blockSize);
+
+        auto settings = makeSettings(-24.f);
+        settings.dynamicAttackMs = 100.f;
+        settings.dynamicReleaseMs = 5.f;
+        peak.setSettings(settings);
+
+        // one 5 ms block of a key that settles at -13.5 dB: a 100 ms attack has barely started
+        // (a 5 ms one would be most of the way there)
+        processSine(peak, 0.01f, 0.5f, 1);
+        EXPECT_GT(peak.getCurrentGainDecibels(), -6.f);
+
+        processSine(peak, 0.01f, 0.5f, 100);
+        EXPECT_NEAR(-13.49, peak.getCurrentGainDecibels(), 0.05);
+
+        // and the 5 ms release lets go within a few blocks
+        processSine(peak, 0.01f, 0.f, 4);
+        EXPECT_NEAR(0.0, peak.getCurrentGainDecibels(), 0.01);
+    }
+
+    TEST(DynamicPeak, StereoAndChannelPathsAgree) {
+        DynamicPeak<float> stereo, mono;
+        stereo.prepare(sampleRate, 2, blockSize);
+        mono.prepare(sampleRate, 1, blockSize);
+        stereo.setSettings(makeSettings(-12.f));
+        mono.setSettings(makeSettings(-12.f));
+
+        juce::AudioBuffer<float> stereoBuffer(2, blockSize), monoBuffer(1, blockSize);
+        juce::Random random(5);
+
+        for( int b = 0; b < 50; ++b )
+        {
+            // bursts above and below the threshold, so the gain keeps moving
+            const auto level = (b / 5) % 2 == 0 ? 0.9f : 0.01f;
+            for( int i = 0; i < blockSize; ++i )
+            {
+                const auto x = level * (random.nextFloat() * 2.f - 1.f);
+                stereoBuffer.setSample(0, i, x);
+                stereoBuffer.setSample(1, i, x);
+                monoBuffer.setSample(0, i, x);
+            }
+
+            juce::dsp::AudioBlock<float> stereoBlock(stereoBuffer), monoBlock(monoBuffer);
+            stereo.process(stereoBlock);
+            mono.process(monoBlock);
+
+            for( int i = 0; i < blockSize; ++i )
+            {
+                ASSERT_NEAR(monoBuffer.getSample(0, i), stereoBuffer.getSample(0, i), 1e-6f) << "block " << b << ", sample " << i;
+                ASSERT_NEAR(monoBuffer.getSample(0, i), stereoBuffer.getSample(1, i), 1e-6f) << "block " << b << ", sample " << i;
+            }
+        }
+    }
+
+    TEST(DynamicPeak, StaticSettingsLeaveTheBandToTheSnapshot) {
+        auto settings = makeSettings(-12.f);
+        settings.peakDynamic = false;
+
+        DynamicPeak<float> peak;
+        peak.prepare(sampleRate, 2, blockSize);
+        peak.setSettings(settings);
+        EXPECT_FALSE(peak.isActive());
+        EXPECT_TRUE(designChainSnapshot(settings, sampleRate).isSectionEnabled(FilterBank<double>::peakIndex));
+
+        settings.peakDynamic = true;
+        peak.setSettings(settings);
+        EXPECT_TRUE(peak.isActive());
+        EXPECT_FALSE(designChainSnapshot(settings, sampleRate).isSectionEnabled(FilterBank<double>::peakIndex));
+    }
+}
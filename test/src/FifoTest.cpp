@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "PluginProcessor.h"
+
+namespace FifoTesting {
+    using Buffer = juce::AudioBuffer<float>;
+
+    Buffer filledWith(float value, int numSamples = 64)
+    {
+        Buffer buffer(1, numSamples);
+        juce::FloatVectorOperations::fill(buffer.getWritePointer(0), value, numSamples);
+        return buffer;
+    }
+
+    TEST(Fifo, DropNewestKeepsTheQueuedEntries) {
+        Fifo<Buffer> fifo;
+        fifo.prepare(1, 64, 8);
+
+        for( int i = 0; i < 10; ++i )
+            fifo.push(filledWith(float(i)));
+
+        EXPECT_EQ(8, fifo.getNumAvailableForReading());
+        EXPECT_EQ(2, fifo.getNumDropped());
+        EXPECT_EQ(0, fifo.getNumOverwritten());
+
+        Buffer out;
+        ASSERT_TRUE(fifo.pull(out));
+        EXPECT_EQ(0.f, out.getSample(0, 0));
+    }
+
+    TEST(Fifo, OverwriteOldestKeepsTheNewestEntries) {
+        Fifo<Buffer> fifo;
+        fifo.setOverflowPolicy(OverwriteOldest);
+        fifo.prepare(1, 64, 8);
+
+        for( int i = 0; i < 10; ++i )
+            EXPECT_TRUE(fifo.push(filledWith(float(i))));
+
+        EXPECT_EQ(8, fifo.getNumAvailableForReading());
+        EXPECT_EQ(0, fifo.getNumDropped());
+        EXPECT_EQ(2, fifo.getNumOverwritten());
+
+        Buffer out;
+        for( int expected = 2; expected < 10; ++expected )
+        {
+            ASSERT_TRUE(fifo.pull(out));
+            EXPECT_EQ(float(expected), out.getSample(0, 0));
+        }
+        EXPECT_FALSE(fifo.pull(out));
+    }
+
+    TEST(Fifo, LappedReaderNeverSeesTornOrStaleEntries) {
+        Fifo<Buffer> fifo;
+        fifo.setOverflowPolicy(OverwriteOldest);
+        fifo.prepare(1, 256, 4);
+
+        constexpr int numPushes = 200000;
+        std::atomic<bool> done { false };
+
+        std::thread producer([&]
+        {
+            auto buffer = filledWith(0.f, 256);
+            for( int i = 1; i <= numPushes; ++i )
+            {
+                juce::FloatVectorOperations::fill(buffer.getWritePointer(0), float(i), 256);
+                fifo.push(buffer);
+            }
+            done = true;
+        });
+
+        Buffer out;
+        float last = 0.f;
+        int numTorn = 0, numOutOfOrder = 0;
+
+        while( ! done || fifo.getNumAvailableForReading() > 0 )
+        {
+            if( ! fifo.pull(out) )
+                continue;
+
+            auto range = juce::FloatVectorOperations::findMinAndMax(out.getReadPointer(0), out.getNumSamples());
+            numTorn += range.getStart() != range.getEnd();
+            numOutOfOrder += out.getSample(0, 0) <= last;
+            last = out.getSample(0, 0);
+        }
+
+        producer.join();
+
+        EXPECT_EQ(0, numTorn);
+        EXPECT_EQ(0, numOutOfOrder);
+        EXPECT_EQ(float(numPushes), last);
+    }
+
+    TEST(SingleChannelSampleFifo, CapacityCoversTheTargetWindow) {
+        // 100 ms at 48 kHz is 4800 samples
+        EXPECT_EQ(150, SingleChannelSampleFifo<Buffer>::getCapacityForWindow(0.1, 48000.0, 32));
+        EXPECT_EQ(10, SingleChannelSampleFifo<Buffer>::getCapacityForWindow(0.1, 48000.0, 512));
+        EXPECT_EQ(4, SingleChannelSampleFifo<Buffer>::getCapacityForWindow(0.1, 48000.0, 8192));
+    }
+}
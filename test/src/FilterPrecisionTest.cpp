@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "PluginProcessor.h"
+
+namespace FilterPrecisionTesting {
+    constexpr double sampleRate = 192000.0;
+    constexpr int blockSize = 512;
+    constexpr int numSamples = 192000;
+
+    // the worst case we ship: 48 dB/Oct cuts with the low cut parked at 20 Hz, at 192 kHz
+    ChainSettings extremeSettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 20.f;
+        settings.highCutFreq = 20000.f;
+        settings.lowCutSlope = Slope_48;
+        settings.highCutSlope = Slope_48;
+        settings.peakBypassed = true;
+        return settings;
+    }
+
+    float inputSample(int n)
+    {
+        return 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * 1000.0 * n / sampleRate);
+    }
+
+    // the same cascade in long double, fed with double-designed coefficients
+    std::vector<double> referenceOutput()
+    {
+        auto settings = extremeSettings();
+        auto sections = makeLoCutFilter<double>(settings, sampleRate);
+        sections.addArray(makeHiCutFilter<double>(settings, sampleRate));
+
+        std::vector<long double> z1((size_t)sections.size(), 0), z2((size_t)sections.size(), 0);
+        std::vector<double> out((size_t)numSamples);
+
+        for( int n = 0; n < numSamples; ++n )
+        {
+            long double x = inputSample(n);
+            for( int s = 0; s < sections.size(); ++s )
+            {
+                auto* c = sections[s]->getRawCoefficients();
+                long double y = c[0] * x + z1[(size_t)s];
+                z1[(size_t)s] = c[1] * x - c[3] * y + z2[(size_t)s];
+                z2[(size_t)s] = c[2] * x - c[4] * y;
+                x = y;
+            }
+            out[(size_t)n] = (double)x;
+        }
+        return out;
+    }
+
+    // residual against the reference over the settled second half, in dB relative to the signal
+    template<typename SampleType>
+    double noiseFloorInDecibels()
+    {
+        auto settings = extremeSettings();
+
+        FilterBank<SampleType> bank;
+        bank.prepare(2, blockSize);
+        updateCutSections(bank, FilterBank<SampleType>::lowCutStart,
+                          makeLoCutFilter<SampleType>(settings, sampleRate), settings.lowCutSlope, false);
+        updateCutSections(bank, FilterBank<SampleType>::hiCutStart,
+                          makeHiCutFilter<SampleType>(settings, sampleRate), settings.highCutSlope, false);
+
+        auto reference = referenceOutput();
+        juce::AudioBuffer<SampleType> buffer(2, blockSize);
+
+        double signalPower = 0, errorPower = 0;
+        for( int start = 0; start < numSamples; start += blockSize )
+        {
+            for( int ch = 0; ch < 2; ++ch )
+                for( int i = 0; i < blockSize; ++i )
+                    buffer.setSample(ch, i, (SampleType)inputSample(start + i));
+
+            bank.process(juce::dsp::AudioBlock<SampleType>(buffer));
+
+            if( start < numSamples / 2 )
+                continue;
+
+            for( int i = 0; i < blockSize; ++i )
+            {
+                double ref = reference[(size_t)(start + i)];
+                double err = (double)buffer.getSample(0, i) - ref;
+                signalPower += ref * ref;
+                errorPower += err * err;
+            }
+        }
+
+        return 10.0 * std::log10(errorPower / signalPower + 1e-300);
+    }
+
+    TEST(FilterPrecision, DoubleNoiseFloorIsFarBelowFloat) {
+        auto floatNoise = noiseFloorInDecibels<float>();
+        auto doubleNoise = noiseFloorInDecibels<double>();
+
+        EXPECT_LT(doubleNoise, -140.0);
+        EXPECT_LT(doubleNoise, floatNoise - 20.0);
+    }
+
+    TEST(FilterPrecision, ProcessorRunsInDoublePrecision) {
+        SimpleEQAudioProcessor processor{};
+        ASSERT_TRUE(processor.supportsDoublePrecisionProcessing());
+
+        processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<double> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        for( int i = 0; i < blockSize; ++i )
+        {
+            buffer.setSample(0, i, inputSample(i));
+            buffer.setSample(1, i, inputSample(i));
+        }
+
+        processor.processBlock(buffer, midi);
+
+        for( int ch = 0; ch < 2; ++ch )
+            for( int i = 0; i < blockSize; ++i )
+                ASSERT_TRUE(std::isfinite(buffer.getSample(ch, i)));
+    }
+}
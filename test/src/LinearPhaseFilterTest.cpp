@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "LinearPhaseFilter.h"
+
+namespace LinearPhaseFilterTesting {
+    constexpr double sampleRate = 48000.0;
+    constexpr int firOrder = 13;
+    constexpr int blockSize = 300;     // deliberately not a multiple of the partition size
+
+    ChainSettings makeSettings(float peakGain)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 100.f;
+        settings.highCutFreq = 8000.f;
+        settings.lowCutSlope = Slope_24;
+        settings.highCutSlope = Slope_12;
+        settings.peakFreq = 1000.f;
+        settings.peakGainInDecibels = peakGain;
+        settings.peakQuality = 1.f;
+        return settings;
+    }
+
+    // runs input through the filter in blockSize pieces
+    std::vector<float> process(LinearPhaseFilter& filter, std::vector<float> signal)
+    {
+        for( size_t start = 0; start < signal.size(); start += blockSize )
+        {
+            auto* data = signal.data() + start;
+            juce::dsp::AudioBlock<float> block(&data, 1, juce::jmin((size_t)blockSize, signal.size() - start));
+            filter.process(block);
+        }
+        return signal;
+    }
+
+    TEST(LinearPhaseFilter, ImpulseResponseIsSymmetricAboutTheLatency) {
+        LinearPhaseFilter filter;
+        filter.prepare(sampleRate, 1, firOrder);
+        filter.designKernel(designChainSnapshot(makeSettings(6.f), sampleRate));
+
+        const auto latency = filter.getLatencySamples();
+        EXPECT_EQ((1 << firOrder) / 2 + LinearPhaseFilter::partitionSize, latency);
+
+        std::vector<float> impulse(size_t(latency + filter.getFirLength()), 0.f);
+        impulse[0] = 1.f;
+        const auto response = process(filter, impulse);
+
+        const auto peak = std::max_element(response.begin(), response.end(),
+                                           [](float a, float b) { return std::abs(a) < std::abs(b); });
+        EXPECT_EQ(latency, (int)std::distance(response.begin(), peak));
+
+        for( int k = 1; k < filter.getFirLength() / 2; ++k )
+            ASSERT_NEAR(response[size_t(latency + k)], response[size_t(latency - k)], 1e-5f) << "tap " << k;
+    }
+
+    TEST(LinearPhaseFilter, MagnitudeMatchesTheSnapshot) {
+        LinearPhaseFilter filter;
+        filter.prepare(sampleRate, 1, firOrder);
+        const auto snapshot = designChainSnapshot(makeSettings(6.f), sampleRate);
+        filter.designKernel(snapshot);
+
+        const auto latency = filter.getLatencySamples();
+        const auto half = filter.getFirLength() / 2;
+        std::vector<float> impulse(size_t(latency + half), 0.f);
+        impulse[0] = 1.f;
+        const auto response = process(filter, impulse);
+
+        for( double frequency : { 200.0, 500.0, 1000.0, 2000.0, 4000.0, 6000.0 } )
+        {
+            std::complex<double> sum;
+            for( int n = latency - half; n < latency + half; ++n )
+                sum += double(response[(size_t)n]) * std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency * n / sampleRate);
+
+            EXPECT_NEAR(juce::Decibels::gainToDecibels(snapshot.getMagnitudeForFrequency(frequency)),
+                        juce::Decibels::gainToDecibels(std::abs(sum)), 0.1) << frequency << " Hz";
+        }
+    }
+
+    TEST(LinearPhaseFilter, CrossfadesToANewKernel) {
+        LinearPhaseFilter filter;
+        filter.prepare(sampleRate, 1, firOrder);
+        filter.designKernel(designChainSnapshot(makeSettings(0.f), sampleRate));
+
+        constexpr double frequency = 1000.0;
+        const auto fadeLength = (int)std::ceil(LinearPhaseFilter::crossfadeSeconds * sampleRate);
+        const auto length = size_t(3 * filter.getLatencySamples() + 2 * fadeLength);
+        std::vector<float> sine(length);
+        for( size_t n = 0; n < length; ++n )
+            sine[n] = 0.1f * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * double(n) / sampleRate);
+
+        // settle on the flat kernel, then switch to +12 dB at the sine's frequency
+        const auto settleLength = (size_t)(2 * filter.getLatencySamples());
+        auto output = process(filter, std::vector<float>(sine.begin(), sine.begin() + (long)settleLength));
+
+        filter.designKernel(designChainSnapshot(makeSettings(12.f), sampleRate));
+        const auto rest = process(filter, std::vector<float>(sine.begin() + (long)settleLength, sine.end()));
+        EXPECT_FALSE(filter.isCrossfading());
+        output.insert(output.end(), rest.begin(), rest.end());
+
+        auto amplitudeAround = [&](size_t centre)
+        {
+            float amplitude = 0.f;
+            for( size_t n = centre - 48; n < centre + 48; ++n )
+                amplitude = juce::jmax(amplitude, std::abs(output[n]));
+            return amplitude;
+        };
+
+        EXPECT_NEAR(0.1f, amplitudeAround(settleLength - 100), 0.003f);
+        EXPECT_NEAR(0.4f, amplitudeAround(output.size() - 100), 0.012f);
+
+        // no step anywhere: consecutive samples of a 0.4-peak 1 kHz sine differ by at most ~0.053
+        for( size_t n = 1; n < output.size(); ++n )
+            ASSERT_LT(std::abs(output[n] - output[n - 1]), 0.06f) << "sample " << n;
+    }
+}
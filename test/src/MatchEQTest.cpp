@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "MatchEQ.h"
+
+namespace MatchEQTesting {
+    constexpr double sampleRate = 48000.0;
+
+    ChainSettings makeSettings()
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 120.f;
+        settings.lowCutSlope = Slope_24;
+        settings.highCutFreq = 9000.f;
+        settings.highCutSlope = Slope_12;
+        settings.peakFreq = 2500.f;
+        settings.peakGainInDecibels = 7.f;
+        settings.peakQuality = 1.5f;
+        return settings;
+    }
+
+    juce::AudioBuffer<float> makeNoise(int numSamples)
+    {
+        juce::AudioBuffer<float> noise(2, numSamples);
+        juce::Random random(99);
+
+        for( int ch = 0; ch < noise.getNumChannels(); ++ch )
+            for( int i = 0; i < numSamples; ++i )
+                noise.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+        return noise;
+    }
+
+    juce::AudioBuffer<float> applyChain(const juce::AudioBuffer<float>& input, const ChainSettings& settings)
+    {
+        constexpr int blockSize = 512;
+
+        FilterBank<float> bank;
+        bank.prepare(input.getNumChannels(), blockSize);
+        designChainSnapshot(settings, sampleRate).applyTo(bank);
+
+        juce::AudioBuffer<float> output(input);
+        juce::dsp::AudioBlock<float> block(output);
+
+        for( size_t start = 0; start < block.getNumSamples(); start += blockSize )
+            bank.process(block.getSubBlock(start, juce::jmin((size_t)blockSize, block.getNumSamples() - start)));
+
+        return output;
+    }
+
+    TEST(ChainMagnitudeEvaluator, MatchesTheSnapshotsResponse) {
+        std::vector<double> frequencies;
+        for( int k = 0; k < 200; ++k )
+            frequencies.push_back(juce::mapToLog10(k / 199.0, 20.0, 20000.0));
+
+        ChainMagnitudeEvaluator evaluator;
+        evaluator.prepare(frequencies, sampleRate);
+
+        const auto snapshot = designChainSnapshot(makeSettings(), sampleRate);
+        std::vector<double> decibels(frequencies.size());
+        evaluator.evaluate(snapshot, decibels.data());
+
+        for( size_t k = 0; k < frequencies.size(); ++k )
+            EXPECT_NEAR(juce::Decibels::gainToDecibels(snapshot.getMagnitudeForFrequency(frequencies[k]), -300.0),
+                        decibels[k], 1e-3) << frequencies[k] << " Hz";
+    }
+
+    TEST(LongTermSpectrum, DoesNotDependOnTheNumberOfThreads) {
+        const auto noise = makeNoise(48000 * 4);
+
+        const auto single = LongTermSpectrum::analyse(noise, sampleRate, 12, 1);
+        const auto split = LongTermSpectrum::analyse(noise, sampleRate, 12, 5);
+
+        ASSERT_TRUE(single.isValid());
+        EXPECT_EQ(single.numFrames, split.numFrames);
+        EXPECT_EQ((int)single.numFrames, (48000 * 4 - 4096) / 2048 + 1);
+
+        for( size_t k = 0; k < single.power.size(); ++k )
+            ASSERT_NEAR(single.power[k], split.power[k], 1e-9 * single.power[k]) << "bin " << k;
+    }
+
+    TEST(LongTermSpectrum, ShorterThanOneFrameIsInvalid) {
+        EXPECT_FALSE(LongTermSpectrum::analyse(makeNoise(1000), sampleRate, 12).isValid());
+    }
+
+    TEST(MatchEQ, RecoversAKnownChain) {
+        const auto material = makeNoise(48000 * 20);
+        const auto reference = applyChain(material, makeSettings());
+
+        const auto result = fitMatchEQ(LongTermSpectrum::analyse(material, sampleRate, matchEQSpectrumOrder),
+                                       LongTermSpectrum::analyse(reference, sampleRate, matchEQSpectrumOrder),
+                                       sampleRate);
+
+        EXPECT_LT(result.rmsErrorDecibels, 0.75);
+        EXPECT_NEAR(2500.0, result.settings.peakFreq, 250.0);
+        EXPECT_NEAR(7.0, result.settings.peakGainInDecibels, 1.0);
+        EXPECT_NEAR(120.0, result.settings.lowCutFreq, 25.0);
+        EXPECT_EQ(Slope_24, result.settings.lowCutSlope);
+    }
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "PluginProcessor.h"
+#include "MemoryFootprint.h"
+#include "SharedTables.h"
+
+namespace MemoryFootprintTesting {
+    TEST(MemoryFootprint, SharedTablesAreNotPartOfTheInstance) {
+        MemoryFootprint footprint;
+        footprint.add("engines", 1000);
+        footprint.add("analyzer", 24);
+        footprint.add(MemoryFootprint::sharedTables, 4096);
+        footprint.add("engines", 8);
+
+        EXPECT_EQ(1008u, footprint.getBytes("engines"));
+        EXPECT_EQ(1032u, footprint.getInstanceBytes());
+        EXPECT_TRUE(footprint.toString().contains("analyzer"));
+    }
+
+    TEST(MemoryFootprint, FifoCountsItsEntries) {
+        Fifo<std::vector<int16_t>> frames;
+        frames.prepare((size_t)4096, 2);
+
+        // the entries dominate; the slots and sequence numbers are a few dozen bytes
+        const auto entryBytes = 2u * 4096u * sizeof(int16_t);
+        EXPECT_GE(frames.getHeapSizeInBytes(), entryBytes);
+        EXPECT_LT(frames.getHeapSizeInBytes(), entryBytes + 256u);
+
+        Fifo<juce::AudioBuffer<float>> buffers;
+        buffers.prepare(1, 512, 4);
+        EXPECT_GE(buffers.getHeapSizeInBytes(), 4u * 512u * sizeof(float));
+    }
+
+    TEST(MemoryFootprint, ProcessorReportsItsSubsystems) {
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(48000.0, 256);
+
+        const auto footprint = processor.getMemoryFootprint();
+
+        EXPECT_GT(footprint.getBytes("linear phase"), 0u);
+        EXPECT_GT(footprint.getBytes("filter engines"), 0u);
+
+        // two channels, each a ring of host-sized buffers covering the analyzer window
+        const auto capacity = processor.leftChannelFifo.getCapacity();
+        EXPECT_GE(footprint.getBytes("analyzer FIFOs"), 2u * size_t(capacity) * 256u * sizeof(float));
+
+        EXPECT_EQ(SharedTables::getLiveTableBytes(), footprint.getBytes(MemoryFootprint::sharedTables));
+        EXPECT_GT(footprint.getInstanceBytes(), footprint.getBytes("linear phase"));
+    }
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include "PluginProcessor.h"
+#include "PresetState.h"
+
+#include <limits>
+
+namespace PresetStateTesting {
+    TEST(BinaryState, RoundTripsAndRejectsAnythingElse) {
+        const std::vector<float> values { 1.f, -24.f, 20000.f, 0.5f };
+        juce::MemoryBlock blob;
+        BinaryState::write(values.data(), (int)values.size(), blob);
+
+        EXPECT_EQ(sizeof(BinaryState::Header) + values.size() * sizeof(float), blob.getSize());
+        ASSERT_TRUE(BinaryState::isBinaryState(blob.getData(), blob.getSize()));
+
+        std::vector<float> read(values.size());
+        EXPECT_EQ((int)values.size(), BinaryState::read(blob.getData(), blob.getSize(), read.data(), (int)read.size()));
+        EXPECT_EQ(values, read);
+
+        // truncated, or not ours at all
+        EXPECT_EQ(-1, BinaryState::read(blob.getData(), blob.getSize() - 1, read.data(), (int)read.size()));
+        const char text[] = "<?xml version=\"1.0\"?><Parameters/>";
+        EXPECT_EQ(-1, BinaryState::read(text, sizeof(text), read.data(), (int)read.size()));
+    }
+
+    TEST(BinaryState, OlderAndNewerLayoutsReadWhatOverlaps) {
+        const std::vector<float> values { 1.f, 2.f, 3.f };
+        juce::MemoryBlock blob;
+        BinaryState::write(values.data(), (int)values.size(), blob);
+
+        std::vector<float> fewer(2), more(5, -1.f);
+        EXPECT_EQ(2, BinaryState::read(blob.getData(), blob.getSize(), fewer.data(), (int)fewer.size()));
+        EXPECT_EQ(3, BinaryState::read(blob.getData(), blob.getSize(), more.data(), (int)more.size()));
+        EXPECT_EQ(-1.f, more[3]);
+    }
+
+    TEST(BinaryState, RejectsCountsBeyondTheData) {
+        std::vector<float> read(4);
+
+        for( uint32_t numValues : { BinaryState::maxValues + 1, 0x80000000u, 0xffffffffu } )
+        {
+            const BinaryState::Header header { BinaryState::magic, BinaryState::version, numValues, 0 };
+            EXPECT_FALSE(BinaryState::isBinaryState(&header, sizeof(header))) << numValues;
+            EXPECT_EQ(-1, BinaryState::read(&header, sizeof(header), read.data(), (int)read.size())) << numValues;
+        }
+    }
+
+    TEST(PresetBank, MapsWhatWasWritten) {
+        const auto file = juce::File::createTempFile("bank");
+        const std::vector<PresetBank::Preset> presets {
+            { "Flat", { 0.f, 0.f, 0.f } },
+            { "A name well over the thirty-two bytes a slot holds", { 1.f, 2.f } },
+            { "Bright", { 3.f, 4.f, 5.f, 6.f } },
+        };
+
+        ASSERT_TRUE(PresetBank::write(file, presets, 3));
+
+        PresetBank bank;
+        ASSERT_TRUE(bank.open(file));
+        EXPECT_EQ(3, bank.getNumPresets());
+        EXPECT_EQ(3, bank.getNumValues());
+
+        EXPECT_EQ(juce::String("Flat"), bank.getName(0));
+        EXPECT_EQ(PresetBank::nameLength - 1, bank.getName(1).getNumBytesAsUTF8());
+        EXPECT_EQ(juce::String("Bright"), bank.getName(2));
+
+        EXPECT_EQ(2.f, bank.getValues(1)[1]);
+        EXPECT_EQ(0.f, bank.getValues(1)[2]);      // padded
+        EXPECT_EQ(5.f, bank.getValues(2)[2]);      // truncated after this
+        EXPECT_EQ(nullptr, bank.getValues(3));
+
+        bank.close();
+        file.replaceWithText("not a bank");
+        EXPECT_FALSE(bank.open(file));
+        EXPECT_FALSE(bank.isOpen());
+        file.deleteFile();
+    }
+
+    TEST(PresetBank, RejectsCraftedCounts) {
+        const auto file = juce::File::createTempFile("bank");
+
+        // a few presets' worth of bytes behind headers claiming far more, in ways that would wrap
+        const uint32_t counts[][2] { { 1000, 2 }, { 2, 0x80000000u }, { 0xffffffffu, 0x3ffffff8u }, { 0x10000000u, 0 } };
+        for( const auto& count : counts )
+        {
+            const uint32_t header[] { PresetBank::magic, PresetBank::version, count[0], count[1] };
+            juce::MemoryBlock data(header, sizeof(header));
+            data.setSize(data.getSize() + 256, true);
+            ASSERT_TRUE(file.replaceWithData(data.getData(), data.getSize()));
+
+            PresetBank bank;
+            EXPECT_FALSE(bank.open(file)) << count[0] << " presets of " << count[1] << " values";
+            EXPECT_EQ(nullptr, bank.getValues(0));
+        }
+
+        file.deleteFile();
+    }
+
+    // the binary state is indexed by position, so a parameter inserted mid-list would restore old
+    // sessions' values into the wrong parameters; new ones go at the end, here and in the layout
+    TEST(PresetState, ParameterOrderIsPinned) {
+        juce::StringArray expected;
+
+        const auto addFilterIDs = [&expected](int channel)
+        {
+            for( const char* name : { "LoCut Freq", "HiCut Freq", "Peak Freq", "Peak Gain", "Peak Quality",
+                                      "LoCut Slope", "HiCut Slope", "LowCut Bypassed", "Peak Bypassed", "HighCut Bypassed" } )
+                expected.add(getChannelParameterID(channel, name));
+        };
+
+        const auto addBandIDs = [&expected](int channel)
+        {
+            expected.add(getChannelParameterID(channel, "Band Count"));
+            for( int band = 0; band < BandTable::maxBands; ++band )
+                for( const char* name : { "Freq", "Gain", "Quality", "Type", "Bypassed" } )
+                    expected.add(getBandParameterID(band, name, channel));
+        };
+
+        addFilterIDs(0);
+        for( const char* id : { "Analyzer Enabled", "Analyzer Smoothing", "Filter Engine", "Peak Dynamic", "Dynamic Threshold",
+                                "Dynamic Ratio", "Dynamic Attack", "Dynamic Release", "Dynamic Source" } )
+            expected.add(id);
+        addBandIDs(0);
+        expected.add("Channel Mode");
+        addFilterIDs(1);
+        addBandIDs(1);
+
+        SimpleEQAudioProcessor processor{};
+        const auto& parameters = processor.getParameters();
+        ASSERT_EQ(expected.size(), parameters.size());
+
+        for( int i = 0; i < parameters.size(); ++i )
+        {
+            auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameters[i]);
+            ASSERT_NE(nullptr, ranged);
+            EXPECT_EQ(expected[i], ranged->getParameterID()) << "index " << i;
+        }
+    }
+
+    TEST(PresetState, ProcessorRestoresItsBinaryState) {
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(48000.0, 256);
+
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.75f);     // +12 dB
+        processor.apvts.getParameter("Channel Mode")->setValueNotifyingHost(0.5f);   // dual-mono
+        processor.apvts.getParameter("Ch2 Peak Freq")->setValueNotifyingHost(0.2f);
+
+        juce::MemoryBlock state;
+        processor.getStateInformation(state);
+        EXPECT_TRUE(BinaryState::isBinaryState(state.getData(), state.getSize()));
+
+        SimpleEQAudioProcessor restored{};
+        restored.prepareToPlay(48000.0, 256);
+        restored.setStateInformation(state.getData(), (int)state.getSize());
+
+        std::vector<float> expected, actual;
+        processor.getParameterValues(expected);
+        restored.getParameterValues(actual);
+        EXPECT_EQ(expected, actual);
+
+        const auto snapshot = restored.getLatestStereoChainSnapshot();
+        EXPECT_EQ(DualMono, snapshot.mode);
+        EXPECT_EQ(12.f, snapshot.channels[0].settings.peakGainInDecibels);
+    }
+
+    TEST(PresetState, ProcessorSkipsValuesThatAreNotNumbers) {
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(48000.0, 256);
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.75f);     // +12 dB
+
+        std::vector<float> values;
+        processor.getParameterValues(values);
+
+        const auto& parameters = processor.getParameters();
+        const auto index = (size_t)parameters.indexOf(processor.apvts.getParameter("Peak Gain"));
+        const auto freqIndex = (size_t)parameters.indexOf(processor.apvts.getParameter("Peak Freq"));
+        values[index] = std::numeric_limits<float>::quiet_NaN();
+        values[freqIndex] = 1.0e9f;
+
+        juce::MemoryBlock state;
+        BinaryState::write(values.data(), (int)values.size(), state);
+        processor.setStateInformation(state.getData(), (int)state.getSize());
+
+        EXPECT_EQ(12.f, processor.apvts.getRawParameterValue("Peak Gain")->load());
+        EXPECT_EQ(20000.f, processor.apvts.getRawParameterValue("Peak Freq")->load());
+    }
+
+    TEST(PresetState, ProcessorStillReadsValueTreeStates) {
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(48000.0, 256);
+
+        // what getStateInformation wrote before the binary format
+        auto tree = processor.apvts.copyState();
+        for( auto child : tree )
+            if( child.getProperty("id").toString() == "Peak Gain" )
+                child.setProperty("value", -6.f, nullptr);
+
+        juce::MemoryBlock legacy;
+        juce::MemoryOutputStream mos(legacy, false);
+        tree.writeToStream(mos);
+        mos.flush();
+
+        processor.setStateInformation(legacy.getData(), (int)legacy.getSize());
+        EXPECT_EQ(-6.f, processor.getLatestChainSnapshot().settings.peakGainInDecibels);
+    }
+
+    TEST(PresetState, RecallingAPresetPublishesItsChain) {
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(48000.0, 256);
+
+        std::vector<float> defaults;
+        processor.getParameterValues(defaults);
+
+        auto boosted = defaults;
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(1.f);
+        processor.getParameterValues(boosted);
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.5f);
+
+        const auto file = juce::File::createTempFile("bank");
+        ASSERT_TRUE(PresetBank::write(file, { { "Default", defaults }, { "Boost", boosted } }, (int)defaults.size()));
+        ASSERT_TRUE(processor.openPresetBank(file));
+
+        ASSERT_TRUE(processor.recallPreset(1));
+        EXPECT_EQ(24.f, processor.getLatestChainSnapshot().settings.peakGainInDecibels);
+
+        ASSERT_TRUE(processor.recallPreset(0));
+        EXPECT_EQ(0.f, processor.getLatestChainSnapshot().settings.peakGainInDecibels);
+
+        EXPECT_FALSE(processor.recallPreset(2));
+        file.deleteFile();
+    }
+}
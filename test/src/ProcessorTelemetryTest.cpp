@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "PluginProcessor.h"
+#include "ProcessorTelemetry.h"
+
+namespace ProcessorTelemetryTesting {
+    TEST(LoadHistogram, BucketsCoverEveryValueOnce) {
+        for( uint32_t v = 1; v < (1u << LoadHistogram::maxValueBits); v += (v < 4096 ? 1 : 97) )
+        {
+            const auto index = LoadHistogram::getBucketIndex(v);
+            ASSERT_LE(v, LoadHistogram::getBucketUpperBound(index));
+            ASSERT_GT(v, LoadHistogram::getBucketUpperBound(index - 1));
+        }
+
+        EXPECT_EQ(LoadHistogram::numBuckets - 1, LoadHistogram::getBucketIndex((1u << LoadHistogram::maxValueBits) - 1));
+    }
+
+    TEST(LoadHistogram, PercentilesAreWithinBucketPrecision) {
+        LoadHistogram histogram;
+        for( int i = 1; i <= 1000; ++i )
+            histogram.record(i / 1000.0);
+
+        EXPECT_NEAR(0.5, histogram.getPercentile(50.0), 0.5 * 0.04);
+        EXPECT_NEAR(0.99, histogram.getPercentile(99.0), 0.99 * 0.04);
+        EXPECT_DOUBLE_EQ(1.0, histogram.getMax());
+        EXPECT_DOUBLE_EQ(1.0, histogram.getPercentile(100.0));
+
+        histogram.reset();
+        EXPECT_EQ(0u, histogram.getNumRecorded());
+        EXPECT_EQ(0.0, histogram.getPercentile(99.0));
+    }
+
+    TEST(ProcessorTelemetry, ProcessorRecordsBlocksStagesAndRedesigns) {
+        constexpr int blockSize = 256;
+        SimpleEQAudioProcessor processor{};
+        processor.prepareToPlay(48000.0, blockSize);
+
+        auto& telemetry = processor.getTelemetry();
+        telemetry.reset();
+
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.8f);
+        processor.getLatestChainSnapshot();
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        for( int b = 0; b < 10; ++b )
+        {
+            buffer.clear();
+            processor.processBlock(buffer, midi);
+        }
+
+        EXPECT_EQ(10u, telemetry.getLoadHistogram().getNumRecorded());
+        EXPECT_EQ(1u, telemetry.getNumRedesigns());
+        EXPECT_EQ(1u, telemetry.getNumSnapshotsAdopted());
+        EXPECT_EQ(10u, telemetry.getStageStats(ProcessorTelemetry::PeakStage).numBlocks);
+        EXPECT_EQ(10u, telemetry.getStageStats(ProcessorTelemetry::AnalyzerTapStage).numBlocks);
+        EXPECT_EQ(0u, telemetry.getStageStats(ProcessorTelemetry::SvfChainStage).numBlocks);
+
+        auto json = juce::JSON::parse(telemetry.toJSON());
+        EXPECT_EQ(10, (int)json["load"]["blocks"]);
+        EXPECT_TRUE(json["stages"]["lowCut"].hasProperty("maxCycles"));
+        EXPECT_EQ(1, (int)json["redesigns"]);
+    }
+
+    TEST(ProcessorTelemetry, RepublishingWithoutAChangeNeitherRedesignsNorCrossfades) {
+        constexpr int blockSize = 256;
+        SimpleEQAudioProcessor processor{};
+
+        auto* engineParameter = processor.apvts.getParameter("Filter Engine");
+        engineParameter->setValueNotifyingHost(engineParameter->convertTo0to1((float)FilterEngine::LinearPhaseEngine));
+        processor.prepareToPlay(48000.0, blockSize);
+        processor.getLatestChainSnapshot();
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        auto processBlocks = [&](int numBlocks)
+        {
+            for( int b = 0; b < numBlocks; ++b )
+            {
+                buffer.clear();
+                processor.processBlock(buffer, midi);
+            }
+        };
+
+        // past the first kernel's fade
+        processBlocks(20);
+        ASSERT_FALSE(processor.isLinearPhaseCrossfading());
+
+        auto& telemetry = processor.getTelemetry();
+        telemetry.reset();
+
+        // the analyzer isn't part of the chain, so the snapshot republishes with nothing designed
+        processor.apvts.getParameter("Analyzer Enabled")->setValueNotifyingHost(0.f);
+        processor.getLatestChainSnapshot();
+
+        processBlocks(1);
+        EXPECT_FALSE(processor.isLinearPhaseCrossfading());
+        EXPECT_EQ(0u, telemetry.getNumRedesigns());
+
+        // whereas a real change still fades in
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.8f);
+        processor.getLatestChainSnapshot();
+
+        processBlocks(1);
+        EXPECT_TRUE(processor.isLinearPhaseCrossfading());
+        EXPECT_EQ(1u, telemetry.getNumRedesigns());
+    }
+}
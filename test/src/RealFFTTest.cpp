@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "FFTBackend.h"
+#include "RealFFT.h"
+
+#include <complex>
+#include <random>
+
+namespace RealFFTTesting {
+    std::vector<float> makeNoise(int size, unsigned seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+
+        std::vector<float> noise((size_t)size);
+        for( auto& x : noise )
+            x = distribution(generator);
+
+        return noise;
+    }
+
+    std::vector<std::complex<double>> naiveDFT(const std::vector<float>& input)
+    {
+        const auto size = (int)input.size();
+        std::vector<std::complex<double>> spectrum((size_t)size / 2 + 1);
+
+        for( int k = 0; k <= size / 2; ++k )
+            for( int n = 0; n < size; ++n )
+                spectrum[(size_t)k] += (double)input[(size_t)n] * std::polar(1.0, -juce::MathConstants<double>::twoPi * k * n / size);
+
+        return spectrum;
+    }
+
+    TEST(RealFFT, ForwardMatchesDFT) {
+        for( int order = 2; order <= 11; ++order )
+        {
+            RealFFT fft(order);
+            const auto input = makeNoise(fft.getSize(), (unsigned)order);
+            const auto expected = naiveDFT(input);
+
+            std::vector<float> real((size_t)fft.getNumBins()), imag((size_t)fft.getNumBins());
+            fft.performForward(input.data(), real.data(), imag.data());
+
+            // noise has |X[k]| around sqrt(N), so compare against that scale
+            const auto tolerance = 1e-5 * std::sqrt((double)fft.getSize());
+            for( size_t k = 0; k < expected.size(); ++k )
+            {
+                ASSERT_NEAR(expected[k].real(), real[k], tolerance) << "order " << order << ", bin " << k;
+                ASSERT_NEAR(expected[k].imag(), imag[k], tolerance) << "order " << order << ", bin " << k;
+            }
+        }
+    }
+
+    TEST(RealFFT, InverseRoundTrips) {
+        for( int order = 2; order <= 13; ++order )
+        {
+            RealFFT fft(order);
+            const auto input = makeNoise(fft.getSize(), (unsigned)order);
+
+            std::vector<float> real((size_t)fft.getNumBins()), imag((size_t)fft.getNumBins()), output(input.size());
+            fft.performForward(input.data(), real.data(), imag.data());
+            fft.performInverse(real.data(), imag.data(), output.data());
+
+            for( size_t n = 0; n < input.size(); ++n )
+                ASSERT_NEAR(input[n], output[n], 1e-5f) << "order " << order << ", sample " << n;
+        }
+    }
+
+    TEST(FFTBackend, BackendsAgreeOnMagnitudes) {
+        for( int order : { 11, 12, 13 } )
+        {
+            auto juceBackend = FFTBackend::create(JuceFFTBackend, order);
+            auto bundledBackend = FFTBackend::create(BundledFFTBackend, order);
+            ASSERT_EQ(juceBackend->getNumBins(), bundledBackend->getNumBins());
+
+            const auto input = makeNoise(juceBackend->getSize(), (unsigned)order);
+            std::vector<float> expected((size_t)juceBackend->getNumBins()), actual(expected.size());
+            juceBackend->performMagnitudes(input.data(), expected.data());
+            bundledBackend->performMagnitudes(input.data(), actual.data());
+
+            const auto tolerance = 1e-5f * std::sqrt((float)juceBackend->getSize());
+            for( size_t k = 0; k < expected.size(); ++k )
+                ASSERT_NEAR(expected[k], actual[k], tolerance) << "order " << order << ", bin " << k;
+        }
+    }
+}
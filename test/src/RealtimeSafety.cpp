@@ -0,0 +1,215 @@
+#include "RealtimeSafety.h"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+#if defined(__GLIBC__)
+ #define SIMPLEEQ_REALTIME_SAFETY 1
+ #include <cerrno>
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <time.h>
+ #include <unistd.h>
+#else
+ #define SIMPLEEQ_REALTIME_SAFETY 0
+#endif
+
+namespace RealtimeSafety
+{
+namespace
+{
+    // trivially initialised, so touching these from inside malloc() never allocates
+    thread_local bool isAudioThread = false;
+    std::atomic<int> violationCounts[NumViolationKinds];
+    std::atomic<const char*> lastViolation { "" };
+}
+
+static void recordViolation(ViolationKind kind, const char* function)
+{
+    if( ! isAudioThread )
+        return;
+
+    violationCounts[kind].fetch_add(1, std::memory_order_relaxed);
+    lastViolation.store(function, std::memory_order_relaxed);
+}
+
+bool isSupported() { return SIMPLEEQ_REALTIME_SAFETY != 0; }
+
+ScopedAudioThread::ScopedAudioThread() { isAudioThread = true; }
+ScopedAudioThread::~ScopedAudioThread() { isAudioThread = false; }
+
+void resetViolations()
+{
+    for( auto& count : violationCounts )
+        count.store(0);
+
+    lastViolation.store("");
+}
+
+int getNumViolations()
+{
+    int total = 0;
+    for( auto& count : violationCounts )
+        total += count.load();
+
+    return total;
+}
+
+int getNumViolations(ViolationKind kind) { return violationCounts[kind].load(); }
+const char* getLastViolation() { return lastViolation.load(); }
+}
+
+#if SIMPLEEQ_REALTIME_SAFETY
+using RealtimeSafety::recordViolation;
+
+//==============================================================================
+// allocator: glibc exports its implementation under __libc_*, which avoids the
+// bootstrapping problem of calling dlsym() from inside malloc()
+extern "C"
+{
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+
+void* malloc(size_t size) noexcept
+{
+    recordViolation(RealtimeSafety::Allocation, "malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    recordViolation(RealtimeSafety::Allocation, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept
+{
+    recordViolation(RealtimeSafety::Allocation, "realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    recordViolation(RealtimeSafety::Allocation, "memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    recordViolation(RealtimeSafety::Allocation, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+{
+    recordViolation(RealtimeSafety::Allocation, "posix_memalign");
+
+    auto* ptr = __libc_memalign(alignment, size);
+    if( ptr == nullptr )
+        return ENOMEM;
+
+    *result = ptr;
+    return 0;
+}
+
+void free(void* ptr) noexcept
+{
+    if( ptr != nullptr )
+        recordViolation(RealtimeSafety::Deallocation, "free");
+
+    __libc_free(ptr);
+}
+}
+
+//==============================================================================
+// operator new/delete are replaced separately so reports name them rather than malloc
+static void* allocate(size_t size, size_t alignment, const char* function)
+{
+    recordViolation(RealtimeSafety::Allocation, function);
+
+    if( size == 0 )
+        size = 1;
+
+    return alignment > alignof(std::max_align_t) ? __libc_memalign(alignment, size)
+                                                 : __libc_malloc(size);
+}
+
+static void* allocateOrThrow(size_t size, size_t alignment, const char* function)
+{
+    if( auto* ptr = allocate(size, alignment, function) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+static void deallocate(void* ptr, const char* function)
+{
+    if( ptr != nullptr )
+        recordViolation(RealtimeSafety::Deallocation, function);
+
+    __libc_free(ptr);
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size, 0, "operator new"); }
+void* operator new[](size_t size) { return allocateOrThrow(size, 0, "operator new[]"); }
+void* operator new(size_t size, std::align_val_t a) { return allocateOrThrow(size, size_t(a), "operator new"); }
+void* operator new[](size_t size, std::align_val_t a) { return allocateOrThrow(size, size_t(a), "operator new[]"); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0, "operator new"); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0, "operator new[]"); }
+
+void operator delete(void* ptr) noexcept { deallocate(ptr, "operator delete"); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr, "operator delete[]"); }
+void operator delete(void* ptr, size_t) noexcept { deallocate(ptr, "operator delete"); }
+void operator delete[](void* ptr, size_t) noexcept { deallocate(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocate(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { deallocate(ptr, "operator delete[]"); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { deallocate(ptr, "operator delete"); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { deallocate(ptr, "operator delete[]"); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr, "operator delete"); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr, "operator delete[]"); }
+
+//==============================================================================
+// locks and blocking calls forward to the next definition in link order (libc)
+static void* next(std::atomic<void*>& cache, const char* name)
+{
+    auto* function = cache.load(std::memory_order_relaxed);
+
+    if( function == nullptr )
+    {
+        function = dlsym(RTLD_NEXT, name);
+        cache.store(function, std::memory_order_relaxed);
+    }
+
+    return function;
+}
+
+#define SIMPLEEQ_FORWARD(kind, name, ...)                                   \
+    recordViolation(RealtimeSafety::kind, #name);                           \
+    static std::atomic<void*> real { nullptr };                             \
+    return reinterpret_cast<decltype(&::name)>(next(real, #name))(__VA_ARGS__);
+
+extern "C"
+{
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept { SIMPLEEQ_FORWARD(Lock, pthread_mutex_lock, mutex) }
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept { SIMPLEEQ_FORWARD(Lock, pthread_rwlock_rdlock, lock) }
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept { SIMPLEEQ_FORWARD(Lock, pthread_rwlock_wrlock, lock) }
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) { SIMPLEEQ_FORWARD(BlockingCall, pthread_cond_wait, cond, mutex) }
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time) { SIMPLEEQ_FORWARD(BlockingCall, pthread_cond_timedwait, cond, mutex, time) }
+int pthread_join(pthread_t thread, void** result) { SIMPLEEQ_FORWARD(BlockingCall, pthread_join, thread, result) }
+int sem_wait(sem_t* semaphore) { SIMPLEEQ_FORWARD(BlockingCall, sem_wait, semaphore) }
+int nanosleep(const struct timespec* duration, struct timespec* remaining) { SIMPLEEQ_FORWARD(BlockingCall, nanosleep, duration, remaining) }
+int usleep(useconds_t microseconds) { SIMPLEEQ_FORWARD(BlockingCall, usleep, microseconds) }
+unsigned int sleep(unsigned int seconds) { SIMPLEEQ_FORWARD(BlockingCall, sleep, seconds) }
+ssize_t read(int fd, void* data, size_t size) { SIMPLEEQ_FORWARD(BlockingCall, read, fd, data, size) }
+ssize_t write(int fd, const void* data, size_t size) { SIMPLEEQ_FORWARD(BlockingCall, write, fd, data, size) }
+int fsync(int fd) { SIMPLEEQ_FORWARD(BlockingCall, fsync, fd) }
+}
+
+#undef SIMPLEEQ_FORWARD
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+/*
+ Test-only real-time safety checks.  The test executable interposes the allocator, pthread locks
+ and a handful of blocking system calls.  Reaching any of them from a thread that is inside a
+ ScopedAudioThread counts as a violation; every other thread is left alone.
+
+ Interposing needs glibc (__libc_malloc and friends, dlsym(RTLD_NEXT, ...)).  Elsewhere
+ isSupported() is false and nothing is counted.
+ */
+namespace RealtimeSafety
+{
+    enum ViolationKind
+    {
+        Allocation,
+        Deallocation,
+        Lock,
+        BlockingCall,
+        NumViolationKinds
+    };
+
+    bool isSupported();
+
+    // marks the calling thread as the audio thread for the lifetime of the object
+    struct ScopedAudioThread
+    {
+        ScopedAudioThread();
+        ~ScopedAudioThread();
+
+        ScopedAudioThread(const ScopedAudioThread&) = delete;
+        ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+    };
+
+    void resetViolations();
+    int getNumViolations();
+    int getNumViolations(ViolationKind kind);
+
+    // name of the most recent offending call, or an empty string
+    const char* getLastViolation();
+}
@@ -0,0 +1,322 @@
+#include <gtest/gtest.h>
+#include "PluginProcessor.h"
+#include "RealtimeSafety.h"
+
+namespace RealtimeSafetyTesting {
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    // drives one processor the way a host does: parameter changes and state restores on this
+    // thread, processBlock() on the "audio thread" (the same thread, flagged only for the call)
+    template<typename SampleType>
+    struct Host
+    {
+        Host()
+        {
+            processor.setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                     : juce::AudioProcessor::singlePrecision);
+            processor.prepareToPlay(sampleRate, blockSize);
+            buffer.setSize(2, blockSize);
+            RealtimeSafety::resetViolations();
+        }
+
+        void setParameter(const juce::String& id, float normalisedValue)
+        {
+            processor.apvts.getParameter(id)->setValueNotifyingHost(normalisedValue);
+
+            // stands in for the processor's timer, which needs a running message loop
+            processor.getLatestChainSnapshot();
+        }
+
+        void render(int numBlocks = 4)
+        {
+            for( int b = 0; b < numBlocks; ++b )
+            {
+                for( int ch = 0; ch < buffer.getNumChannels(); ++ch )
+                    for( int i = 0; i < buffer.getNumSamples(); ++i )
+                        buffer.setSample(ch, i, SampleType(random.nextFloat() * 2.f - 1.f));
+
+                RealtimeSafety::ScopedAudioThread audioThread;
+                processor.processBlock(buffer, midi);
+            }
+        }
+
+        SimpleEQAudioProcessor processor;
+        juce::AudioBuffer<SampleType> buffer;
+        juce::MidiBuffer midi;
+        juce::Random random { 1234 };
+    };
+
+    template<typename SampleType>
+    void sweepContinuousParameters()
+    {
+        Host<SampleType> host;
+
+        for( auto* id : { "LoCut Freq", "HiCut Freq", "Peak Freq", "Peak Gain", "Peak Quality" } )
+        {
+            for( int step = 0; step <= 20; ++step )
+            {
+                host.setParameter(id, step / 20.f);
+                host.render();
+            }
+        }
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void switchSlopesBypassesAndEngines()
+    {
+        Host<SampleType> host;
+
+        for( auto engine : { 0.f, 0.5f, 1.f } )
+        {
+            host.setParameter("Filter Engine", engine);
+
+            for( int slope = 0; slope < 4; ++slope )
+            {
+                host.setParameter("LoCut Slope", slope / 3.f);
+                host.setParameter("HiCut Slope", (3 - slope) / 3.f);
+                host.render();
+            }
+
+            for( auto* id : { "LowCut Bypassed", "Peak Bypassed", "HighCut Bypassed", "Analyzer Enabled" } )
+            {
+                host.setParameter(id, 1.f);
+                host.render();
+                host.setParameter(id, 0.f);
+                host.render();
+            }
+        }
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void sweepDynamicPeak()
+    {
+        Host<SampleType> host;
+        host.setParameter("Peak Gain", 0.2f);
+        host.setParameter("Peak Dynamic", 1.f);
+
+        for( auto* id : { "Dynamic Threshold", "Dynamic Ratio", "Dynamic Attack", "Dynamic Release", "Peak Freq" } )
+        {
+            for( int step = 0; step <= 10; ++step )
+            {
+                host.setParameter(id, step / 10.f);
+                host.render();
+            }
+        }
+
+        // sidechain selected but not connected falls back to the input
+        host.setParameter("Dynamic Source", 1.f);
+        host.render();
+        host.setParameter("Peak Dynamic", 0.f);
+        host.render();
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void addRemoveAndRetypeBands()
+    {
+        Host<SampleType> host;
+
+        for( auto engine : { 0.f, 0.5f } )
+        {
+            host.setParameter("Filter Engine", engine);
+
+            for( int band = 0; band < BandTable::maxBands; ++band )
+                host.setParameter(getBandParameterID(band, "Gain"), 0.7f);
+
+            // the active-band lists grow and shrink with the count
+            for( int count = 0; count <= BandTable::maxBands; count += 4 )
+            {
+                host.setParameter("Band Count", count / float(BandTable::maxBands));
+                host.render();
+            }
+
+            for( int type = 0; type < 4; ++type )
+            {
+                host.setParameter(getBandParameterID(3, "Type"), type / 3.f);
+                host.setParameter(getBandParameterID(3, "Freq"), type / 4.f);
+                host.render();
+            }
+
+            host.setParameter(getBandParameterID(5, "Bypassed"), 1.f);
+            host.render();
+            host.setParameter(getBandParameterID(5, "Bypassed"), 0.f);
+            host.render();
+        }
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void switchChannelModes()
+    {
+        Host<SampleType> host;
+
+        // every engine through every mode, with the second channel's chain moving underneath
+        for( auto engine : { 0.f, 0.5f, 1.f } )
+        {
+            host.setParameter("Filter Engine", engine);
+
+            for( auto mode : { 0.f, 0.5f, 1.f, 0.f } )
+            {
+                host.setParameter("Channel Mode", mode);
+                host.render();
+
+                host.setParameter(getChannelParameterID(1, "Peak Gain"), 0.2f + mode / 2.f);
+                host.setParameter(getBandParameterID(0, "Gain", 1), 0.8f);
+                host.setParameter(getChannelParameterID(1, "Band Count"), mode);
+                host.render(4);
+            }
+        }
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void crossfadeLinearPhaseKernels()
+    {
+        Host<SampleType> host;
+        host.setParameter("Filter Engine", 1.f);
+
+        // each change is a new kernel; some arrive mid-crossfade and have to wait
+        for( int step = 0; step <= 20; ++step )
+        {
+            host.setParameter("Peak Gain", step / 20.f);
+            host.render(step % 3 == 0 ? 16 : 1);
+        }
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void restoreStates()
+    {
+        Host<SampleType> host;
+
+        juce::MemoryBlock defaults;
+        host.processor.getStateInformation(defaults);
+
+        host.setParameter("Peak Gain", 0.9f);
+        host.setParameter("LoCut Slope", 1.f);
+        host.setParameter("Filter Engine", 1.f);
+        juce::MemoryBlock modified;
+        host.processor.getStateInformation(modified);
+
+        for( int i = 0; i < 8; ++i )
+        {
+            const auto& state = (i % 2 == 0) ? defaults : modified;
+            host.processor.setStateInformation(state.getData(), (int)state.getSize());
+            host.render();
+        }
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    template<typename SampleType>
+    void measureTransferFunction()
+    {
+        Host<SampleType> host;
+        host.processor.getMeasurement().setEnabled(true);
+
+        // ~100 chunk pushes, with the worker pulling alongside
+        host.setParameter("Peak Gain", 0.8f);
+        host.render(200);
+        host.processor.getMeasurement().setEnabled(false);
+
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations()) << RealtimeSafety::getLastViolation();
+    }
+
+    TEST(RealtimeSafety, HarnessCatchesViolationsOnTheAudioThreadOnly) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        juce::CriticalSection lock;
+        RealtimeSafety::resetViolations();
+
+        {
+            auto* ptr = ::operator new(64);
+            ::operator delete(ptr);
+            const juce::ScopedLock sl(lock);
+        }
+        EXPECT_EQ(0, RealtimeSafety::getNumViolations());
+
+        {
+            RealtimeSafety::ScopedAudioThread audioThread;
+            auto* ptr = ::operator new(64);
+            ::operator delete(ptr);
+            const juce::ScopedLock sl(lock);
+        }
+        EXPECT_EQ(1, RealtimeSafety::getNumViolations(RealtimeSafety::Allocation));
+        EXPECT_EQ(1, RealtimeSafety::getNumViolations(RealtimeSafety::Deallocation));
+        EXPECT_EQ(1, RealtimeSafety::getNumViolations(RealtimeSafety::Lock));
+    }
+
+    TEST(RealtimeSafety, ParameterSweeps) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        sweepContinuousParameters<float>();
+        sweepContinuousParameters<double>();
+    }
+
+    TEST(RealtimeSafety, SlopeBypassAndEngineChanges) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        switchSlopesBypassesAndEngines<float>();
+        switchSlopesBypassesAndEngines<double>();
+    }
+
+    TEST(RealtimeSafety, DynamicPeak) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        sweepDynamicPeak<float>();
+        sweepDynamicPeak<double>();
+    }
+
+    TEST(RealtimeSafety, BandChanges) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        addRemoveAndRetypeBands<float>();
+        addRemoveAndRetypeBands<double>();
+    }
+
+    TEST(RealtimeSafety, ChannelModeChanges) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        switchChannelModes<float>();
+        switchChannelModes<double>();
+    }
+
+    TEST(RealtimeSafety, LinearPhaseKernelSwaps) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        crossfadeLinearPhaseKernels<float>();
+        crossfadeLinearPhaseKernels<double>();
+    }
+
+    TEST(RealtimeSafety, StateRestores) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        restoreStates<float>();
+        restoreStates<double>();
+    }
+
+    TEST(RealtimeSafety, TransferFunctionMeasurement) {
+        if( ! RealtimeSafety::isSupported() )
+            GTEST_SKIP() << "allocator interposing needs glibc";
+
+        measureTransferFunction<float>();
+        measureTransferFunction<double>();
+    }
+}
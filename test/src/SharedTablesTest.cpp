@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "SharedTables.h"
+
+#include <thread>
+
+namespace SharedTablesTesting {
+    TEST(SharedTables, SameKeySharesOneTable) {
+        const auto first = SharedTables::getFFTTables(11);
+        EXPECT_EQ(first, SharedTables::getFFTTables(11));
+        EXPECT_NE(first, SharedTables::getFFTTables(12));
+
+        const auto window = SharedTables::getBlackmanHarrisWindow(2048);
+        EXPECT_EQ(window, SharedTables::getBlackmanHarrisWindow(2048));
+        EXPECT_EQ(2048u, window->size());
+
+        const auto frequencies = SharedTables::getPixelFrequencies(600, 20.0, 20000.0);
+        EXPECT_EQ(frequencies, SharedTables::getPixelFrequencies(600, 20.0, 20000.0));
+        EXPECT_NE(frequencies, SharedTables::getPixelFrequencies(601, 20.0, 20000.0));
+
+        const auto bins = SharedTables::getBinPixelMap(2048, 48000.0, 600);
+        EXPECT_EQ(bins, SharedTables::getBinPixelMap(2048, 48000.0, 600));
+        EXPECT_NE(bins, SharedTables::getBinPixelMap(2048, 44100.0, 600));
+        EXPECT_TRUE(bins->matches(2048, 48000.0, 600));
+    }
+
+    TEST(SharedTables, LastUserFreesTheTable) {
+        auto tables = SharedTables::getFFTTables(9);
+        std::weak_ptr<const RealFFT::Tables> watcher = tables;
+
+        tables.reset();
+        EXPECT_TRUE(watcher.expired());
+
+        // and the next request builds it again
+        EXPECT_NE(nullptr, SharedTables::getFFTTables(9));
+    }
+
+    TEST(SharedTables, RealFFTsOfOneOrderShareTwiddles) {
+        const auto before = SharedTables::getNumLiveTables();
+        {
+            std::vector<std::unique_ptr<RealFFT>> ffts;
+            for( int i = 0; i < 10; ++i )
+                ffts.push_back(std::make_unique<RealFFT>(10));
+
+            EXPECT_EQ(before + 1, SharedTables::getNumLiveTables());
+        }
+        EXPECT_EQ(before, SharedTables::getNumLiveTables());
+    }
+
+    TEST(SharedTables, ConcurrentRequestsGetTheSameTable) {
+        constexpr int numThreads = 8;
+        std::vector<std::shared_ptr<const SpectrumSmoother::Windows>> results(numThreads);
+
+        std::vector<std::thread> threads;
+        for( int t = 0; t < numThreads; ++t )
+            threads.emplace_back([&results, t]
+            {
+                results[(size_t)t] = SharedTables::getSmoothingWindows(8192, 48000.0, ThirdOctave, 300, 20.f, 20000.f);
+            });
+
+        for( auto& thread : threads )
+            thread.join();
+
+        for( const auto& windows : results )
+            EXPECT_EQ(results.front(), windows);
+
+        EXPECT_EQ(300u, results.front()->start.size());
+    }
+
+    TEST(SharedTables, BinPixelsMatchTheLogScale) {
+        const auto map = SharedTables::getBinPixelMap(4096, 48000.0, 500);
+        const auto binWidth = 48000.f / 4096.f;
+
+        ASSERT_EQ(2048u, map->x.size());
+        EXPECT_EQ(0.f, map->x[0]);
+
+        for( int bin : { 1, 10, 100, 1000, 2047 } )
+            EXPECT_EQ(std::floor(juce::mapFromLog10(bin * binWidth, 20.f, 20000.f) * 500.f), map->x[(size_t)bin]);
+    }
+}
@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include "SimpleEQCore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace SimpleEQCoreTesting {
+    constexpr double sampleRate = 48000.0;
+    constexpr int maxBlockSize = 256;
+    constexpr int numFrames = 4096;
+
+    struct EngineDeleter
+    {
+        void operator()(simpleeq_engine* engine) const { simpleeq_destroy(engine); }
+    };
+
+    using Engine = std::unique_ptr<simpleeq_engine, EngineDeleter>;
+
+    Engine makeEngine(const simpleeq_params& params)
+    {
+        Engine engine(simpleeq_create());
+        EXPECT_NE(engine, nullptr);
+        EXPECT_EQ(simpleeq_set_params(engine.get(), &params), SIMPLEEQ_OK);
+        EXPECT_EQ(simpleeq_prepare(engine.get(), sampleRate, 2, maxBlockSize), SIMPLEEQ_OK);
+        return engine;
+    }
+
+    simpleeq_params makeParams(int32_t engine, int32_t channelMode)
+    {
+        simpleeq_params params;
+        simpleeq_params_init(&params);
+        params.engine = engine;
+        params.channel_mode = channelMode;
+
+        for( auto& channel : params.channels )
+        {
+            channel.low_cut_freq = 80.f;
+            channel.low_cut_slope = SIMPLEEQ_SLOPE_24;
+            channel.high_cut_freq = 12000.f;
+            channel.peak_freq = 1000.f;
+            channel.peak_gain_db = 6.f;
+
+            channel.num_bands = 1;
+            channel.bands[0].type = SIMPLEEQ_BAND_HIGH_SHELF;
+            channel.bands[0].freq = 5000.f;
+            channel.bands[0].gain_db = -4.f;
+        }
+
+        params.channels[1].peak_gain_db = -9.f;
+        return params;
+    }
+
+    std::vector<float> makeNoise(unsigned seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+
+        std::vector<float> noise((size_t)numFrames);
+        for( auto& sample : noise )
+            sample = distribution(generator);
+        return noise;
+    }
+
+    // the same stereo noise through process_planar and process_interleaved on two engines
+    void expectPlanarMatchesInterleaved(const simpleeq_params& params, float tolerance)
+    {
+        auto planarEngine = makeEngine(params);
+        auto interleavedEngine = makeEngine(params);
+
+        std::vector<float> left = makeNoise(1), right = makeNoise(2);
+        std::vector<float> frames((size_t)numFrames * 2);
+        for( size_t i = 0; i < (size_t)numFrames; ++i )
+        {
+            frames[2 * i] = left[i];
+            frames[2 * i + 1] = right[i];
+        }
+
+        // odd block sizes, some above the prepared maximum
+        const int blockSizes[] { 1, 63, 256, 700, 37 };
+        size_t block = 0;
+        for( int done = 0; done < numFrames; ++block )
+        {
+            const auto n = std::min(blockSizes[block % std::size(blockSizes)], numFrames - done);
+
+            float* channels[] { left.data() + done, right.data() + done };
+            ASSERT_EQ(simpleeq_process_planar(planarEngine.get(), channels, 2, n), SIMPLEEQ_OK);
+            ASSERT_EQ(simpleeq_process_interleaved(interleavedEngine.get(), frames.data() + 2 * done, 2, n), SIMPLEEQ_OK);
+            done += n;
+        }
+
+        for( size_t i = 0; i < (size_t)numFrames; ++i )
+        {
+            ASSERT_NEAR(frames[2 * i], left[i], tolerance) << "frame " << i;
+            ASSERT_NEAR(frames[2 * i + 1], right[i], tolerance) << "frame " << i;
+        }
+    }
+
+    // interleaved stereo noise through an engine set up with params
+    std::vector<float> processNoise(const simpleeq_params& params)
+    {
+        auto engine = makeEngine(params);
+
+        const auto left = makeNoise(1), right = makeNoise(2);
+        std::vector<float> frames((size_t)numFrames * 2);
+        for( size_t i = 0; i < (size_t)numFrames; ++i )
+        {
+            frames[2 * i] = left[i];
+            frames[2 * i + 1] = right[i];
+        }
+
+        EXPECT_EQ(simpleeq_process_interleaved(engine.get(), frames.data(), 2, numFrames), SIMPLEEQ_OK);
+        return frames;
+    }
+
+    double getRms(const std::vector<float>& samples)
+    {
+        double sum = 0.0;
+        for( auto sample : samples )
+            sum += double(sample) * double(sample);
+        return std::sqrt(sum / double(samples.size()));
+    }
+}
+
+using namespace SimpleEQCoreTesting;
+
+TEST(SimpleEQCore, BiquadInterleavedMatchesPlanar)
+{
+    // in place on the frames, so only the order of the stereo arithmetic differs
+    expectPlanarMatchesInterleaved(makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_LINKED_STEREO), 1e-5f);
+    expectPlanarMatchesInterleaved(makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_DUAL_MONO), 1e-5f);
+    expectPlanarMatchesInterleaved(makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_MID_SIDE), 1e-5f);
+}
+
+TEST(SimpleEQCore, SvfInterleavedMatchesPlanar)
+{
+    // through the planar scratch, so the very same samples
+    expectPlanarMatchesInterleaved(makeParams(SIMPLEEQ_ENGINE_SVF, SIMPLEEQ_LINKED_STEREO), 0.f);
+}
+
+TEST(SimpleEQCore, DynamicPeakInterleavedMatchesPlanar)
+{
+    auto params = makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_LINKED_STEREO);
+    params.peak_dynamic = 1;
+    params.dynamic_threshold_db = -30.f;
+
+    expectPlanarMatchesInterleaved(params, 0.f);
+}
+
+TEST(SimpleEQCore, SetParamsFromAnotherThreadReachesTheAudioAfterUpdate)
+{
+    auto params = makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_LINKED_STEREO);
+    for( auto& channel : params.channels )
+    {
+        channel.peak_gain_db = 0.f;
+        channel.num_bands = 0;
+    }
+
+    auto engine = makeEngine(params);
+
+    // a 1 kHz tone, refilled for every block
+    auto processTone = [&engine]
+    {
+        std::vector<float> tone((size_t)maxBlockSize * 2);
+        for( size_t i = 0; i < tone.size() / 2; ++i )
+            tone[2 * i] = tone[2 * i + 1] = 0.25f * float(std::sin(2.0 * 3.14159265358979323846 * 1000.0 * double(i) / sampleRate));
+
+        EXPECT_EQ(simpleeq_process_interleaved(engine.get(), tone.data(), 2, maxBlockSize), SIMPLEEQ_OK);
+        return getRms(tone);
+    };
+
+    const auto flatRms = processTone();
+
+    for( auto& channel : params.channels )
+        channel.peak_gain_db = 12.f;
+
+    std::thread([&] { EXPECT_EQ(simpleeq_set_params(engine.get(), &params), SIMPLEEQ_OK); }).join();
+
+    // stored, but nothing is designed until someone calls update
+    EXPECT_LT(processTone(), flatRms * 1.1);
+
+    std::thread([&] { EXPECT_EQ(simpleeq_update(engine.get()), SIMPLEEQ_OK); }).join();
+    EXPECT_GT(processTone(), flatRms * 2.0);
+}
+
+TEST(SimpleEQCore, OlderCallersGetDefaultsForFieldsTheyDontKnow)
+{
+    const auto params = makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_DUAL_MONO);
+
+    // a caller whose struct ends after channels[0], so channels[1]'s -9 dB peak isn't theirs to set
+    auto older = params;
+    older.struct_size = uint32_t(offsetof(simpleeq_params, channels) + sizeof(simpleeq_channel_params));
+
+    simpleeq_params defaults;
+    simpleeq_params_init(&defaults);
+    auto expected = params;
+    expected.channels[1] = defaults.channels[1];
+
+    EXPECT_EQ(processNoise(expected), processNoise(older));
+    EXPECT_NE(processNoise(params), processNoise(older));
+
+    // and a newer caller's fields beyond ours are ignored
+    struct
+    {
+        simpleeq_params params;
+        uint32_t fieldsFromTheFuture[8];
+    } newer { params, { 1, 2, 3, 4, 5, 6, 7, 8 } };
+    newer.params.struct_size = sizeof(newer);
+
+    Engine engine(simpleeq_create());
+    EXPECT_EQ(simpleeq_set_params(engine.get(), &newer.params), SIMPLEEQ_OK);
+}
+
+TEST(SimpleEQCore, LinearPhaseReportsItsLatency)
+{
+    auto engine = makeEngine(makeParams(SIMPLEEQ_ENGINE_LINEAR_PHASE, SIMPLEEQ_LINKED_STEREO));
+    EXPECT_GT(simpleeq_get_latency_samples(engine.get()), 0);
+
+    auto biquads = makeEngine(makeParams(SIMPLEEQ_ENGINE_BIQUAD, SIMPLEEQ_LINKED_STEREO));
+    EXPECT_EQ(simpleeq_get_latency_samples(biquads.get()), 0);
+}
+
+TEST(SimpleEQCore, RejectsInvalidArguments)
+{
+    Engine engine(simpleeq_create());
+    ASSERT_NE(engine, nullptr);
+
+    std::vector<float> frames((size_t)maxBlockSize * 2);
+    EXPECT_EQ(simpleeq_process_interleaved(engine.get(), frames.data(), 2, maxBlockSize), SIMPLEEQ_NOT_PREPARED);
+
+    EXPECT_EQ(simpleeq_prepare(engine.get(), 0.0, 2, maxBlockSize), SIMPLEEQ_INVALID_ARGUMENT);
+    EXPECT_EQ(simpleeq_prepare(engine.get(), sampleRate, 0, maxBlockSize), SIMPLEEQ_INVALID_ARGUMENT);
+    EXPECT_EQ(simpleeq_prepare(nullptr, sampleRate, 2, maxBlockSize), SIMPLEEQ_INVALID_ARGUMENT);
+    ASSERT_EQ(simpleeq_prepare(engine.get(), sampleRate, 2, maxBlockSize), SIMPLEEQ_OK);
+
+    EXPECT_EQ(simpleeq_process_interleaved(engine.get(), nullptr, 2, maxBlockSize), SIMPLEEQ_INVALID_ARGUMENT);
+    EXPECT_EQ(simpleeq_process_interleaved(engine.get(), frames.data(), 2, -1), SIMPLEEQ_INVALID_ARGUMENT);
+    EXPECT_EQ(simpleeq_process_planar(engine.get(), nullptr, 2, maxBlockSize), SIMPLEEQ_INVALID_ARGUMENT);
+
+    simpleeq_params params;
+    simpleeq_params_init(&params);
+    EXPECT_EQ(simpleeq_set_params(engine.get(), &params), SIMPLEEQ_OK);
+
+    for( uint32_t size : { 0u, 2u, 6u } )
+    {
+        auto badSize = params;
+        badSize.struct_size = size;
+        EXPECT_EQ(simpleeq_set_params(engine.get(), &badSize), SIMPLEEQ_INVALID_ARGUMENT) << size;
+    }
+
+    auto badEngine = params;
+    badEngine.engine = 3;
+    EXPECT_EQ(simpleeq_set_params(engine.get(), &badEngine), SIMPLEEQ_INVALID_ARGUMENT);
+
+    auto badBands = params;
+    badBands.channels[1].num_bands = SIMPLEEQ_MAX_BANDS + 1;
+    EXPECT_EQ(simpleeq_set_params(engine.get(), &badBands), SIMPLEEQ_INVALID_ARGUMENT);
+
+    auto notANumber = params;
+    notANumber.channels[0].peak_freq = std::nanf("");
+    EXPECT_EQ(simpleeq_set_params(engine.get(), &notANumber), SIMPLEEQ_INVALID_ARGUMENT);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "SpectrumSmoother.h"
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <random>
+
+namespace SpectrumSmootherTesting {
+    constexpr int fftSize = 8192;
+    constexpr double sampleRate = 48000.0;
+    constexpr int numColumns = 300;
+    constexpr float negativeInfinity = -48.f;
+
+    TEST(SpectrumSmoother, MatchesDirectAverageOverEachBand) {
+        std::mt19937 generator(7);
+        std::exponential_distribution<float> distribution(1000.f);
+
+        std::vector<float> power((size_t)fftSize / 2);
+        for( auto& p : power )
+            p = distribution(generator);
+
+        for( auto smoothing : { ThirdOctave, SixthOctave, TwelfthOctave, TwentyFourthOctave } )
+        {
+            SpectrumSmoother smoother;
+            smoother.prepare(fftSize, sampleRate, smoothing, numColumns, 20.f, 20000.f);
+
+            std::vector<float> columns((size_t)numColumns);
+            smoother.process(power.data(), columns.data(), negativeInfinity);
+
+            const auto halfWidth = std::exp2(0.5 * SpectrumSmoother::getOctaveFraction(smoothing));
+            const auto binWidth = sampleRate / fftSize;
+
+            for( int c = 0; c < numColumns; ++c )
+            {
+                const auto centre = juce::mapToLog10(double(c) / (numColumns - 1), 20.0, 20000.0);
+
+                double sum = 0.0;
+                int count = 0;
+                for( int k = 0; k < fftSize / 2; ++k )
+                {
+                    const auto frequency = k * binWidth;
+                    if( frequency >= centre / halfWidth && frequency <= centre * halfWidth )
+                    {
+                        sum += power[(size_t)k];
+                        ++count;
+                    }
+                }
+
+                // narrow bands at low frequencies can miss every bin; those fall back to the nearest one
+                if( count == 0 )
+                    continue;
+
+                const auto expected = juce::jmax(negativeInfinity, float(10.0 * std::log10(sum / count)));
+                ASSERT_NEAR(expected, columns[(size_t)c], 1e-3f) << "smoothing " << smoothing << ", column " << c;
+            }
+        }
+    }
+
+    TEST(SpectrumSmoother, FlatSpectrumStaysFlat) {
+        std::vector<float> power((size_t)fftSize / 2, 0.01f);   // -20 dB
+
+        SpectrumSmoother smoother;
+        smoother.prepare(fftSize, sampleRate, ThirdOctave, numColumns, 20.f, 20000.f);
+
+        std::vector<float> columns((size_t)numColumns);
+        smoother.process(power.data(), columns.data(), negativeInfinity);
+
+        for( auto value : columns )
+            EXPECT_NEAR(-20.f, value, 1e-4f);
+    }
+
+    TEST(SpectrumSmoother, WiderSmoothingSpreadsAPeak) {
+        std::vector<float> power((size_t)fftSize / 2, 0.f);
+        const auto peakBin = (int)std::lround(1000.0 * fftSize / sampleRate);
+        power[(size_t)peakBin] = 1.f;
+
+        auto countAboveFloor = [&](AnalyzerSmoothing smoothing)
+        {
+            SpectrumSmoother smoother;
+            smoother.prepare(fftSize, sampleRate, smoothing, numColumns, 20.f, 20000.f);
+
+            std::vector<float> columns((size_t)numColumns);
+            smoother.process(power.data(), columns.data(), negativeInfinity);
+            return std::count_if(columns.begin(), columns.end(), [](float v) { return v > negativeInfinity; });
+        };
+
+        EXPECT_GT(countAboveFloor(ThirdOctave), countAboveFloor(TwelfthOctave));
+        EXPECT_GT(countAboveFloor(TwelfthOctave), 0);
+    }
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "PluginProcessor.h"
+#include "TransferFunctionEstimator.h"
+
+#include <random>
+
+namespace TransferFunctionTesting {
+    // y[n] = (x[n] + x[n - 1]) / 2, so |H| = |cos(w / 2)|
+    TEST(TransferFunctionEstimator, RecoversAKnownFilter) {
+        TransferFunctionEstimator estimator;
+        estimator.prepare(11, 16);
+
+        std::mt19937 generator(3);
+        std::normal_distribution<float> distribution;
+
+        std::vector<float> input(48000), output(input.size());
+        float previous = 0.f;
+        for( size_t i = 0; i < input.size(); ++i )
+        {
+            input[i] = distribution(generator);
+            output[i] = 0.5f * (input[i] + previous);
+            previous = input[i];
+        }
+
+        // odd-sized pieces, the way host blocks arrive
+        for( size_t i = 0; i < input.size(); i += 300 )
+            estimator.addSamples(input.data() + i, output.data() + i, (int)juce::jmin<size_t>(300, input.size() - i));
+
+        std::vector<float> magnitude((size_t)estimator.getNumBins()), coherence(magnitude.size());
+        estimator.getResponse(magnitude.data(), coherence.data(), -100.f);
+
+        for( int k : { 1, 256, 512, 768 } )
+        {
+            const auto w = juce::MathConstants<double>::pi * k / 1024.0;
+            EXPECT_NEAR(20.0 * std::log10(std::cos(w / 2.0)), magnitude[(size_t)k], 0.05) << "bin " << k;
+            EXPECT_GT(coherence[(size_t)k], 0.99f) << "bin " << k;
+        }
+    }
+
+    TEST(TransferFunctionEstimator, RunsOneSegmentPerHop) {
+        TransferFunctionEstimator estimator;
+        estimator.prepare(10, 8);
+
+        std::vector<float> silence((size_t)estimator.getFFTSize());
+        EXPECT_EQ(0, estimator.addSamples(silence.data(), silence.data(), estimator.getFFTSize() - 1));
+        EXPECT_EQ(1, estimator.addSamples(silence.data(), silence.data(), 1));
+
+        for( int hop = 0; hop < 4; ++hop )
+        {
+            EXPECT_EQ(0, estimator.addSamples(silence.data(), silence.data(), estimator.getHopSize() - 1));
+            EXPECT_EQ(1, estimator.addSamples(silence.data(), silence.data(), 1));
+        }
+
+        EXPECT_EQ(5, estimator.getNumSegments());
+    }
+
+    TEST(TransferFunctionEstimator, UncorrelatedOutputHasLowCoherence) {
+        TransferFunctionEstimator estimator;
+        estimator.prepare(10, 32);
+
+        std::mt19937 generator(5);
+        std::normal_distribution<float> distribution;
+
+        std::vector<float> input(1 << 16), output(input.size());
+        for( size_t i = 0; i < input.size(); ++i )
+        {
+            input[i] = distribution(generator);
+            output[i] = distribution(generator);
+        }
+
+        estimator.addSamples(input.data(), output.data(), (int)input.size());
+
+        std::vector<float> magnitude((size_t)estimator.getNumBins()), coherence(magnitude.size());
+        estimator.getResponse(magnitude.data(), coherence.data(), -100.f);
+
+        float meanCoherence = 0.f;
+        for( auto c : coherence )
+            meanCoherence += c / (float)coherence.size();
+
+        EXPECT_LT(meanCoherence, 0.2f);
+    }
+
+    // measures the processor with the given Filter Engine against the curve the editor would draw
+    void expectMeasuredResponseMatchesTheDrawnCurve(FilterEngine engine)
+    {
+        constexpr int blockSize = 256;
+        SimpleEQAudioProcessor processor{};
+
+        // selected before prepareToPlay, which reports the engine's latency to the host
+        auto* engineParameter = processor.apvts.getParameter("Filter Engine");
+        engineParameter->setValueNotifyingHost(engineParameter->convertTo0to1((float)engine));
+        processor.prepareToPlay(48000.0, blockSize);
+        ASSERT_EQ(engine == FilterEngine::LinearPhaseEngine, processor.getLatencySamples() > 0);
+
+        processor.apvts.getParameter("Peak Gain")->setValueNotifyingHost(0.75f);    // +12 dB
+        const auto snapshot = processor.getLatestChainSnapshot();
+
+        auto& measurement = processor.getMeasurement();
+        measurement.setEnabled(true);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(42);
+
+        // two seconds of noise, paced so the worker keeps up
+        constexpr int numBlocks = 375;
+        for( int b = 0; b < numBlocks; ++b )
+        {
+            for( int ch = 0; ch < 2; ++ch )
+                for( int i = 0; i < blockSize; ++i )
+                    buffer.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+            processor.processBlock(buffer, midi);
+
+            if( b % 4 == 0 )
+                juce::Thread::sleep(2);
+        }
+
+        // wait for the worker to get through every complete segment; the output samples of the
+        // first latency's worth of input are left out
+        const auto fftSize = 1 << TransferFunctionMeasurement::fftOrder;
+        const auto measuredSamples = numBlocks * blockSize - processor.getLatencySamples();
+        const auto expectedSegments = (measuredSamples - fftSize) / (fftSize / 2) + 1;
+
+        for( int attempt = 0; attempt < 400; ++attempt )
+        {
+            measurement.acquireLatestResponse();
+            if( measurement.getResponse().numSegments >= expectedSegments )
+                break;
+
+            juce::Thread::sleep(5);
+        }
+
+        measurement.setEnabled(false);
+
+        const auto& response = measurement.getResponse();
+        ASSERT_TRUE(response.isValid());
+
+        for( double frequency : { 200.0, 750.0, 2000.0, 8000.0 } )
+        {
+            const auto expected = juce::Decibels::gainToDecibels(snapshot.getMagnitudeForFrequency(frequency));
+            EXPECT_NEAR(expected, response.getMagnitudeDecibelsForFrequency(frequency), 0.5) << frequency << " Hz";
+            EXPECT_GT(response.getCoherenceForFrequency(frequency), 0.95f) << frequency << " Hz";
+        }
+    }
+
+    TEST(TransferFunctionMeasurement, MeasuredResponseMatchesTheDrawnCurve) {
+        expectMeasuredResponseMatchesTheDrawnCurve(FilterEngine::BiquadEngine);
+    }
+
+    // the FIR delays the output by thousands of samples, far more than a segment's hop
+    TEST(TransferFunctionMeasurement, MeasuredResponseMatchesTheDrawnCurveWithLinearPhase) {
+        expectMeasuredResponseMatchesTheDrawnCurve(FilterEngine::LinearPhaseEngine);
+    }
+}
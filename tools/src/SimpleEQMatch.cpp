@@ -0,0 +1,88 @@
+/*
+ Match EQ from the command line: measures the long-term spectrum of two audio files and prints the
+ LoCut/Peak/HiCut settings that move the first toward the second.
+
+     SimpleEQMatch <material> <reference> [--threads N]
+
+ Both files are read in parallel segments (one reader per thread), so long files analyse at about
+ disk speed.
+ */
+
+#include "MatchEQ.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int getSlopeDecibels(Slope slope) { return 12 * ((int)slope + 1); }
+
+int usage()
+{
+    std::fprintf(stderr, "usage: SimpleEQMatch <material> <reference> [--threads N]\n");
+    return 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if( argc != 3 && argc != 5 )
+        return usage();
+
+    int numThreads = 0;
+    if( argc == 5 )
+    {
+        if( std::strcmp(argv[3], "--threads") != 0 )
+            return usage();
+
+        numThreads = std::atoi(argv[4]);
+    }
+
+    const auto currentDirectory = juce::File::getCurrentWorkingDirectory();
+    const auto materialFile = currentDirectory.getChildFile(argv[1]);
+    const auto referenceFile = currentDirectory.getChildFile(argv[2]);
+
+    auto start = Clock::now();
+    const auto material = LongTermSpectrum::analyse(materialFile, matchEQSpectrumOrder, numThreads);
+    const auto reference = LongTermSpectrum::analyse(referenceFile, matchEQSpectrumOrder, numThreads);
+    const auto analyseMs = millisecondsSince(start);
+
+    if( ! material.isValid() || ! reference.isValid() )
+    {
+        std::fprintf(stderr, "couldn't analyse %s\n",
+                     (material.isValid() ? referenceFile : materialFile).getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    if( material.sampleRate != reference.sampleRate )
+        std::fprintf(stderr, "warning: sample rates differ (%g vs %g Hz); fitting at %g Hz\n",
+                     material.sampleRate, reference.sampleRate, material.sampleRate);
+
+    start = Clock::now();
+    const auto result = fitMatchEQ(material, reference, material.sampleRate);
+    const auto fitMs = millisecondsSince(start);
+
+    const auto& s = result.settings;
+    std::printf("analysis: %lld + %lld frames in %.1f ms\n", (long long)material.numFrames, (long long)reference.numFrames, analyseMs);
+    std::printf("fit:      %d evaluations in %.1f ms, rms error %.2f dB\n",
+                result.numEvaluations, fitMs, result.rmsErrorDecibels);
+    std::printf("\n");
+    std::printf("LowCut Freq   %8.1f Hz\n", s.lowCutFreq);
+    std::printf("LowCut Slope  %8d dB/Oct\n", getSlopeDecibels(s.lowCutSlope));
+    std::printf("HighCut Freq  %8.1f Hz\n", s.highCutFreq);
+    std::printf("HighCut Slope %8d dB/Oct\n", getSlopeDecibels(s.highCutSlope));
+    std::printf("Peak Freq     %8.1f Hz\n", s.peakFreq);
+    std::printf("Peak Gain     %8.1f dB\n", s.peakGainInDecibels);
+    std::printf("Peak Quality  %8.2f\n", s.peakQuality);
+
+    return 0;
+}